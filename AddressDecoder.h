@@ -8,13 +8,16 @@
  * It uses the number of offset and index bits (typically determined by cache line size
  * and number of sets) to compute the bit fields for address decoding.
  *
- * @note This class assumes a 32-bit address space.
+ * @note Addresses are 64-bit. The tag is taken with an arithmetic shift, so the tag of a
+ *       sign-extended 32-bit address (e.g. a stack address below 0 in RV32) is the same as
+ *       it was when addresses were 32-bit ints.
  *
  * @see CacheConfig
  */
 #ifndef ADDRESS_DECODER_H
 #define ADDRESS_DECODER_H
 
+#include <cstdint>
 #include "CacheConfig.h"
 
 class AddressDecoder {
@@ -33,16 +36,16 @@ public:
         tagBits = 32 - offsetBits - indexBits;
     }
 
-    int getTag(int address) const {
-        return address >> (indexBits + offsetBits); 
+    uint64_t getTag(uint64_t address) const {
+        return static_cast<uint64_t>(static_cast<int64_t>(address) >> (indexBits + offsetBits));
     }
 
-    int getIndex(int address) const {
-        return (address >> offsetBits) & ((1 << indexBits) - 1);
+    uint32_t getIndex(uint64_t address) const {
+        return (address >> offsetBits) & ((1u << indexBits) - 1);
     }
 
-    int getOffset(int address) const {
-        return address & ((1 << offsetBits) - 1);
+    uint32_t getOffset(uint64_t address) const {
+        return address & ((1u << offsetBits) - 1);
     }
 };
 
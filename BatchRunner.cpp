@@ -0,0 +1,196 @@
+/**
+ * @file BatchRunner.cpp
+ * @brief Implementation of the parallel batch simulation farm.
+ *
+ * Per program (on a pool thread):
+ *   1. Read and assemble the file with the program's own Simulator.
+ *   2. Load it, enable the cache if a config was given, and run it to the end or to the limit.
+ *   3. Record status, exit code, instruction count and cache statistics in its result slot.
+ */
+#include "BatchRunner.h"
+#include "Simulator.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::string jsonEscape(const std::string &text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Quotes a CSV field if it contains a separator or a quote
+    std::string csvField(const std::string &text)
+    {
+        if (text.find_first_of(",\"\n") == std::string::npos)
+            return text;
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    bool anyCache(const std::vector<BatchResult> &results)
+    {
+        return std::any_of(results.begin(), results.end(), [](const BatchResult &r)
+                           { return r.cacheEnabled; });
+    }
+}
+
+BatchRunner::BatchRunner(ISAMode mode, int threads, const std::string &cacheConfigFile,
+                         uint64_t maxInstructions, bool useJit)
+    : mode(mode), threads(WorkStealingPool(threads).getThreadCount()), cacheConfigFile(cacheConfigFile),
+      maxInstructions(maxInstructions), useJit(useJit)
+{
+}
+
+std::vector<std::string> BatchRunner::collectPrograms(const std::vector<std::string> &paths)
+{
+    std::vector<std::string> programs;
+    for (const auto &path : paths)
+    {
+        if (!fs::is_directory(path))
+        {
+            programs.push_back(path);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto &entry : fs::directory_iterator(path))
+        {
+            std::string ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".s" || ext == ".asm"))
+                found.push_back(entry.path().string());
+        }
+        std::sort(found.begin(), found.end());
+        programs.insert(programs.end(), found.begin(), found.end());
+    }
+    return programs;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<std::string> &programs) const
+{
+    std::vector<BatchResult> results(programs.size());
+    WorkStealingPool pool(threads);
+    pool.parallelFor(programs.size(), [&](size_t i)
+                     { results[i] = runProgram(programs[i]); });
+    return results;
+}
+
+BatchResult BatchRunner::runProgram(const std::string &path) const
+{
+    BatchResult result;
+    result.program = path;
+
+    std::ifstream asmFile(path);
+    if (!asmFile)
+    {
+        result.status = "read-failed";
+        return result;
+    }
+    std::vector<std::string> asmLines;
+    std::string line;
+    while (std::getline(asmFile, line))
+    {
+        asmLines.push_back(line);
+    }
+
+    // Output is discarded: a stream without a buffer is permanently in the bad state
+    std::istringstream nullIn;
+    std::ostream nullOut(nullptr);
+    Simulator simulator(nullIn, nullOut, mode);
+    simulator.setQuiet(true);
+    if (useJit)
+        simulator.enableJit();
+    if (simulator.getAssembler().assemble(asmLines).empty())
+    {
+        result.status = "assembly-failed";
+        return result;
+    }
+    simulator.load(simulator.getAssembler().getInstructions());
+    if (!cacheConfigFile.empty())
+    {
+        simulator.enableCache(cacheConfigFile);
+        result.cacheEnabled = simulator.getCacheSimulator().isEnabled();
+    }
+
+    Simulator::RunResult runResult = simulator.runFor(maxInstructions ? maxInstructions : UINT64_MAX);
+    switch (runResult)
+    {
+    case Simulator::RunResult::FINISHED:
+        result.status = simulator.hasExited() ? "exited" : "completed";
+        break;
+    case Simulator::RunResult::BREAKPOINT:
+        result.status = "breakpoint";
+        break;
+    case Simulator::RunResult::PAUSED:
+        result.status = "ebreak";
+        break;
+    case Simulator::RunResult::LIMIT_REACHED:
+        result.status = "limit";
+        break;
+    case Simulator::RunResult::ERROR:
+        result.status = "error";
+        break;
+    }
+    result.exitCode = simulator.getExitCode();
+    result.instructions = simulator.getInstructionCount();
+    if (result.cacheEnabled)
+    {
+        const Cache &cache = simulator.getCacheSimulator().getCache();
+        result.cacheAccesses = cache.getAccesses();
+        result.cacheHits = cache.getHits();
+        result.cacheMisses = cache.getMisses();
+    }
+    return result;
+}
+
+void BatchRunner::writeCsv(std::ostream &out, const std::vector<BatchResult> &results)
+{
+    bool cacheColumns = anyCache(results);
+    out << "program,status,exit_code,instructions";
+    if (cacheColumns)
+        out << ",cache_accesses,cache_hits,cache_misses";
+    out << "\n";
+    for (const auto &r : results)
+    {
+        out << csvField(r.program) << "," << r.status << "," << r.exitCode << "," << r.instructions;
+        if (cacheColumns)
+            out << "," << r.cacheAccesses << "," << r.cacheHits << "," << r.cacheMisses;
+        out << "\n";
+    }
+}
+
+void BatchRunner::writeJson(std::ostream &out, const std::vector<BatchResult> &results)
+{
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BatchResult &r = results[i];
+        out << "  {\"program\": \"" << jsonEscape(r.program) << "\", \"status\": \"" << r.status
+            << "\", \"exit_code\": " << r.exitCode << ", \"instructions\": " << r.instructions;
+        if (r.cacheEnabled)
+        {
+            out << ", \"cache\": {\"accesses\": " << r.cacheAccesses << ", \"hits\": " << r.cacheHits
+                << ", \"misses\": " << r.cacheMisses << "}";
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
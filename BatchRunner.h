@@ -0,0 +1,69 @@
+/**
+ * @class BatchRunner
+ * @brief Simulates many programs in parallel and writes one summary of the results.
+ *
+ * Every program gets its own Simulator (own registers, memory and cache), created on a
+ * WorkStealingPool thread. The simulators run in quiet mode and their output is dropped;
+ * only the result of each run is kept:
+ * - status: exited (ecall), completed (ran off the end), ebreak, breakpoint, limit (hit the
+ *   instruction limit), error (pc left the program), or read-failed / assembly-failed
+ * - exit code (a0 at the ecall), instructions executed
+ * - D-cache accesses, hits and misses when a cache config is given
+ *
+ * Results are stored by input position and written in input order, and no timing goes into
+ * the summary, so the summary file is byte-identical for any thread count.
+ */
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "InstructionSet.h"
+
+struct BatchResult
+{
+    std::string program;
+    std::string status;
+    int exitCode = 0;
+    uint64_t instructions = 0;
+    bool cacheEnabled = false;
+    uint64_t cacheAccesses = 0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+};
+
+class BatchRunner
+{
+public:
+    // threads <= 0: one per host core. maxInstructions 0: no limit.
+    BatchRunner(ISAMode mode, int threads = 0, const std::string &cacheConfigFile = "",
+                uint64_t maxInstructions = 0, bool useJit = false);
+
+    // Expands each path: a directory contributes its .s/.asm files sorted by name,
+    // anything else is taken as a program file
+    static std::vector<std::string> collectPrograms(const std::vector<std::string> &paths);
+
+    // Simulates every program; result i belongs to programs[i]
+    std::vector<BatchResult> run(const std::vector<std::string> &programs) const;
+
+    static void writeCsv(std::ostream &out, const std::vector<BatchResult> &results);
+    static void writeJson(std::ostream &out, const std::vector<BatchResult> &results);
+
+    int getThreadCount() const
+    {
+        return threads;
+    }
+
+private:
+    ISAMode mode;
+    int threads;
+    std::string cacheConfigFile;
+    uint64_t maxInstructions;
+    bool useJit;
+
+    BatchResult runProgram(const std::string &path) const;
+};
+
+#endif // BATCH_RUNNER_H
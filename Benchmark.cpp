@@ -0,0 +1,311 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Implementation of the simulator throughput benchmark.
+ *
+ * For every .s program in the test directory (sorted by name so runs are comparable):
+ *   1. Assemble the program once.
+ *   2. Load and run it `iterations` times, timing only Simulator::run().
+ *   3. Report instructions per run, total time and MIPS.
+ *
+ * The simulator runs in quiet mode, so no trace is formatted. Its remaining output goes to
+ * a stream without a buffer and is dropped.
+ *
+ * The memory benchmark runs the same access sequence (addresses from a fixed-seed generator)
+ * on Memory and on MapMemory, a copy of the byte-per-entry unordered_map backend Memory used
+ * before paging, and checks that both return the same checksum.
+ *
+ * The cache benchmark builds one trace up front (fixed seed: 70% of accesses to a 4 KiB hot
+ * region, the rest spread over 64 KiB, 30% writes) and times only Cache::accessBatch() on it.
+ * RANDOM replacement gets a fixed seed, so hit and miss counts are repeatable across builds.
+ */
+#include "Benchmark.h"
+#include "Simulator.h"
+#include "Memory.h"
+#include "Cache.h"
+#include "CacheConfig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // The previous Memory backend: one hash map entry per byte written
+    class MapMemory
+    {
+    public:
+        int read(uint32_t address, MemSize size, bool isUnsigned = false) const
+        {
+            int sz = static_cast<int>(size);
+            uint32_t val = 0;
+            for (int i = 0; i < sz; ++i)
+            {
+                auto it = memory.find(address + i);
+                uint8_t byte = it != memory.end() ? static_cast<uint8_t>(it->second) : 0;
+                val |= static_cast<uint32_t>(byte) << (8 * i);
+            }
+            if (!isUnsigned && size == MemSize::Byte)
+                return static_cast<int8_t>(val);
+            return val;
+        }
+
+        void write(uint32_t address, MemSize size, uint32_t value)
+        {
+            int sz = static_cast<int>(size);
+            for (int i = 0; i < sz; ++i)
+                memory[address + i] = static_cast<int8_t>((value >> (8 * i)) & 0xFF);
+        }
+
+    private:
+        std::unordered_map<uint32_t, int8_t> memory;
+    };
+
+    struct MemoryOp
+    {
+        const char *name;
+        MemSize size;
+        bool isWrite;
+        bool random;
+    };
+
+    // Runs one access pattern over [base, base + bytes); returns ns per access
+    template <typename Backend>
+    double timeMemoryOp(Backend &memory, const MemoryOp &op, uint32_t base, uint32_t bytes, uint32_t count,
+                        uint64_t &checksum)
+    {
+        std::mt19937 rng(12345);
+        const uint32_t step = static_cast<uint32_t>(op.size);
+        const uint32_t slots = bytes / step;
+        std::vector<uint32_t> addresses(count);
+        for (uint32_t i = 0; i < count; ++i)
+            addresses[i] = base + (op.random ? rng() % slots : i % slots) * step;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (op.isWrite)
+                memory.write(addresses[i], op.size, i);
+            else
+                checksum += static_cast<uint32_t>(memory.read(addresses[i], op.size));
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() * 1e9 / count;
+    }
+}
+
+int Benchmark::runSimulatorBenchmark(const std::string &testDir, ISAMode mode, int iterations, bool useJit)
+{
+    std::vector<fs::path> programs;
+    for (const auto &entry : fs::directory_iterator(testDir))
+    {
+        std::string ext = entry.path().extension().string();
+        if (ext == ".s" || ext == ".asm")
+            programs.push_back(entry.path());
+    }
+    std::sort(programs.begin(), programs.end());
+
+    if (programs.empty())
+    {
+        std::cerr << "No .s programs found in " << testDir << "\n";
+        return 1;
+    }
+
+    std::cout << "Simulator benchmark: " << programs.size() << " programs, " << iterations
+              << " runs each, mode " << isaModeToString(mode) << (useJit ? ", JIT" : "") << "\n";
+    std::cout << std::left << std::setw(28) << "Program" << std::right
+              << std::setw(14) << "Instr/run" << std::setw(14) << "Time (ms)" << std::setw(12) << "MIPS" << "\n";
+
+    uint64_t totalInstructions = 0;
+    double totalSeconds = 0.0;
+
+    for (const auto &path : programs)
+    {
+        std::ifstream asmFile(path);
+        std::vector<std::string> asmLines;
+        std::string line;
+        while (std::getline(asmFile, line))
+        {
+            asmLines.push_back(line);
+        }
+
+        // Output is discarded: a stream without a buffer is permanently in the bad state
+        std::istringstream nullIn;
+        std::ostream nullOut(nullptr);
+        Simulator simulator(nullIn, nullOut, mode);
+        simulator.setQuiet(true);
+        if (useJit)
+            simulator.enableJit();
+        if (simulator.getAssembler().assemble(asmLines).empty())
+        {
+            std::cout << std::left << std::setw(28) << path.filename().string() << " (assembly failed, skipped)\n";
+            continue;
+        }
+        const std::vector<InstructionInstance> instructions = simulator.getAssembler().getInstructions();
+
+        uint64_t instructionsPerRun = 0;
+        uint64_t programInstructions = 0;
+        std::chrono::duration<double> elapsed(0);
+        for (int i = 0; i < iterations; ++i)
+        {
+            simulator.load(instructions);
+            auto start = std::chrono::steady_clock::now();
+            simulator.run();
+            elapsed += std::chrono::steady_clock::now() - start;
+            instructionsPerRun = simulator.getInstructionCount();
+            programInstructions += instructionsPerRun;
+        }
+
+        double seconds = elapsed.count();
+        double mips = seconds > 0 ? programInstructions / seconds / 1e6 : 0.0;
+        std::cout << std::left << std::setw(28) << path.filename().string() << std::right
+                  << std::setw(14) << instructionsPerRun
+                  << std::setw(14) << std::fixed << std::setprecision(2) << seconds * 1000.0
+                  << std::setw(12) << std::setprecision(2) << mips << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+
+        totalInstructions += programInstructions;
+        totalSeconds += seconds;
+    }
+
+    double totalMips = totalSeconds > 0 ? totalInstructions / totalSeconds / 1e6 : 0.0;
+    std::cout << "Total: " << totalInstructions << " instructions in " << std::fixed << std::setprecision(3)
+              << totalSeconds << " s = " << std::setprecision(2) << totalMips << " MIPS\n";
+    std::cout.unsetf(std::ios::floatfield);
+    return 0;
+}
+
+int Benchmark::runMemoryBenchmark(uint32_t sizeMB)
+{
+    if (sizeMB == 0 || sizeMB > 1024)
+    {
+        std::cerr << "Memory benchmark size must be 1..1024 MB\n";
+        return 1;
+    }
+    const uint32_t base = 0x10000000;
+    const uint32_t bytes = sizeMB << 20;
+    const uint32_t count = bytes / 4;
+    const MemoryOp ops[] = {
+        {"sequential word write", MemSize::Word, true, false},
+        {"sequential word read", MemSize::Word, false, false},
+        {"random word read", MemSize::Word, false, true},
+        {"random byte write", MemSize::Byte, true, true},
+        {"random byte read", MemSize::Byte, false, true},
+    };
+
+    std::ostream nullOut(nullptr);
+    Memory paged(nullOut);
+    MapMemory map;
+    uint64_t pagedChecksum = 0;
+    uint64_t mapChecksum = 0;
+
+    std::cout << "Memory benchmark: " << sizeMB << " MB region, " << count << " accesses per pattern\n";
+    std::cout << std::left << std::setw(24) << "Pattern" << std::right << std::setw(14) << "Map (ns/op)"
+              << std::setw(14) << "Paged (ns/op)" << std::setw(10) << "Speedup" << "\n";
+    for (const MemoryOp &op : ops)
+    {
+        double mapNs = timeMemoryOp(map, op, base, bytes, count, mapChecksum);
+        double pagedNs = timeMemoryOp(paged, op, base, bytes, count, pagedChecksum);
+        std::cout << std::left << std::setw(24) << op.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << mapNs << std::setw(14) << pagedNs
+                  << std::setw(9) << (pagedNs > 0 ? mapNs / pagedNs : 0.0) << "x\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Pages allocated: " << paged.getPageCount() << " (" << paged.getPageCount() * Memory::PAGE_SIZE / 1024
+              << " KiB)\n";
+    if (pagedChecksum != mapChecksum)
+    {
+        std::cerr << "Error: backends disagree (checksum " << pagedChecksum << " vs " << mapChecksum << ")\n";
+        return 1;
+    }
+    return 0;
+}
+
+int Benchmark::runCacheBenchmark(const std::string &configDir, uint32_t accessCount)
+{
+    std::vector<fs::path> configFiles;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(configDir, ec); !ec && it != fs::recursive_directory_iterator();
+         it.increment(ec))
+    {
+        if (it->is_regular_file() && it->path().filename() == "config")
+            configFiles.push_back(it->path());
+    }
+    std::sort(configFiles.begin(), configFiles.end());
+
+    // distinct configs, each also as 16-way and fully associative
+    std::map<std::string, CacheConfig> configs;
+    auto describe = [](const CacheConfig &c)
+    {
+        std::ostringstream name;
+        name << c.cacheSize << "B/" << c.blockSize << "B/"
+             << (c.associativity == 0 ? std::string("full") : std::to_string(c.associativity) + "-way") << "/"
+             << replacementPolicyToString(c.replacementPolicy) << "/" << writePolicyToString(c.writePolicy);
+        return name.str();
+    };
+    for (const fs::path &file : configFiles)
+    {
+        CacheConfig config;
+        if (!config.loadFromFile(file.string()))
+            continue;
+        configs.emplace(describe(config), config);
+        for (int ways : {16, 0})
+        {
+            CacheConfig wide = config;
+            wide.associativity = ways;
+            if (wide.isValid())
+                configs.emplace(describe(wide), wide);
+        }
+    }
+    if (configs.empty())
+    {
+        std::cerr << "No cache configs found under " << configDir << "\n";
+        return 1;
+    }
+
+    std::mt19937 rng(42);
+    std::vector<CacheAccess> trace(accessCount);
+    for (CacheAccess &access : trace)
+    {
+        bool hot = rng() % 10 < 7;
+        access.address = 0x10000000 + (hot ? rng() % 4096 : 0x1000 + rng() % 65536);
+        access.address &= ~3ull;
+        access.size = 4;
+        access.isWrite = rng() % 10 < 3;
+    }
+
+    std::cout << "Cache benchmark: " << accessCount << " accesses per config\n";
+    std::cout << std::left << std::setw(32) << "Config" << std::right << std::setw(12) << "Hits" << std::setw(12)
+              << "Misses" << std::setw(12) << "ns/access" << std::setw(12) << "M acc/s" << std::setw(10)
+              << "Tag match" << "\n";
+    double totalSeconds = 0;
+    for (const auto &entry : configs)
+    {
+        std::ostream nullOut(nullptr);
+        Memory memory(nullOut);
+        Cache cache;
+        cache.setRandomSeed(12345);
+        cache.enable(entry.second, memory);
+        auto start = std::chrono::steady_clock::now();
+        cache.accessBatch(trace);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalSeconds += seconds;
+        std::cout << std::left << std::setw(32) << entry.first << std::right << std::setw(12) << cache.getHits()
+                  << std::setw(12) << cache.getMisses() << std::fixed << std::setprecision(2) << std::setw(12)
+                  << seconds * 1e9 / accessCount << std::setw(12) << accessCount / seconds / 1e6 << std::setw(10) << cache.getTagMatchKind() << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Total: " << configs.size() << " configs in " << std::fixed << std::setprecision(3) << totalSeconds
+              << " s\n";
+    std::cout.unsetf(std::ios::floatfield);
+    return 0;
+}
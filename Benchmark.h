@@ -0,0 +1,40 @@
+/**
+ * @class Benchmark
+ * @brief Measures simulator throughput on the .s programs under the Test directory.
+ *
+ * Each program is assembled once and then loaded and run repeatedly. Only the time spent
+ * inside Simulator::run() is measured. Simulator output is discarded so that the numbers
+ * reflect instruction execution rather than terminal I/O.
+ *
+ * Results are reported per program and in total as MIPS (millions of simulated
+ * instructions per host second). With useJit, hot blocks are compiled to native code.
+ *
+ * runMemoryBenchmark() times the Memory backend alone against the per-byte hash map it
+ * replaced, on sequential words, random words and random bytes.
+ *
+ * runCacheBenchmark() times Cache::accessBatch() on a fixed synthetic trace for every distinct
+ * config under Test/CacheSimulator, and for the same cache size and block size made 16-way
+ * and fully associative, where tag lookup dominates.
+ */
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include "InstructionSet.h"
+
+class Benchmark
+{
+public:
+    // Runs every .s file in testDir `iterations` times and prints a MIPS table to std::cout
+    int runSimulatorBenchmark(const std::string &testDir = "Test", ISAMode mode = ISAMode::RV64IM, int iterations = 2000,
+                              bool useJit = false);
+
+    // Compares Memory with the old per-byte unordered_map over a `sizeMB` region; prints ns/op
+    int runMemoryBenchmark(uint32_t sizeMB = 16);
+
+    // Runs accessCount synthetic accesses through each cache config found under configDir;
+    // prints M accesses/s with the hit and miss counts
+    int runCacheBenchmark(const std::string &configDir = "Test/CacheSimulator", uint32_t accessCount = 2000000);
+};
+
+#endif // BENCHMARK_H
@@ -10,9 +10,18 @@
 
 void BreakPointInfo::reset()
 {
+    for (const auto& [pc, line] : breakpointMap) {
+        notifyChange(pc);
+    }
     breakpointMap.clear();
 }
 
+void BreakPointInfo::notifyChange(int pc) const
+{
+    if (changeListener)
+        changeListener(pc);
+}
+
 
 // Get assembly line at the break point of a given PC ; 0 otherwise
 int BreakPointInfo::getBreakpointAssemblyLine(int pc) const {
@@ -39,6 +48,7 @@ bool BreakPointInfo::setBreakpoint(int pc, int assemblyLine) {
 
     if (breakpointMap.count(pc) == 0) {
         breakpointMap[pc] = assemblyLine;
+        notifyChange(pc);
         return true;
     }
 
@@ -48,7 +58,9 @@ bool BreakPointInfo::setBreakpoint(int pc, int assemblyLine) {
 bool BreakPointInfo::removeBreakpoint(int assemblyLine) {
     for (auto it = breakpointMap.begin(); it != breakpointMap.end(); ++it) {
         if (it->second == assemblyLine) {
+            int pc = it->first;
             breakpointMap.erase(it);
+            notifyChange(pc);
             return true;
         }
     }
@@ -14,6 +14,7 @@
 
 #include <unordered_map>
 #include <iostream>
+#include <functional>
 
 class BreakPointInfo {
 public:
@@ -37,12 +38,17 @@ public:
     // reset
     void reset();
 
+    // Called with the PC of every breakpoint that is set or removed (used to invalidate translated blocks)
+    void setChangeListener(std::function<void(int pc)> listener) { changeListener = std::move(listener); }
+
     protected:
         std::istream& in;
         std::ostream& out;
 private:
     std::unordered_map<int, int> breakpointMap; // pc → source line
     static constexpr int MAX_BREAKPOINTS = 5;
+    std::function<void(int pc)> changeListener;
+    void notifyChange(int pc) const;
 };
 
 #endif // BREAKPOINTINFO_H
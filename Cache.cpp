@@ -24,13 +24,16 @@
      *   - handleWriteHit(): Handles write hits according to the write policy.
      *   - handleMiss(): Handles cache misses, including block replacement and allocation.
      *   - replaceBlock(): Selects and replaces a cache block using the configured replacement policy.
-     *   - selectBlockToEvict(): Chooses a victim block for eviction.
-     *   - findBlockInSet(): Searches for a block with a matching tag in a set.
+     *   - selectBlockToEvict(): Asks the CacheReplacement policy for a victim block.
+     *   - findTag(): Finds the valid way of a set whose tag matches, comparing the set's tag array with
+     *     AVX2 (4 tags at a time) or SSE2 (2 at a time) for 4 or more ways, or a scalar loop otherwise;
+     *     enable() picks the variant for the host CPU.
      *   - writeBlockToMemory(): Writes a cache block back to memory (for WB policy).
      *   - invalidate(): Invalidates all cache blocks, resetting the cache state.
      *   - dump(): Outputs the current cache state for debugging.
      *   - printStats(): Outputs cache access statistics.
      *   - read()/write(): Public API for reading from and writing to the cache.
+     *   - accessBatch(): Runs an array of accesses (e.g. a trace) without per-access logging.
      *
      * Usage:
      * 1. Create a CacheConfig and Memory instance.
@@ -50,13 +53,18 @@
     #include <iostream>
     #include <sstream>
     #include <string>
-    #include <cstdlib>   // for std::rand, std::srand
-    #include <ctime>     // for time()
     #include <iomanip>
 
     #include "Cache.h"
     #include "BitUtils.h"
 
+    #include <cstring>
+
+    #if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+    #define CACHE_TAG_SIMD 1
+    #include <immintrin.h>
+    #endif
+
 
     // READ: Cache Hit	-> Read from cache, update lastUsed for LRU.
     // READ: Cache Miss ->	Fetch from memory, possibly evict block using eviction policy.
@@ -78,9 +86,12 @@
         return oss.str();
     }
 
-    void Cache::logAccess(char op, uint32_t address, uint32_t setIndex,
-                        const std::string& hitOrMiss, uint32_t tag, bool dirty) {
-        if (logStream && logStream->good()) {
+    void Cache::logAccess(char op, uint64_t address, uint32_t setIndex,
+                        const std::string& hitOrMiss, uint64_t tag, bool dirty) {
+        // no log stream: the cache was enabled without a program name (e.g. batch runs)
+        if (!logStream)
+            return;
+        if (logStream->good()) {
             *logStream << op << ": Address: 0x" << std::hex << address
                     << ", Set: 0x" << setIndex 
                     << ", Tag: 0x" << tag
@@ -97,6 +108,63 @@
         }         
     }
 
+    namespace {
+        int findTagScalar(const uint64_t* tags, const uint8_t* valid, int ways, uint64_t tag) {
+            for (int way = 0; way < ways; ++way) {
+                if (tags[way] == tag && valid[way]) {
+                    return way;
+                }
+            }
+            return -1;
+        }
+
+#ifdef CACHE_TAG_SIMD
+        // Compares 4 tags per instruction; a matching tag still needs its valid byte, since
+        // invalid lines keep (zeroed or stale) tags
+        __attribute__((target("avx2")))
+        int findTagAvx2(const uint64_t* tags, const uint8_t* valid, int ways, uint64_t tag) {
+            const __m256i key = _mm256_set1_epi64x(static_cast<long long>(tag));
+            int way = 0;
+            for (; way + 4 <= ways; way += 4) {
+                __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + way));
+                int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(group, key)));
+                for (; mask; mask &= mask - 1) {
+                    int hit = way + __builtin_ctz(mask);
+                    if (valid[hit]) {
+                        return hit;
+                    }
+                }
+            }
+            int rest = findTagScalar(tags + way, valid + way, ways - way, tag);
+            return rest < 0 ? -1 : way + rest;
+        }
+
+        // SSE2 has no 64-bit compare: two 32-bit halves must both match
+        int findTagSse2(const uint64_t* tags, const uint8_t* valid, int ways, uint64_t tag) {
+            const __m128i key = _mm_set1_epi64x(static_cast<long long>(tag));
+            int way = 0;
+            for (; way + 2 <= ways; way += 2) {
+                __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + way)), key);
+                equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+                int mask = _mm_movemask_pd(_mm_castsi128_pd(equal));
+                for (; mask; mask &= mask - 1) {
+                    int hit = way + __builtin_ctz(mask);
+                    if (valid[hit]) {
+                        return hit;
+                    }
+                }
+            }
+            int rest = findTagScalar(tags + way, valid + way, ways - way, tag);
+            return rest < 0 ? -1 : way + rest;
+        }
+
+        bool hostHasAvx2() {
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            return avx2;
+        }
+#endif
+    }
+
     // === Constructor ===
     Cache::Cache(): numSets(0),accesses(0), hits(0), misses(0) {
         invalidate();
@@ -105,6 +173,9 @@
     // Initializes the cache based on the config.
         
     void Cache::enable(const CacheConfig& config, Memory& mem)   {
+        // a (re)enabled cache starts with an empty write buffer: stores pending in the old one
+        // belong to the memory the caller is replacing (e.g. a checkpoint restore)
+        writeBuffer.reset();
         invalidate();
         this->config= config;
         if (config.blockSize == 0 || config.cacheSize == 0) {
@@ -115,16 +186,6 @@
         
         int assoc = config.associativity;
 
-        if (config.replacementPolicy == ReplacementPolicy::RANDOM) {
-            if (randomSeed == 0) {
-                std::srand(static_cast<unsigned int>(time(nullptr)));  // seed rand once
-            }
-            else {
-            // during tests use a fixed seed.
-            std::srand(randomSeed);
-            }
-        }
-
         if (assoc == 0) {
             // Fully associative: all blocks in one set
             numSets = 1;
@@ -138,13 +199,47 @@
             numSets = numBlocks / assoc;
         }
 
-        sets.resize(numSets);
-        //For every set in the cache (sets), resize it to have assoc blocks (i.e., number of ways in each set).
-        // This is where each set is configured to be fully associative (if assoc == numBlocks), 
-        // direct-mapped (assoc == 1), or N-way set-associative.
-        for (auto& set : sets) {
-            set.resize(assoc);
+        // Every line starts invalid, clean and never used; a set's lines are contiguous.
+        // This is where the cache becomes fully associative (one set of numBlocks ways),
+        // direct-mapped (ways == 1), or N-way set-associative.
+        ways = assoc;
+        size_t lines = static_cast<size_t>(numSets) * ways;
+        tags.assign(lines, 0);
+        valid.assign(lines, 0);
+        dirty.assign(lines, 0);
+        lastUsed.assign(lines, 0);
+        insertionTime.assign(lines, 0);
+        // TIMING keeps no data at all: Memory holds the only copy
+        tagOnly = config.model == CacheModel::TIMING;
+        if (tagOnly) {
+            decltype(arena)().swap(arena);
+        } else {
+            arena.assign(lines * config.blockSize, 0);
+        }
+
+        replacement = CacheReplacement::create(config, numSets, ways, randomSeed);
+        prefetcher = CachePrefetcher::create(config);
+        prefetched.assign(prefetcher ? lines : 0, 0);
+        prefetchedAt.assign(prefetcher ? lines : 0, 0);
+        evictedByPrefetch.clear();
+        prefetchStats = PrefetchStats();
+        // only a DATA victim cache needs bytes: a miss cache's hits are refilled from Memory
+        victimCache.reset();
+        if (config.victimEntries > 0) {
+            bool holdsData = config.victimKind == VictimKind::VICTIM && !tagOnly;
+            victimCache = std::make_unique<VictimCache>(config, holdsData);
+        }
+        writeBuffer.reset();
+        if (config.writeBufferEntries > 0 && config.writePolicy == WritePolicy::WT) {
+            writeBuffer = std::make_unique<WriteBuffer>(config, !tagOnly);
+        }
+
+        findTag = findTagScalar;
+#ifdef CACHE_TAG_SIMD
+        if (ways >= 4) {
+            findTag = hostHasAvx2() ? findTagAvx2 : findTagSse2;
         }
+#endif
 
         // Initialize address decoder with updated config
         this->addrDecoder = AddressDecoder(config);
@@ -153,137 +248,191 @@
 
     }
 
+    const char* Cache::getTagMatchKind() const {
+#ifdef CACHE_TAG_SIMD
+        if (findTag == findTagAvx2) return "AVX2";
+        if (findTag == findTagSse2) return "SSE2";
+#endif
+        return "scalar";
+    }
 
-    CacheBlock* Cache::selectBlockToEvict(std::vector<CacheBlock>& set, std::string &policyStr) {
-       
-        CacheBlock* victim = nullptr;
-
-        if (config.replacementPolicy == ReplacementPolicy::LRU) {
-            policyStr = "LRU";
-            uint64_t oldestAccess = UINT64_MAX;
-            for (auto& block : set) {
-                if (block.lastUsed < oldestAccess) {
-                    oldestAccess = block.lastUsed;
-                    victim = &block;
-                }
-            }
-        } else if (config.replacementPolicy == ReplacementPolicy::FIFO) {
-            policyStr = "FIFO";
-            uint64_t earliest = UINT64_MAX;
-            for (auto& block : set) {
-                if (block.insertionTime < earliest) {
-                    earliest = block.insertionTime;
-                    victim = &block;
-                }
-            }
-        } else if (config.replacementPolicy == ReplacementPolicy::RANDOM) {
-            policyStr = "RANDOM";
-            int randomIndex = std::rand() % static_cast<int>(set.size());
-            victim = &set[randomIndex];
-        } else {
-            policyStr = "DEFAULT";
-            victim = &set[0];  // default fallback; should never be here
-        }
 
-        return victim;
+    size_t Cache::selectBlockToEvict(uint32_t setIndex, std::string &policyStr) {
+        size_t base = static_cast<size_t>(setIndex) * ways;
+        policyStr = replacement->getName();
+        return base + replacement->victim(setIndex, lastUsed.data() + base, insertionTime.data() + base);
     }
 
 
 
-    uint32_t Cache::access(uint32_t address, MemSize size, bool isUnsigned, bool isWrite, uint32_t value) {
+    uint64_t Cache::access(uint64_t address, MemSize size, bool isUnsigned, bool isWrite, uint64_t value, uint64_t pc) {
         uint32_t index = addrDecoder.getIndex(address);
         uint64_t tag  = addrDecoder.getTag(address);
-        auto& set = sets[index];
+        size_t base = static_cast<size_t>(index) * ways;
         ++accesses;
         // Search for the block in the set
-        CacheBlock* block = findBlockInSet(set, tag);
+        int way = findTag(tags.data() + base, valid.data() + base, ways, tag);
+        uint64_t result;
+        bool miss = way < 0;
+        bool firstUse = false;
 
-        if (block) {
+        if (way >= 0) {
             // Cache hit
+            size_t line = base + way;
             hits++;
             // for LRU
-            block->lastUsed = accesses;
+            lastUsed[line] = accesses;
+            replacement->touch(index, way);
+            if (!prefetched.empty() && prefetched[line]) {
+                firstUse = true;
+                prefetched[line] = 0;
+                countPrefetchUse(prefetchedAt[line]);
+            }
 
             // Write Hit: find the cache block corresponding to the address.
             //      Write-Through Policy (WT): Update cache block. Immediately write to main memory too. No dirty bit needed.
             //      Write-Back Policy (WB): Update cache block,  Mark the block as dirty. No memory write now it will happen later, on eviction.
             if (isWrite) {
                 // TBD: return address for write?
-                return handleWriteHit(*block, index, address, size, value);
+                result = handleWriteHit(line, index, address, size, value);
             } else {
             // Read Cache Hit -> Read from the cache line.
             // TBD: returning value for read?
-                logAccess('R', address, index, "Hit", tag, block->isDirty());  
-                return block->readData(address, size, isUnsigned, config.blockSize);
+                if (logStream)
+                    logAccess('R', address, index, "Hit", tag, dirty[line]);
+                result = readLine(line, address, size, isUnsigned);
         
             }
         } else {
             // Cache miss - replace a block
             misses++;
-            return handleMiss(set, index,address, tag, size, isUnsigned, isWrite, value);
+            uint64_t blockAddr = address & ~static_cast<uint64_t>(config.blockSize - 1);
+            // probed on every miss; replaceBlock() swaps a victim cache hit in
+            bool victimHit = victimCache && victimCache->lookup(blockAddr, accesses);
+            if (prefetcher) {
+                if (!evictedByPrefetch.empty() && evictedByPrefetch.erase(blockAddr)) {
+                    prefetchStats.pollution++;
+                }
+                // a stream buffer head hit supplies the block instead of memory
+                uint64_t issuedAt = 0;
+                bool allocates = !(isWrite && config.writePolicy == WritePolicy::WT);
+                if (allocates && !victimHit && prefetcher->claim(blockAddr, accesses, issuedAt)) {
+                    prefetchStats.bufferHits++;
+                    countPrefetchUse(issuedAt);
+                    miss = false;
+                }
+            }
+            result = handleMiss(index,address, tag, size, isUnsigned, isWrite, value);
         }
+        if (prefetcher) {
+            runPrefetcher(address, pc, miss, firstUse);
+        }
+        return result;
     }
 
+    void Cache::runPrefetcher(uint64_t address, uint64_t pc, bool miss, bool firstUse) {
+        prefetchQueue.clear();
+        prefetcher->observe(address, pc, miss, firstUse, accesses, prefetchQueue);
+        for (uint64_t block : prefetchQueue) {
+            prefetchBlock(block);
+        }
+        prefetchStats.issued += prefetcher->takeBufferedIssues();
+    }
 
-    // Search for the block in the set for a  given tag
-    CacheBlock* Cache::findBlockInSet(std::vector<CacheBlock>& set, uint64_t tag) {
-        for (auto& block : set) {
-            if (block.isValid() && block.tag == tag) {
-                return &block;
-            }
+    void Cache::prefetchBlock(uint64_t blockAddress) {
+        uint32_t index = addrDecoder.getIndex(blockAddress);
+        uint64_t tag = addrDecoder.getTag(blockAddress);
+        size_t base = static_cast<size_t>(index) * ways;
+        if (findTag(tags.data() + base, valid.data() + base, ways, tag) >= 0) {
+            return; // already cached: nothing to fetch
+        }
+        if (victimCache && victimCache->holdsVictims() && victimCache->find(blockAddress) >= 0) {
+            return; // one miss away already, and its copy there may be the only current one
+        }
+        evictedByPrefetch.erase(blockAddress);
+        // the eviction and fill are the prefetch's, not a demand miss: log them as one 'P' line
+        std::ostream* log = logStream;
+        logStream = nullptr;
+        size_t line = replaceBlock(index, tag, blockAddress, false, true);
+        logStream = log;
+        if (logStream)
+            logAccess('P', blockAddress, index, std::string("Prefetch (") + prefetcher->getName() + ")", tag, false);
+        prefetched[line] = 1;
+        prefetchedAt[line] = accesses;
+        prefetchStats.issued++;
+    }
+
+    void Cache::countPrefetchUse(uint64_t issuedAt) {
+        uint64_t lead = accesses - issuedAt;
+        prefetchStats.useful++;
+        prefetchStats.leadSum += lead;
+        if (lead < static_cast<uint64_t>(config.prefetchLatency)) {
+            prefetchStats.late++;
         }
-        return nullptr;
     }
 
+
     // Update Cache block for both WT and WB
     // Write-Back Policy (WB): Mark the block as dirty. No memory write now ; it will happen later, on eviction.
     // Write-Through Policy (WT): Immediately write to main memory too. No dirty bit needed.
     
-    uint32_t Cache::handleWriteHit(CacheBlock& block, int setIndex, uint32_t address, MemSize size, uint32_t value) {
+    uint64_t Cache::handleWriteHit(size_t line, int setIndex, uint64_t address, MemSize size, uint64_t value) {
         
     
-        block.writeData(address, size, value, config.blockSize);
+        writeLine(line, address, size, value);
         
         if (config.writePolicy == WritePolicy::WB) {
-            block.dirty = true;
+            dirty[line] = 1;
         } else {
-            writeToMemory(address, size, value);
-            block.dirty = false;
+            writeThrough(address, size, value, tagOnly);
+            dirty[line] = 0;
         }
 
-        std::string policyStr = config.writePolicy == WritePolicy::WB ? "WB" : "WT";
-        logAccess('W', address, setIndex, "Hit, " + policyStr, block.tag, block.isDirty());
+        if (logStream) {
+            std::string policyStr = config.writePolicy == WritePolicy::WB ? "WB" : "WT";
+            logAccess('W', address, setIndex, "Hit, " + policyStr, tags[line], dirty[line]);
+        }
 
                         
         return address;
     }
 
-    uint32_t Cache::handleMiss(std::vector<CacheBlock>& set, int setIndex, uint32_t address, uint64_t tag,
-                            MemSize size, bool isUnsigned, bool isWrite, uint32_t value) {
+    uint64_t Cache::handleMiss(int setIndex, uint64_t address, uint64_t tag,
+                            MemSize size, bool isUnsigned, bool isWrite, uint64_t value) {
 
         // No-Allocate for WT i.e.  On a write miss, write directly to memory, but do not load the block into the cache.
         if (isWrite && config.writePolicy == WritePolicy::WT) {
             // WT No-Write-Allocate
-            writeToMemory(address, size, value);
-            logAccess('W', address, setIndex, "Miss, WT Write-through (No Allocation)", tag, false);
+            writeThrough(address, size, value, false);
+            if (victimCache && victimCache->holdsVictims()) {
+                // the victim cache's copy must not go stale
+                int entry = victimCache->find(address & ~static_cast<uint64_t>(config.blockSize - 1));
+                if (entry >= 0) {
+                    victimCache->write(entry, address, size, value);
+                }
+            }
+            if (logStream)
+                logAccess('W', address, setIndex, "Miss, WT Write-through (No Allocation)", tag, false);
             return address;
         }
 
-        CacheBlock* block = replaceBlock(set,setIndex, tag, address,isWrite);
+        size_t line = replaceBlock(setIndex, tag, address,isWrite);
     
         // Write  Allocate for Write Back as per problem statement.
         // means: Write back + allocate on miss -> On a write miss, the block is first loaded from memory to cache, then updated.
         // Note: Memory is updated later when the block is evicted as block is marked as dirty
         //if(config.writePolicy == WritePolicy::WB)
         if (isWrite) {
-            block->writeData(address, size, value, config.blockSize);
-            block->markDirty();
-            logAccess('W', address, setIndex, "Miss, WB Write-back with Allocation", tag, block->isDirty());
+            writeLine(line, address, size, value);
+            dirty[line] = 1;
+            if (logStream)
+                logAccess('W', address, setIndex, "Miss, WB Write-back with Allocation", tag, dirty[line]);
             return address;
         } else {
         // Read the requested data from the new block in cache. 
-            logAccess('R', address, setIndex, "Miss, Read Allocated Block (WB or WT)", tag, block->isDirty());               
-            return block->readData(address, size, isUnsigned, config.blockSize);
+            if (logStream)
+                logAccess('R', address, setIndex, "Miss, Read Allocated Block (WB or WT)", tag, dirty[line]);
+            return readLine(line, address, size, isUnsigned);
         }
 
     }
@@ -295,99 +444,217 @@
     // Update lastUsed (LRU),insertionTime(FIGF) valid, tag, etc.
     // Return the new block with correct data
 
-    CacheBlock* Cache::replaceBlock(std::vector<CacheBlock>& set, int setIndex, uint64_t tag, uint32_t address, bool isWrite) {
+    size_t Cache::replaceBlock(int setIndex, uint64_t tag, uint64_t address, bool isWrite, bool byPrefetch) {
         // Step 1: Try to find an invalid block first
-        CacheBlock* victim = nullptr;
+        size_t base = static_cast<size_t>(setIndex) * ways;
+        uint64_t blockAddr = address & ~static_cast<uint64_t>(config.blockSize - 1);
         std::string policyStr = "";
-         
-        for (auto& block : set) {
-            if (!block.isValid()) {
-                victim = &block;
-                policyStr = "INVALID_BLOCK";
-                break;
+        // Step 0: a victim cache may hold the block (with its only current copy if dirty); take
+        // it out first so this set's victim can have its entry
+        bool spillsToVictimCache = victimCache && victimCache->holdsVictims();
+        bool fromVictimCache = false;
+        bool victimCacheDirty = false;
+        const uint8_t* victimCacheBytes = nullptr;
+        if (spillsToVictimCache) {
+            int entry = victimCache->find(blockAddr);
+            if (entry >= 0) {
+                fromVictimCache = true;
+                victimCacheBytes = victimCache->take(entry, victimCacheDirty);
             }
         }
+        const void* invalidLine = std::memchr(valid.data() + base, 0, ways);
+        size_t victim;
 
+        if (invalidLine) {
+            victim = static_cast<const uint8_t*>(invalidLine) - valid.data();
+            policyStr = "INVALID_BLOCK";
+        } else {
         // Step 2: If all blocks are valid, select one to evict
-        if (!victim) {
-            victim = selectBlockToEvict(set,policyStr);
-
-            // Step 3: Write back if needed (Write-Back + Dirty)
-            if (victim->dirty && config.writePolicy == WritePolicy::WB) {
-                //uint32_t victimAddr = ((victim->tag << config.getIndexBits()) | setIndex) << config.getOffsetBits();
-                writeBlockToMemory(*victim);
+            victim = selectBlockToEvict(setIndex,policyStr);
+            if (!prefetched.empty()) {
+                if (prefetched[victim]) {
+                    prefetchStats.unused++;
+                }
+                if (byPrefetch) {
+                    evictedByPrefetch.insert(getBlockAddress(victim));
+                }
+            }
 
-                
+            // Step 3: Write back if needed (Write-Back + Dirty); TIMING memory is already current.
+            // A victim cache takes the line instead, dirty or not, and writes back what it drops.
+            if (spillsToVictimCache) {
+                victimCache->insert(getBlockAddress(victim), tagOnly ? nullptr : lineData(victim),
+                                    dirty[victim], accesses, *memory);
+            } else if (dirty[victim] && config.writePolicy == WritePolicy::WB && !tagOnly) {
+                writeBlockToMemory(victim);
             }
-            if (victim->dirty && config.writePolicy == WritePolicy::WB) {
-            logAccess('W', address, setIndex, "Evicting dirty block (WB)", victim->tag, true);
-            } else if (victim->isValid()) {
-                logAccess('W', address, setIndex, "Evicting clean block", victim->tag, false);
+            if (!logStream) {
+                // no log: skip building the messages
+            } else if (dirty[victim] && config.writePolicy == WritePolicy::WB) {
+            logAccess('W', address, setIndex, std::string("Evicting dirty block (WB)") + (spillsToVictimCache ? " to victim cache" : ""), tags[victim], true);
+            } else {
+                logAccess('W', address, setIndex, std::string("Evicting clean block") + (spillsToVictimCache ? " to victim cache" : ""), tags[victim], false);
             }
         }
 
         
 
         // Step 4: Reset and load new block
-        // Clear previous data
-        victim->data.clear();
-        victim->markValid();
-        victim->tag = tag;
-        victim->index = setIndex;
-        victim->dirty = (isWrite && config.writePolicy == WritePolicy::WB);
-        victim->lastUsed = accesses;
-        victim->insertionTime = accesses;
-        victim->data.resize(config.blockSize);
-
-        // Step 5: Load block data from memory
-        uint32_t blockAddr = address & ~(config.blockSize - 1);
-        for (int i = 0; i < config.blockSize; ++i) {
-            victim->data[i] = memory->read(blockAddr + i, MemSize::Byte);
-        }
-            
-        logAccess(isWrite?'W':'R', address, setIndex, "Miss, Replacing block in set using " + policyStr, tag, victim->isDirty());              
+        valid[victim] = 1;
+        tags[victim] = tag;
+        dirty[victim] = (isWrite && config.writePolicy == WritePolicy::WB) || victimCacheDirty;
+        lastUsed[victim] = accesses;
+        insertionTime[victim] = accesses;
+        replacement->insert(setIndex, static_cast<int>(victim - base));
+        if (!prefetched.empty()) {
+            prefetched[victim] = 0;
+        }
+
+        // Step 5: Load block data from memory (or the victim cache) into the victim's arena slot
+        if (victimCacheBytes) {
+            std::copy(victimCacheBytes, victimCacheBytes + config.blockSize, lineData(victim));
+        } else if (!tagOnly) {
+            memory->readBytes(blockAddr, lineData(victim), config.blockSize);
+            if (writeBuffer) {
+                // stores still on their way to memory
+                writeBuffer->forward(blockAddr, lineData(victim));
+            }
+        }
+        if (victimCache && !spillsToVictimCache && !byPrefetch) {
+            // miss cache: remember the demand fill
+            victimCache->insert(blockAddr, nullptr, false, accesses, *memory);
+        }
+        if (logStream && fromVictimCache)
+            logAccess(isWrite?'W':'R', address, setIndex, "Miss, Victim cache hit (swapped in)", tag, dirty[victim]);
+
+        if (logStream)
+            logAccess(isWrite?'W':'R', address, setIndex, "Miss, Replacing block in set using " + policyStr, tag, dirty[victim]);
         return victim;
     }
 
-    void Cache::writeBlockToMemory(const CacheBlock& block) {
-        uint32_t blockAddr = block.getBlockAddress(config);
-        block.writeBackToMemory(*memory, blockAddr);
+    uint64_t Cache::getBlockAddress(size_t line) const {
+        uint64_t index = line / ways;
+        return ((tags[line] << config.getIndexBits()) | index) << config.getOffsetBits();
     }
 
-    void Cache::invalidate() {
-        for (auto& set : sets) {
-            for (auto& block : set) {
-                block.markInvalid() ;    // Without this, the cache might falsely treat garbage data as valid.
-                block.markClean();   // throwing away all data, so it makes no sense to consider any block "dirty".
-                block.tag = 0;          //since valid = false, the tag is irrelevant, but zeroing it is good hygiene
-                block.lastUsed = 0;     // resetting to say this block has never been used yet
+    uint64_t Cache::readLine(size_t line, uint64_t address, MemSize size, bool isUnsigned) const {
+        if (tagOnly) {
+            return static_cast<uint64_t>(readFromMemory(address, size, isUnsigned));
+        }
+        return CacheBlock::readBytes(lineData(line), config.blockSize, address, size, isUnsigned, config.blockSize);
+    }
+
+    void Cache::writeLine(size_t line, uint64_t address, MemSize size, uint64_t value) {
+        if (tagOnly) {
+            writeToMemory(address, size, value);
+        } else {
+            CacheBlock::writeBytes(lineData(line), config.blockSize, address, size, value, config.blockSize);
+        }
+    }
+
+    void Cache::writeBlockToMemory(size_t line) {
+        memory->writeBytes(getBlockAddress(line), lineData(line), config.blockSize);
+    }
+
+    void Cache::writeThrough(uint64_t address, MemSize size, uint64_t value, bool memoryCurrent) {
+        if (!writeBuffer) {
+            if (!memoryCurrent) {
+                writeToMemory(address, size, value);
+            }
+            return;
+        }
+        if (tagOnly && !memoryCurrent) {
+            writeToMemory(address, size, value); // TIMING: the buffer only keeps the timing
+        }
+        writeBuffer->store(address, size, value, accesses, *memory);
+    }
+
+    void Cache::writeBackDirtyBlocks() {
+        for (size_t line = 0; line < tags.size(); ++line) {
+            if (valid[line] && dirty[line]) {
+                if (!tagOnly) {
+                    writeBlockToMemory(line);
+                }
+                dirty[line] = 0;
             }
         }
+        if (victimCache) {
+            victimCache->writeBackDirtyEntries(*memory);
+        }
+        drainWriteBuffer();
+    }
+
+    void Cache::drainWriteBuffer() {
+        if (writeBuffer && memory) {
+            writeBuffer->drainAll(*memory);
+        }
+    }
+
+    void Cache::invalidate() {
+        std::fill(valid.begin(), valid.end(), 0);    // Without this, the cache might falsely treat garbage data as valid.
+        std::fill(dirty.begin(), dirty.end(), 0);    // throwing away all data, so it makes no sense to consider any block "dirty".
+        std::fill(tags.begin(), tags.end(), 0);      //since valid = false, the tag is irrelevant, but zeroing it is good hygiene
+        std::fill(lastUsed.begin(), lastUsed.end(), 0); // resetting to say this block has never been used yet
+        if (replacement) {
+            replacement->reset();
+        }
+        if (prefetcher) {
+            prefetcher->reset();
+        }
+        std::fill(prefetched.begin(), prefetched.end(), 0);
+        evictedByPrefetch.clear();
+        prefetchStats = PrefetchStats();
+        if (victimCache) {
+            victimCache->invalidate();
+        }
+        if (writeBuffer) {
+            drainWriteBuffer();
+            writeBuffer->invalidate();
+        }
         accesses = 0;
         hits = 0;
         misses = 0;
     }
 
+    CacheBlock Cache::getBlock(size_t line) const {
+        CacheBlock block;
+        block.valid = valid[line];
+        block.dirty = dirty[line];
+        block.tag = tags[line];
+        block.lastUsed = lastUsed[line];
+        block.insertionTime = insertionTime[line];
+        block.data.resize(config.blockSize);
+        if (tagOnly) {
+            // Memory is current, so it holds what a DATA cache would have in the line
+            memory->readBytes(getBlockAddress(line), block.data.data(), config.blockSize);
+        } else {
+            std::copy(lineData(line), lineData(line) + config.blockSize, block.data.begin());
+        }
+        block.index = static_cast<uint32_t>(line / ways);
+        return block;
+    }
+
     void Cache::dump(std::ostream& out) const {
 
-    for (size_t i = 0; i < sets.size(); ++i) {
-        bool hasValidBlock = false;
-        for (const auto& block : sets[i]) {
-            if (block.isValid()) {
-                hasValidBlock = true;
-                break;
-            }
+    for (size_t i = 0; i < static_cast<size_t>(numSets) && ways > 0; ++i) {
+        size_t base = i * ways;
+        if (!std::memchr(valid.data() + base, 1, ways)) {
+            continue;
         }
 
-        if (hasValidBlock) {
-            out << "Set[" << std::dec << i << "]:\n";
-            for (const auto& block : sets[i]) {
-                if (block.isValid()) {
-                    out << "  " << block << "\n";
-                }
+        out << "Set[" << std::dec << i << "]:\n";
+        for (size_t line = base; line < base + ways; ++line) {
+            if (valid[line]) {
+                out << "  " << getBlock(line) << "\n";
             }
         }
     }
+        if (victimCache) {
+            victimCache->dump(out);
+        }
+        if (writeBuffer) {
+            writeBuffer->dump(out);
+        }
         out << std::dec;
     }
 
@@ -402,24 +669,159 @@
             out << "  Hit Rate: " << hitRate ;
         }
         out << "%\n";
+        if (prefetcher) {
+            const PrefetchStats& p = prefetchStats;
+            auto percent = [](uint64_t part, uint64_t whole) {
+                return whole ? static_cast<double>(part) / whole * 100.0 : 0.0;
+            };
+            // coverage: share of the misses there would have been that prefetches removed
+            uint64_t memoryMisses = misses - p.bufferHits;
+            out << "Prefetch (" << prefetcher->getName() << "):   Issued: " << p.issued
+                << "   Useful: " << p.useful
+                << "   Accuracy: " << percent(p.useful, p.issued) << "%"
+                << "   Coverage: " << percent(p.useful, p.useful + memoryMisses) << "%"
+                << "   Timely: " << percent(p.useful - p.late, p.useful) << "%"
+                << " (avg lead " << (p.useful ? static_cast<double>(p.leadSum) / p.useful : 0.0) << " accesses)"
+                << "   Unused evicted: " << p.unused
+                << "   Pollution misses: " << p.pollution;
+            if (p.bufferHits) {
+                // buffer hits are cache misses, but memory was not waited for
+                out << "   Stream buffer hits: " << p.bufferHits
+                    << "   Hit Rate incl. buffers: " << percent(hits + p.bufferHits, accesses) << "%";
+            }
+            out << "\n";
+        }
+        if (victimCache) {
+            victimCache->printStats(out, hits, accesses);
+        }
+        if (writeBuffer) {
+            writeBuffer->printStats(out);
+        }
     }
 
 
-    uint32_t Cache::read(uint32_t address, MemSize size, bool isUnsigned) {
-        return access(address, size, isUnsigned, false );
+    int64_t Cache::read(uint64_t address, MemSize size, bool isUnsigned, uint64_t pc) {
+        return static_cast<int64_t>(access(address, size, isUnsigned, false, 0, pc));
+    }
+
+    void Cache::accessBatch(const CacheAccess* batch, size_t count) {
+        std::ostream* log = logStream;
+        logStream = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            const CacheAccess& a = batch[i];
+            MemSize size = a.size >= 8 ? MemSize::DoubleWord : a.size >= 4 ? MemSize::Word
+                         : a.size >= 2 ? MemSize::HalfWord : MemSize::Byte;
+            access(a.address, size, false, a.isWrite, 0, a.pc);
+        }
+        logStream = log;
     }
 
-    void Cache::write(uint32_t address, MemSize size, uint32_t value) {
+    void Cache::write(uint64_t address, MemSize size, uint64_t value, uint64_t pc) {
         
-        access(address, size, false, true, value );
+        access(address, size, false, true, value, pc);
     }
 
-    void Cache::writeToMemory(uint32_t address, MemSize size, uint32_t value) {
+    void Cache::writeToMemory(uint64_t address, MemSize size, uint64_t value) {
         if(memory) memory->write(address,size,value);    
     }
 
 
-    int Cache::readFromMemory(uint32_t address, MemSize size, bool isUnsigned ) const {
+    int64_t Cache::readFromMemory(uint64_t address, MemSize size, bool isUnsigned ) const {
         if(memory) return memory->read(address,size,isUnsigned);    
         return -1;
     }
+
+    void Cache::saveState(CheckpointWriter& writer) const {
+        writer.writeU32(static_cast<uint32_t>(numSets));
+        writer.writeU32(tags.empty() ? 0 : static_cast<uint32_t>(ways));
+        writer.writeU32(tags.empty() ? 0 : static_cast<uint32_t>(config.blockSize));
+        writer.writeU64(accesses);
+        writer.writeU64(hits);
+        writer.writeU64(misses);
+        for (size_t line = 0; line < tags.size(); ++line) {
+            writer.writeBool(valid[line]);
+            writer.writeBool(dirty[line]);
+            writer.writeU64(tags[line]);
+            writer.writeU64(lastUsed[line]);
+            writer.writeU64(insertionTime[line]);
+        }
+        writer.writeBytes(arena.data(), arena.size());
+        if (replacement) {
+            replacement->saveState(writer);
+        }
+        if (prefetcher) {
+            writer.writeBytes(prefetched.data(), prefetched.size());
+            for (uint64_t issuedAt : prefetchedAt) {
+                writer.writeU64(issuedAt);
+            }
+            const uint64_t counters[] = {prefetchStats.issued, prefetchStats.useful, prefetchStats.late,
+                                         prefetchStats.leadSum, prefetchStats.unused, prefetchStats.pollution,
+                                         prefetchStats.bufferHits};
+            for (uint64_t counter : counters) {
+                writer.writeU64(counter);
+            }
+            writer.writeU64(evictedByPrefetch.size());
+            for (uint64_t block : evictedByPrefetch) {
+                writer.writeU64(block);
+            }
+            prefetcher->saveState(writer);
+        }
+        if (victimCache) {
+            victimCache->saveState(writer);
+        }
+        if (writeBuffer) {
+            writeBuffer->saveState(writer);
+        }
+    }
+
+    bool Cache::loadState(CheckpointReader& reader) {
+        uint32_t setCount = reader.readU32();
+        uint32_t wayCount = reader.readU32();
+        uint32_t blockSize = reader.readU32();
+        if (setCount != (tags.empty() ? 0u : static_cast<uint32_t>(numSets)) ||
+            (setCount > 0 && (wayCount != static_cast<uint32_t>(ways) ||
+                              blockSize != static_cast<uint32_t>(config.blockSize)))) {
+            return false;
+        }
+        accesses = reader.readU64();
+        hits = reader.readU64();
+        misses = reader.readU64();
+        for (size_t line = 0; line < tags.size(); ++line) {
+            valid[line] = reader.readBool();
+            dirty[line] = reader.readBool();
+            tags[line] = reader.readU64();
+            lastUsed[line] = reader.readU64();
+            insertionTime[line] = reader.readU64();
+        }
+        reader.readBytes(arena.data(), arena.size());
+        if (replacement && !replacement->loadState(reader)) {
+            return false;
+        }
+        if (prefetcher) {
+            reader.readBytes(prefetched.data(), prefetched.size());
+            for (uint64_t& issuedAt : prefetchedAt) {
+                issuedAt = reader.readU64();
+            }
+            uint64_t* counters[] = {&prefetchStats.issued, &prefetchStats.useful, &prefetchStats.late,
+                                    &prefetchStats.leadSum, &prefetchStats.unused, &prefetchStats.pollution,
+                                    &prefetchStats.bufferHits};
+            for (uint64_t* counter : counters) {
+                *counter = reader.readU64();
+            }
+            uint64_t evicted = reader.readU64();
+            evictedByPrefetch.clear();
+            for (uint64_t i = 0; i < evicted && reader.isGood(); ++i) {
+                evictedByPrefetch.insert(reader.readU64());
+            }
+            if (!prefetcher->loadState(reader)) {
+                return false;
+            }
+        }
+        if (victimCache && !victimCache->loadState(reader)) {
+            return false;
+        }
+        if (writeBuffer && !writeBuffer->loadState(reader)) {
+            return false;
+        }
+        return reader.isGood();
+    }
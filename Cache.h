@@ -11,11 +11,44 @@
  *
  * @param config      The cache configuration, specifying size, associativity, and block size.
  * @param numSets     The number of sets in the cache, derived from the configuration.
- * @param sets        The cache storage, organized as a vector of sets, each containing cache blocks.
+ * @param tags, valid The tag store: one entry per line, a set's lines contiguous (see below).
  * @param accessCounter  A counter to track the number of accesses, useful for replacement policies.
  * @param accesses    The total number of cache accesses.
  * @param hits        The number of cache hits.
  * @param misses      The number of cache misses.
+ *
+ * Lines are stored as a structure of arrays: line = set * ways + way, with tags, valid bits,
+ * dirty bits, LRU and FIFO stamps each in their own array. Block data lives in one 64-byte
+ * aligned arena of numSets * ways * blockSize bytes, line i at offset i * blockSize, so a miss
+ * fills (and a dirty eviction writes back) a line with one bulk copy against Memory and never
+ * allocates. A lookup only touches the
+ * set's run of tags, compared 4 at a time with AVX2 (2 at a time with SSE2) on x86-64 hosts
+ * and one at a time elsewhere; the valid byte is checked only for matching tags.
+ * getBlock() gathers one line into a CacheBlock for printing. Victims of full sets come from the
+ * CacheReplacement policy named in the config, which sees every hit and fill.
+ *
+ * An optional CachePrefetcher sees every demand access (with the instruction's pc) and names
+ * blocks to prefetch; Cache loads the uncached ones as prefetched lines, or claims a missed
+ * block from the prefetcher's stream buffers. Hits and misses stay demand-only; PrefetchStats
+ * counts accuracy, coverage, timeliness and pollution, printed by printStats().
+ *
+ * An optional VictimCache is probed on every demand miss. As a victim cache it receives every
+ * evicted line (dirty ones too, instead of writing them back) and hands a hit back to
+ * replaceBlock(), which swaps it with the line it evicts; as a miss cache it only remembers
+ * the blocks demand misses filled. Its hits are still misses here and are counted on its own line.
+ *
+ * With WT and writeBufferEntries set, write-through stores go into a coalescing WriteBuffer
+ * instead of straight to Memory; fills see its pending bytes, and the cycles stores wait for a
+ * full buffer add up in getWriteBufferStallCycles().
+ *
+ * With CacheModel::TIMING there is no arena: Memory stays authoritative and every read and
+ * write goes straight to it, while the cache updates only tags, dirty bits and replacement
+ * stamps. Hits, misses, evictions, logs and dumps are the same as with DATA (getBlock() reads
+ * a line's bytes from Memory, which then holds what the DATA line would).
+ *
+ * accessBatch() runs a whole array of accesses (e.g. from an address trace) through the same
+ * lookup, replacement and write-policy code as access(), with logging switched off. Writes
+ * store zeros, since traces carry no data.
  */
 
 #ifndef CACHE_H
@@ -24,13 +57,59 @@
 
 #include <vector>
 #include <cstdint>
+#include <new>
 #include <fstream>
 #include <string>
 #include "CacheConfig.h"
 #include "CacheBlock.h"
 #include "Memory.h"
 #include "AddressDecoder.h"
+#include "Checkpoint.h"
+#include "CacheReplacement.h"
+#include "CachePrefetcher.h"
+#include "VictimCache.h"
+#include "WriteBuffer.h"
+#include <memory>
+#include <unordered_set>
+
 
+// Allocates cache line storage on 64-byte (host cache line) boundaries
+template <typename T>
+struct CacheLineAllocator {
+    using value_type = T;
+    CacheLineAllocator() = default;
+    template <typename U>
+    CacheLineAllocator(const CacheLineAllocator<U>&) {}
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(64)));
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(64));
+    }
+    template <typename U>
+    bool operator==(const CacheLineAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheLineAllocator<U>&) const { return false; }
+};
+
+// One access of a batch; size is in bytes (1, 2, 4 or 8); pc is the instruction's, 0 if unknown
+struct CacheAccess {
+    uint64_t address;
+    uint8_t size;
+    bool isWrite;
+    uint64_t pc = 0;
+};
+
+// Prefetcher effectiveness, counted by Cache (see printStats())
+struct PrefetchStats {
+    uint64_t issued = 0;     // blocks the prefetcher fetched, into the cache or its stream buffers
+    uint64_t useful = 0;     // of those, demanded before being evicted or dropped
+    uint64_t late = 0;       // useful, but demanded fewer than prefetchLatency accesses after issue
+    uint64_t leadSum = 0;    // accesses from issue to first use, summed over useful prefetches
+    uint64_t unused = 0;     // prefetched lines evicted from the cache before any use
+    uint64_t pollution = 0;  // demand misses on blocks that a prefetch fill had evicted
+    uint64_t bufferHits = 0; // misses served by a stream buffer (also counted in useful)
+};
 
 class Cache {
 public:
@@ -40,30 +119,58 @@ public:
     // Resets statistics and access counter.
     void reset();
 
-    uint32_t read(uint32_t address, MemSize size, bool isUnsigned = false);
-    void write(uint32_t address, MemSize size, uint32_t value);
+    int64_t read(uint64_t address, MemSize size, bool isUnsigned = false, uint64_t pc = 0);
+    void write(uint64_t address, MemSize size, uint64_t value, uint64_t pc = 0);
 
     // Simulates a read or write operation:
     //      Increments accessCounter and accesses. Looks up the correct set and tag.
     //      If found → Hit. If not → Miss, replace block using policy.
     //      If isWrite and policy is Write-Back, mark block dirty.
-    uint32_t access(uint32_t address, MemSize size, bool isUnsigned, bool isWrite, uint32_t writeValue=0);
-    // Clears the cache (marks all blocks invalid).
+    // pc: the load/store's address, used by the STRIDE prefetcher
+    uint64_t access(uint64_t address, MemSize size, bool isUnsigned, bool isWrite, uint64_t writeValue=0, uint64_t pc=0);
+    // Runs count accesses in order without logging them. (A pointer and a count, since
+    // C++17 has no std::span.)
+    void accessBatch(const CacheAccess* batch, size_t count);
+    void accessBatch(const std::vector<CacheAccess>& batch) { accessBatch(batch.data(), batch.size()); }
+    // Clears the cache (marks all blocks invalid). Stores still in the write buffer are
+    // already committed, so they are written to memory first.
     void invalidate();
+    // Writes every store pending in the write buffer to memory (no-op without one)
+    void drainWriteBuffer();
+    // Writes every dirty block back to memory and marks it clean (contents stay cached).
+    void writeBackDirtyBlocks();
     //Dump the current cache state to a outputstream (like a memory dump).
     void dump(std::ostream& out) const;
     //Displays performance
     void printStats(std::ostream& out) const;
 
-    void writeToMemory(uint32_t address, MemSize size, uint32_t value) ;
-    int readFromMemory(uint32_t address, MemSize size, bool isUnsigned = false) const;
+    void writeToMemory(uint64_t address, MemSize size, uint64_t value) ;
+    int64_t readFromMemory(uint64_t address, MemSize size, bool isUnsigned = false) const;
     void setLogStream(std::ostream& log) { logStream = &log;}
 
+    uint64_t getAccesses() const { return accesses; }
+    uint64_t getHits() const { return hits; }
+    const PrefetchStats& getPrefetchStats() const { return prefetchStats; }
+    uint64_t getMisses() const { return misses; }
+    // null when the config has no victim / miss cache
+    const VictimCache* getVictimCache() const { return victimCache.get(); }
+    // cycles stores have stalled on a full write buffer (0 without one)
+    uint64_t getWriteBufferStallCycles() const { return writeBuffer ? writeBuffer->getStallCycles() : 0; }
+
+    // checkpoint: statistics and every block (valid/dirty bits, tag, LRU/FIFO stamps, data).
+    // loadState() expects the cache to be enabled with the same geometry already.
+    void saveState(CheckpointWriter& writer) const;
+    bool loadState(CheckpointReader& reader);
+
     
-    // Set the seed for the random number generator (for testing)
+    // The line (set * ways + way) as a CacheBlock, for printing and inspection
+    CacheBlock getBlock(size_t line) const;
+    // "AVX2", "SSE2" or "scalar": how tags are compared for this host and associativity
+    const char* getTagMatchKind() const;
+
+    // Seed of the RANDOM replacement policy's generator; takes effect at the next enable()
     void setRandomSeed(uint32_t seed) {
         randomSeed = seed;
-        std::srand(randomSeed);
     }
 
     private:
@@ -71,17 +178,39 @@ public:
         std::ostream* logStream = nullptr;
         Memory *memory = nullptr;
         CacheConfig config;
-        uint32_t randomSeed = 0; // 0 means "not set", use time-based default which will be real random
+        uint32_t randomSeed = 0; // 0: the generator's default seed
 
         AddressDecoder addrDecoder;
         //the number of rows: numSets = (cacheSize / blockSize) / associativity;
         int numSets;
-        // Each sets[i] is a row of lockers (a set), containing associativity number of CacheBlocks.
-        //sets[0] = {block1, block2, block3, block4};  -> 4 blocks in set 0
-        std::vector<std::vector<CacheBlock>> sets;
+        // blocks per set (the associativity; all blocks when fully associative)
+        int ways = 0;
+        // Tag store, one entry per line; set i owns lines [i * ways, (i + 1) * ways)
+        std::vector<uint64_t> tags;
+        std::vector<uint8_t> valid;          // 1 if the line holds a block
+        std::vector<uint8_t> dirty;          // 1 if written since it was loaded (WB)
+        std::vector<uint64_t> lastUsed;      // access count at the last hit or fill (LRU)
+        std::vector<uint64_t> insertionTime; // access count at the fill (FIFO)
+        std::vector<uint8_t, CacheLineAllocator<uint8_t>> arena; // blockSize bytes per line, line-major
+        bool tagOnly = false; // CacheModel::TIMING: no arena, Memory serves all data
+        // picks victims; told about every hit and fill (see CacheReplacement.h)
+        std::unique_ptr<CacheReplacement> replacement;
+        // Prefetching (see CachePrefetcher.h); null and empty when the config has no prefetcher
+        std::unique_ptr<CachePrefetcher> prefetcher;
+        std::vector<uint8_t> prefetched;       // 1 while a prefetched line has not been demanded
+        std::vector<uint64_t> prefetchedAt;    // access count the line was prefetched at
+        std::unordered_set<uint64_t> evictedByPrefetch; // blocks a prefetch fill evicted (for pollution)
+        std::vector<uint64_t> prefetchQueue;   // blocks requested by the last observe()
+        PrefetchStats prefetchStats;
+        // victim or miss cache (see VictimCache.h); null when victimEntries is 0
+        std::unique_ptr<VictimCache> victimCache;
+        // WT store buffer (see WriteBuffer.h); null without one or with WB
+        std::unique_ptr<WriteBuffer> writeBuffer;
+        // the way of a set (given its tags and valid bytes) that holds tag, or -1; picked by enable()
+        int (*findTag)(const uint64_t* tags, const uint8_t* valid, int ways, uint64_t tag) = nullptr;
         //A global counter that increases every time the cache is accessed (read or write).
         //Used in LRU replacement: Helps determine which block was least recently used by comparing their lastUsed timestamps.
-        int accesses;
+        uint64_t accesses;
 
         // Performance Statistics
         //    accesses: Total number of times the cache was accessed (read/write).
@@ -91,30 +220,37 @@ public:
         //          If the cache is valid and contains the tag: Hit.
         //          Else: Miss, and the cache has to bring data from memory and possibly evict an existing block.
 
-        int hits;
-        int misses;
+        uint64_t hits;
+        uint64_t misses;
 
-        // Helper functions to extract index, Tag etc
-        int getSetIndex(int address) const;
-        int getTag(int address) const;
-        //Checks if a block with a specific tag exists in the given set. Returns its index if found (i.e., hit), or -1 (i.e., miss).
-        int findBlockIndex(int setIndex, int tag) const;
-        // Chooses which block in a full set to evict. Based on the ReplacementPolicy:
+        // Chooses which line of a full set to evict. Based on the ReplacementPolicy:
         //        FIFO: First one inserted.
         //        LRU: Least recently used (lastUsed is smallest).
         //        RANDOM: Any block.
-        
-        CacheBlock* selectBlockToEvict(std::vector<CacheBlock>& set,std::string &policyStr) ;
-
-        std::pair<uint32_t, uint64_t> decodeAddress(uint32_t address) const;
-        CacheBlock* findBlockInSet(std::vector<CacheBlock>& set, uint64_t tag);
-        uint32_t handleWriteHit(CacheBlock& block, int setIndex, uint32_t address, MemSize size, uint32_t value) ;
-        uint32_t handleMiss(std::vector<CacheBlock>& set, int setIndex, uint32_t address, uint64_t tag,
-                            MemSize size, bool isUnsigned, bool isWrite, uint32_t value);
-        CacheBlock* replaceBlock(std::vector<CacheBlock>& set, int setIndex, uint64_t tag, uint32_t address,bool isWrite);
-        void writeBlockToMemory(const CacheBlock& block) ;
-
-        void logAccess(char op, uint32_t address, uint32_t setIndex, const std::string& hitOrMiss, uint32_t tag, bool dirty);
+        size_t selectBlockToEvict(uint32_t setIndex, std::string &policyStr);
+
+        uint64_t handleWriteHit(size_t line, int setIndex, uint64_t address, MemSize size, uint64_t value) ;
+        uint64_t handleMiss(int setIndex, uint64_t address, uint64_t tag,
+                            MemSize size, bool isUnsigned, bool isWrite, uint64_t value);
+        // byPrefetch: the fill is a prefetch (its evictions count towards pollution)
+        size_t replaceBlock(int setIndex, uint64_t tag, uint64_t address, bool isWrite, bool byPrefetch = false);
+        // tells the prefetcher about a demand access and loads the blocks it asks for
+        void runPrefetcher(uint64_t address, uint64_t pc, bool miss, bool firstUse);
+        void prefetchBlock(uint64_t blockAddress);
+        // a prefetched block issued at issuedAt was demanded now
+        void countPrefetchUse(uint64_t issuedAt);
+        void writeBlockToMemory(size_t line) ;
+        // a write-through store on its way to memory, through the write buffer if there is one;
+        // memoryCurrent: TIMING already wrote it
+        void writeThrough(uint64_t address, MemSize size, uint64_t value, bool memoryCurrent);
+        uint64_t getBlockAddress(size_t line) const;
+        // a read or write of the line's data: the arena for DATA, Memory for TIMING
+        uint64_t readLine(size_t line, uint64_t address, MemSize size, bool isUnsigned) const;
+        void writeLine(size_t line, uint64_t address, MemSize size, uint64_t value);
+        uint8_t* lineData(size_t line) { return arena.data() + line * config.blockSize; }
+        const uint8_t* lineData(size_t line) const { return arena.data() + line * config.blockSize; }
+
+        void logAccess(char op, uint64_t address, uint32_t setIndex, const std::string& hitOrMiss, uint64_t tag, bool dirty);
 };
 
 #endif // CACHE_H
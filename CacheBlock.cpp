@@ -15,39 +15,49 @@
 // Reads value from this block at the given address offset.
     
 
-void CacheBlock::writeData(uint32_t address, MemSize Msize, uint32_t value, uint32_t blockSize) {
+void CacheBlock::writeData(uint64_t address, MemSize Msize, uint64_t value, uint32_t blockSize) {
+    uint32_t offset = address % blockSize;
+    if (offset + static_cast<int>(Msize) > data.size()) return; // Prevent overflow
+    writeBytes(data.data(), data.size(), address, Msize, value, blockSize);
+    valid = true;
+}
+
+// Reads value from this block at the given address offset.
+uint64_t CacheBlock::readData(uint64_t address, MemSize Msize,   bool isUnsigned, uint32_t blockSize) const {
+    return readBytes(data.data(), data.size(), address, Msize, isUnsigned, blockSize);
+}
+
+void CacheBlock::writeBytes(uint8_t* data, size_t length, uint64_t address, MemSize Msize, uint64_t value, uint32_t blockSize) {
     uint32_t offset = address % blockSize;
     int size = static_cast<int>(Msize);
-    if (offset + size > data.size()) return; // Prevent overflow
+    if (offset + size > length) return; // Prevent overflow
 
     for (int i = 0; i < size; ++i) {
         data[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
     }
-    valid = true;
 }
 
-// Reads value from this block at the given address offset.
-uint32_t CacheBlock::readData(uint32_t address, MemSize Msize,   bool isUnsigned, uint32_t blockSize) const {
+uint64_t CacheBlock::readBytes(const uint8_t* data, size_t length, uint64_t address, MemSize Msize, bool isUnsigned, uint32_t blockSize) {
     uint32_t offset = address % blockSize;
     int size = static_cast<int>(Msize);
-    uint32_t result = 0;
+    uint64_t result = 0;
     for (int i = 0; i < size; ++i) {
-        if (offset + i < data.size()) {
-            result |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+        if (offset + i < length) {
+            result |= static_cast<uint64_t>(data[offset + i]) << (8 * i);
         }
     }
 
-    if (!isUnsigned && size < 4) {
+    if (!isUnsigned && size < 8) {
         // Sign-extend if needed
-        int32_t signedVal = static_cast<int32_t>(result << ((4 - size) * 8));
-        return static_cast<uint32_t>(signedVal >> ((4 - size) * 8));
+        int64_t signedVal = static_cast<int64_t>(result << ((8 - size) * 8));
+        return static_cast<uint64_t>(signedVal >> ((8 - size) * 8));
     }
 
     return result;
 }
 
 //Writes each byte of the block to memory at the correct offset with MemSize::Byte.
-void CacheBlock::writeBackToMemory(Memory& memory, uint32_t baseAddress) const {
+void CacheBlock::writeBackToMemory(Memory& memory, uint64_t baseAddress) const {
     if (!valid) return;
 
     for (int i = 0; i < (int) data.size(); ++i) {
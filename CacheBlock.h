@@ -5,6 +5,10 @@
  *
  * A CacheBlock models the behavior and state of a cache line in a CPU cache system.
  * It stores data, tag, validity, dirtiness, and metadata for replacement policies.
+ *
+ * Cache itself keeps its lines as a structure of arrays (see Cache.h); CacheBlock is the
+ * state of one line gathered into an object, used to print and inspect it. The static
+ * readBytes()/writeBytes() are the byte-level line access shared by both.
  * 
  * Usage:
  * - When a CPU requests data, the cache uses the address to extract the index and tag.
@@ -70,16 +74,21 @@ public:
     CacheBlock() : valid(false), dirty(false), tag(0), lastUsed(0), insertionTime(0),index(0) {}
     // Writes value into this block at the correct offset based on the memory address.
     // Assumes this block starts at a given base address (block-aligned).
-    void writeData(uint32_t address, MemSize size, uint32_t value, uint32_t blockSize);
-    // Reads value from this block at the given address offset.
-    uint32_t readData(uint32_t address, MemSize size,   bool isUnsigned, uint32_t blockSize) const;
+    void writeData(uint64_t address, MemSize size, uint64_t value, uint32_t blockSize);
+    // Reads value from this block at the given address offset, sign- or zero-extended to 64 bits.
+    uint64_t readData(uint64_t address, MemSize size,   bool isUnsigned, uint32_t blockSize) const;
+
+    // The same on length bytes of line data: a write that would run past the end is dropped,
+    // a read returns zeros for the bytes past the end.
+    static void writeBytes(uint8_t* data, size_t length, uint64_t address, MemSize size, uint64_t value, uint32_t blockSize);
+    static uint64_t readBytes(const uint8_t* data, size_t length, uint64_t address, MemSize size, bool isUnsigned, uint32_t blockSize);
     // method to get the memory address this block maps to
-    uint32_t getBlockAddress(const CacheConfig& config) const {
-        uint32_t blockAddr = ((tag << config.getIndexBits()) | index) << config.getOffsetBits();
+    uint64_t getBlockAddress(const CacheConfig& config) const {
+        uint64_t blockAddr = ((tag << config.getIndexBits()) | index) << config.getOffsetBits();
         return blockAddr;
     }
 
-    void writeBackToMemory(Memory& memory, uint32_t blockStartAddress) const;
+    void writeBackToMemory(Memory& memory, uint64_t blockStartAddress) const;
 
     inline bool isValid() const { return valid;}
 
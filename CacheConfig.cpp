@@ -1,4 +1,4 @@
-// Reads exactly 5 lines in order as per your example config.
+// Reads 5 lines in order as per your example config, then optional extras (model, key=value settings).
 //Validates power-of-two constraints and value ranges.
 // For associativity: 
 //          0 means fully associative → sets = 1, blocks per set = total blocks. 1 means direct mapped.
@@ -12,8 +12,13 @@ The cache configuration is provided as an input file (e.g., cache.config) in the
 SIZE_OF_CACHE (number)
 BLOCK_SIZE (number)
 ASSOCIATIVITY (number)
-REPLACEMENT_POLICY (FIFO or LRU or RANDOM)
+REPLACEMENT_POLICY (FIFO, LRU, RANDOM, PLRU, NRU (or BITPLRU), SRRIP, BRRIP or DRRIP)
 WRITEBACK_POLICY (WB or WT)
+MODEL (DATA or TIMING; optional, defaults to DATA)
+key=value settings, optional, any order: prefetcher=NONE|NEXTLINE|STRIDE|STREAM,
+    prefetchDegree=N, prefetchEntries=N, prefetchLatency=N (0 degree/entries: prefetcher default),
+    victimEntries=N (0: none), victimKind=VICTIM|MISS, victimPolicy=FIFO|LRU,
+    writeBufferEntries=N (0: none; WT only), writeBufferDrain=N
 Example config file:
 32168
 16
@@ -38,10 +43,32 @@ std::string replacementPolicyToString(ReplacementPolicy p) {
         case ReplacementPolicy::FIFO: return "FIFO";
         case ReplacementPolicy::LRU: return "LRU";
         case ReplacementPolicy::RANDOM: return "RANDOM";
+        case ReplacementPolicy::PLRU: return "PLRU";
+        case ReplacementPolicy::NRU: return "NRU";
+        case ReplacementPolicy::SRRIP: return "SRRIP";
+        case ReplacementPolicy::BRRIP: return "BRRIP";
+        case ReplacementPolicy::DRRIP: return "DRRIP";
         default: return "UNKNOWN";
     }
 }
 
+bool parseReplacementPolicy(const std::string& name, ReplacementPolicy& policy) {
+    static const ReplacementPolicy all[] = {ReplacementPolicy::FIFO, ReplacementPolicy::LRU, ReplacementPolicy::RANDOM,
+                                            ReplacementPolicy::PLRU, ReplacementPolicy::NRU, ReplacementPolicy::SRRIP,
+                                            ReplacementPolicy::BRRIP, ReplacementPolicy::DRRIP};
+    for (ReplacementPolicy p : all) {
+        if (name == replacementPolicyToString(p)) {
+            policy = p;
+            return true;
+        }
+    }
+    if (name == "BITPLRU") {
+        policy = ReplacementPolicy::NRU;
+        return true;
+    }
+    return false;
+}
+
 // Helper to print WritePolicy as string
 std::string writePolicyToString(WritePolicy w) {
     switch (w) {
@@ -51,6 +78,23 @@ std::string writePolicyToString(WritePolicy w) {
     }
 }
 
+std::string cacheModelToString(CacheModel m) {
+    return m == CacheModel::TIMING ? "TIMING" : "DATA";
+}
+
+std::string prefetcherToString(PrefetcherKind k) {
+    switch (k) {
+        case PrefetcherKind::NEXTLINE: return "NEXTLINE";
+        case PrefetcherKind::STRIDE: return "STRIDE";
+        case PrefetcherKind::STREAM: return "STREAM";
+        default: return "NONE";
+    }
+}
+
+std::string victimKindToString(VictimKind k) {
+    return k == VictimKind::MISS ? "MISS" : "VICTIM";
+}
+
 // Overload operator<< to print CacheConfig
 std::ostream& operator<<(std::ostream& os, const CacheConfig& config) {
     os << std::dec;
@@ -59,6 +103,21 @@ std::ostream& operator<<(std::ostream& os, const CacheConfig& config) {
     os << "Associativity: " << config.associativity << "\n";
     os << "Replacement Policy: " << replacementPolicyToString(config.replacementPolicy) << "\n";
     os << "Write Back Policy: " << writePolicyToString(config.writePolicy) << "\n";
+    if (config.model != CacheModel::DATA) {
+        os << "Model: " << cacheModelToString(config.model) << "\n";
+    }
+    if (config.prefetcher != PrefetcherKind::NONE) {
+        os << "Prefetcher: " << prefetcherToString(config.prefetcher) << " (degree " << config.prefetchDegree
+           << ", entries " << config.prefetchEntries << ", latency " << config.prefetchLatency << "; 0 = default)\n";
+    }
+    if (config.victimEntries > 0) {
+        os << (config.victimKind == VictimKind::MISS ? "Miss" : "Victim") << " Cache: " << config.victimEntries
+           << " entries, " << replacementPolicyToString(config.victimPolicy) << "\n";
+    }
+    if (config.writeBufferEntries > 0) {
+        os << "Write Buffer: " << config.writeBufferEntries << " entries, drain every "
+           << config.writeBufferDrain << " cycles\n";
+    }
     return os;
 }
 
@@ -74,13 +133,85 @@ bool CacheConfig::loadFromFile(const std::string& filename) {
     }
 
     int sizeOfCache, blkSz, assoc;
-    std::string replPolicyStr, writePolicyStr;
+    std::string replPolicyStr, writePolicyStr, modelStr;
 
     if (!(file >> sizeOfCache)) return false;
     if (!(file >> blkSz)) return false;
     if (!(file >> assoc)) return false;
     if (!(file >> replPolicyStr)) return false;
     if (!(file >> writePolicyStr)) return false;
+    // the rest is optional: a model name and key=value settings. Anything else after the write
+    // policy was always ignored, so it still is (with a warning) rather than failing old files.
+    modelStr = "DATA";
+    std::string extra, ignored;
+    while (file >> extra) {
+        size_t eq = extra.find('=');
+        if (eq == std::string::npos) {
+            if (extra == "DATA" || extra == "TIMING") {
+                modelStr = extra;
+            } else {
+                ignored += " " + extra;
+            }
+            continue;
+        }
+        std::string key = extra.substr(0, eq);
+        std::string value = extra.substr(eq + 1);
+        if (key == "prefetcher") {
+            if (value == "NONE") prefetcher = PrefetcherKind::NONE;
+            else if (value == "NEXTLINE") prefetcher = PrefetcherKind::NEXTLINE;
+            else if (value == "STRIDE") prefetcher = PrefetcherKind::STRIDE;
+            else if (value == "STREAM") prefetcher = PrefetcherKind::STREAM;
+            else {
+                std::cerr << "Unknown prefetcher: " << value << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (key == "victimKind") {
+            if (value == "VICTIM") victimKind = VictimKind::VICTIM;
+            else if (value == "MISS") victimKind = VictimKind::MISS;
+            else {
+                std::cerr << "Unknown victim cache kind: " << value << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (key == "victimPolicy") {
+            // a handful of entries: only the stamp-based policies make sense
+            if (value == "LRU") victimPolicy = ReplacementPolicy::LRU;
+            else if (value == "FIFO") victimPolicy = ReplacementPolicy::FIFO;
+            else {
+                std::cerr << "Victim cache policy must be FIFO or LRU: " << value << "\n";
+                return false;
+            }
+            continue;
+        }
+        int* setting = nullptr;
+        if (key == "prefetchDegree") setting = &prefetchDegree;
+        else if (key == "prefetchEntries") setting = &prefetchEntries;
+        else if (key == "prefetchLatency") setting = &prefetchLatency;
+        else if (key == "victimEntries") setting = &victimEntries;
+        else if (key == "writeBufferEntries") setting = &writeBufferEntries;
+        else if (key == "writeBufferDrain") setting = &writeBufferDrain;
+        else {
+            ignored += " " + extra;
+            continue;
+        }
+        int number = 0;
+        try {
+            size_t used = 0;
+            number = std::stoi(value, &used);
+            if (used != value.size() || number < 0) throw std::invalid_argument(value);
+        } catch (const std::exception&) {
+            std::cerr << "Bad value for " << key << ": " << value << "\n";
+            return false;
+        }
+        *setting = number;
+    }
+
+    if (!ignored.empty()) {
+        std::cerr << "Warning: ignoring unknown words in cache config " << filename << ":" << ignored << "\n";
+    }
 
     // Validate and assign
     if (sizeOfCache <= 0 || sizeOfCache > 1024 * 1024) {
@@ -102,10 +233,7 @@ bool CacheConfig::loadFromFile(const std::string& filename) {
     }
 
     // Map replacement policy string
-    if (replPolicyStr == "FIFO") replacementPolicy = ReplacementPolicy::FIFO;
-    else if (replPolicyStr == "LRU") replacementPolicy = ReplacementPolicy::LRU;
-    else if (replPolicyStr == "RANDOM") replacementPolicy = ReplacementPolicy::RANDOM;
-    else {
+    if (!parseReplacementPolicy(replPolicyStr, replacementPolicy)) {
         std::cerr << "Unknown replacement policy: " << replPolicyStr << "\n";
         return false;
     }
@@ -117,6 +245,12 @@ bool CacheConfig::loadFromFile(const std::string& filename) {
         std::cerr << "Unknown write policy: " << writePolicyStr << "\n";
         return false;
     }
+    if (writeBufferEntries > 0 && writePolicy != WritePolicy::WT) {
+        std::cerr << "Warning: the write buffer only buffers write-through stores; ignored with "
+                  << writePolicyStr << ".\n";
+    }
+
+    model = modelStr == "TIMING" ? CacheModel::TIMING : CacheModel::DATA;
 
     cacheSize = sizeOfCache;
     blockSize = blkSz;
@@ -127,6 +261,13 @@ bool CacheConfig::loadFromFile(const std::string& filename) {
 
 
 
+bool CacheConfig::isValid() const {
+    if (!isPowerOfTwo(cacheSize) || cacheSize > 1024 * 1024) return false;
+    if (!isPowerOfTwo(blockSize) || blockSize > 64 || blockSize > cacheSize) return false;
+    if (associativity < 0 || associativity > 16 || (associativity != 0 && !isPowerOfTwo(associativity))) return false;
+    return associativity <= cacheSize / blockSize;
+}
+
 int CacheConfig::getOffsetBits() const {
     return BitUtils::log2(blockSize);
 }
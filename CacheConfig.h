@@ -9,9 +9,25 @@ ReplacementPolicy -> decides which block to evict when a set is full and new dat
     FIFO: Replace the block that entered the set earliest.
     LRU: Replace the block that was used least recently.
     RANDOM: Replace a random block in the set.
+    PLRU: Tree pseudo-LRU.  NRU (or BITPLRU): one recently-used bit per block.
+    SRRIP, BRRIP, DRRIP: re-reference interval prediction (static, bimodal, set-dueling).
+    See CacheReplacement.h.
 writePolicy ->Controls how writes to memory are handled when a cache block is modified.
     WB (Write-Back): Data is written to memory only when block is evicted. Modified blocks are marked dirty.
     WT (Write-Through): Data is written immediately to main memory every time it is updated in the cache.
+model -> What the cache holds (optional, default DATA).
+    DATA: Blocks hold a copy of their bytes; reads are served from the cache, dirty blocks are written back.
+    TIMING: Tag-only model. Memory stays authoritative and serves every access; the cache only tracks
+        tags, dirty bits and replacement state, so hits/misses/evictions are the same as DATA.
+prefetcher -> Optional hardware prefetcher, see CachePrefetcher.h (default NONE).
+    NEXTLINE: next prefetchDegree blocks on a miss.  STRIDE: PC-indexed stride table of prefetchEntries.
+    STREAM: prefetchEntries stream buffers of prefetchDegree blocks.
+    prefetchLatency: a useful prefetch issued fewer accesses than this before its first use is late.
+victimEntries -> Optional fully-associative buffer probed on every miss, see VictimCache.h (default 0: none).
+    victimKind VICTIM: holds evicted lines, swapped back in on a hit.  MISS: holds recently missed blocks.
+    victimPolicy: FIFO or LRU replacement within the buffer.
+writeBufferEntries -> WT only: coalescing write buffer in front of memory, see WriteBuffer.h (default 0: none).
+    writeBufferDrain: cycles (cache accesses) to write one entry to memory.
 loadFromFile(filename):Reads cache parameters from a config file
 e.g: cacheSize=8192
 blockSize=64
@@ -25,8 +41,11 @@ writePolicy=WB
 #include <string>
 #include <iostream>
 
-enum class ReplacementPolicy { FIFO, LRU, RANDOM };
+enum class ReplacementPolicy { FIFO, LRU, RANDOM, PLRU, NRU, SRRIP, BRRIP, DRRIP };
 enum class WritePolicy { WB, WT };
+enum class CacheModel { DATA, TIMING };
+enum class PrefetcherKind { NONE, NEXTLINE, STRIDE, STREAM };
+enum class VictimKind { VICTIM, MISS };
 
 class CacheConfig {
 public:
@@ -35,6 +54,16 @@ public:
     int associativity;        // Associativity (1=direct mapped, 0=fully associative, else set assoc up to 16)
     ReplacementPolicy replacementPolicy;
     WritePolicy writePolicy;
+    CacheModel model = CacheModel::DATA;
+    PrefetcherKind prefetcher = PrefetcherKind::NONE;
+    int prefetchDegree = 0;   // blocks ahead (NEXTLINE 1, STRIDE 2) or buffer depth (STREAM 4); 0 = default
+    int prefetchEntries = 0;  // stride table entries (64) or stream buffers (4); 0 = default
+    int prefetchLatency = 16; // accesses a prefetch needs to be timely
+    int victimEntries = 0;    // victim / miss cache entries; 0 = none
+    VictimKind victimKind = VictimKind::VICTIM;
+    ReplacementPolicy victimPolicy = ReplacementPolicy::LRU; // FIFO or LRU
+    int writeBufferEntries = 0; // write buffer entries (WT only); 0 = stores go straight to memory
+    int writeBufferDrain = 4;   // cycles to drain one entry
 
     CacheConfig()=default;
 
@@ -43,11 +72,20 @@ public:
     // SIZE_OF_CACHE
     // BLOCK_SIZE
     // ASSOCIATIVITY
-    // REPLACEMENT_POLICY (FIFO, LRU, RANDOM)
+    // REPLACEMENT_POLICY (FIFO, LRU, RANDOM, PLRU, NRU/BITPLRU, SRRIP, BRRIP, DRRIP)
     // WRITEBACK_POLICY (WB, WT)
+    // [MODEL (DATA, TIMING)]   optional, DATA if absent
+    // [key=value ...]          optional: prefetcher=NONE|NEXTLINE|STRIDE|STREAM, prefetchDegree=N,
+    //                          prefetchEntries=N, prefetchLatency=N, victimEntries=N,
+    //                          victimKind=VICTIM|MISS, victimPolicy=FIFO|LRU,
+    //                          writeBufferEntries=N, writeBufferDrain=N
     //
     // Returns true if successful, false otherwise
     bool loadFromFile(const std::string& filename);
+    // True if the fields describe a cache Cache::enable() can build: power-of-two sizes up to
+    // 1 MB, blocks up to 64 bytes, and an associativity (0 or a power of two up to 16) that
+    // fits in the number of blocks. Configs built in code (e.g. a sweep grid) check this.
+    bool isValid() const;
     int getOffsetBits() const ;
 
     int getIndexBits() const ;
@@ -58,7 +96,12 @@ private:
 
 // Declarations only
 std::string replacementPolicyToString(ReplacementPolicy policy);
+// The policy named by name (as in a config file); false if there is none
+bool parseReplacementPolicy(const std::string& name, ReplacementPolicy& policy);
 std::string writePolicyToString(WritePolicy policy);
+std::string cacheModelToString(CacheModel model);
+std::string prefetcherToString(PrefetcherKind kind);
+std::string victimKindToString(VictimKind kind);
 std::ostream& operator<<(std::ostream& os, const CacheConfig& config);
 
 
@@ -0,0 +1,275 @@
+/**
+ * @file CachePrefetcher.cpp
+ * @brief Next-N-line, PC-indexed stride and stream buffer prefetchers.
+ */
+#include "CachePrefetcher.h"
+
+#include <algorithm>
+
+namespace
+{
+    class NextLinePrefetcher : public CachePrefetcher
+    {
+    public:
+        NextLinePrefetcher(uint32_t blockSize, int degree) : CachePrefetcher(blockSize), degree(degree)
+        {
+        }
+        const char *getName() const override
+        {
+            return "NEXTLINE";
+        }
+        void observe(uint64_t address, uint64_t, bool miss, bool firstUse, uint64_t,
+                     std::vector<uint64_t> &prefetches) override
+        {
+            if (!miss && !firstUse)
+                return;
+            uint64_t block = address & blockMask;
+            uint64_t blockSize = ~blockMask + 1;
+            for (int i = 1; i <= degree; ++i)
+                prefetches.push_back(block + i * blockSize);
+        }
+        void reset() override
+        {
+        }
+        void saveState(CheckpointWriter &) const override
+        {
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            return reader.isGood();
+        }
+
+    private:
+        int degree;
+    };
+
+    class StridePrefetcher : public CachePrefetcher
+    {
+    public:
+        StridePrefetcher(uint32_t blockSize, int entries, int degree)
+            : CachePrefetcher(blockSize), degree(degree), table(entries)
+        {
+        }
+        const char *getName() const override
+        {
+            return "STRIDE";
+        }
+        void observe(uint64_t address, uint64_t pc, bool, bool, uint64_t,
+                     std::vector<uint64_t> &prefetches) override
+        {
+            Entry &entry = table[(pc >> 2) % table.size()];
+            if (!entry.valid || entry.pc != pc)
+            {
+                entry = Entry();
+                entry.valid = true;
+                entry.pc = pc;
+                entry.lastAddress = address;
+                return;
+            }
+            int64_t stride = static_cast<int64_t>(address - entry.lastAddress);
+            entry.lastAddress = address;
+            if (stride != 0 && stride == entry.stride)
+            {
+                entry.confidence = std::min(entry.confidence + 1, MAX_CONFIDENCE);
+            }
+            else
+            {
+                // a broken pattern costs confidence first; a weak entry learns the new stride,
+                // which counts as seen once
+                if (entry.confidence > 0)
+                {
+                    --entry.confidence;
+                }
+                else
+                {
+                    entry.stride = stride;
+                    entry.confidence = 1;
+                }
+                return;
+            }
+            if (entry.confidence < PREDICT_CONFIDENCE)
+                return;
+            uint64_t lastBlock = address & blockMask;
+            for (int i = 1; i <= degree; ++i)
+            {
+                // strides under a block would name the same block several times
+                uint64_t block = (address + i * stride) & blockMask;
+                if (block != lastBlock)
+                    prefetches.push_back(block);
+                lastBlock = block;
+            }
+        }
+        void reset() override
+        {
+            std::fill(table.begin(), table.end(), Entry());
+        }
+        void saveState(CheckpointWriter &writer) const override
+        {
+            for (const Entry &entry : table)
+            {
+                writer.writeBool(entry.valid);
+                writer.writeU64(entry.pc);
+                writer.writeU64(entry.lastAddress);
+                writer.writeU64(static_cast<uint64_t>(entry.stride));
+                writer.writeI32(entry.confidence);
+            }
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            for (Entry &entry : table)
+            {
+                entry.valid = reader.readBool();
+                entry.pc = reader.readU64();
+                entry.lastAddress = reader.readU64();
+                entry.stride = static_cast<int64_t>(reader.readU64());
+                entry.confidence = reader.readI32();
+            }
+            return reader.isGood();
+        }
+
+    private:
+        static constexpr int MAX_CONFIDENCE = 3;
+        static constexpr int PREDICT_CONFIDENCE = 2;
+
+        struct Entry
+        {
+            bool valid = false;
+            uint64_t pc = 0;
+            uint64_t lastAddress = 0;
+            int64_t stride = 0;
+            int confidence = 0;
+        };
+        int degree;
+        std::vector<Entry> table;
+    };
+
+    class StreamBufferPrefetcher : public CachePrefetcher
+    {
+    public:
+        StreamBufferPrefetcher(uint32_t blockSize, int bufferCount, int depth)
+            : CachePrefetcher(blockSize), depth(depth), buffers(bufferCount)
+        {
+        }
+        const char *getName() const override
+        {
+            return "STREAM";
+        }
+        void observe(uint64_t address, uint64_t, bool miss, bool, uint64_t now,
+                     std::vector<uint64_t> &) override
+        {
+            if (!miss)
+                return;
+            // a miss no buffer could serve starts a new stream in the least recently used one
+            Buffer &buffer = *std::min_element(buffers.begin(), buffers.end(),
+                                               [](const Buffer &a, const Buffer &b)
+                                               { return a.lastUsed < b.lastUsed; });
+            buffer.blocks.clear();
+            buffer.issuedAt.clear();
+            buffer.nextBlock = address & blockMask;
+            buffer.lastUsed = now;
+            for (int i = 0; i < depth; ++i)
+                fetch(buffer, now);
+        }
+        bool claim(uint64_t blockAddress, uint64_t now, uint64_t &issuedAt) override
+        {
+            for (Buffer &buffer : buffers)
+            {
+                if (buffer.blocks.empty() || buffer.blocks.front() != blockAddress)
+                    continue;
+                issuedAt = buffer.issuedAt.front();
+                buffer.blocks.erase(buffer.blocks.begin());
+                buffer.issuedAt.erase(buffer.issuedAt.begin());
+                buffer.lastUsed = now;
+                fetch(buffer, now);
+                return true;
+            }
+            return false;
+        }
+        uint64_t takeBufferedIssues() override
+        {
+            uint64_t count = issued;
+            issued = 0;
+            return count;
+        }
+        void reset() override
+        {
+            std::fill(buffers.begin(), buffers.end(), Buffer());
+            issued = 0;
+        }
+        void saveState(CheckpointWriter &writer) const override
+        {
+            writer.writeU64(issued);
+            for (const Buffer &buffer : buffers)
+            {
+                writer.writeU64(buffer.nextBlock);
+                writer.writeU64(buffer.lastUsed);
+                writer.writeU32(static_cast<uint32_t>(buffer.blocks.size()));
+                for (size_t i = 0; i < buffer.blocks.size(); ++i)
+                {
+                    writer.writeU64(buffer.blocks[i]);
+                    writer.writeU64(buffer.issuedAt[i]);
+                }
+            }
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            issued = reader.readU64();
+            for (Buffer &buffer : buffers)
+            {
+                buffer.nextBlock = reader.readU64();
+                buffer.lastUsed = reader.readU64();
+                uint32_t count = reader.readU32();
+                if (!reader.isGood() || count > static_cast<uint32_t>(depth))
+                    return false;
+                buffer.blocks.resize(count);
+                buffer.issuedAt.resize(count);
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    buffer.blocks[i] = reader.readU64();
+                    buffer.issuedAt[i] = reader.readU64();
+                }
+            }
+            return reader.isGood();
+        }
+
+    private:
+        struct Buffer
+        {
+            std::vector<uint64_t> blocks;   // FIFO, head first (at most depth entries)
+            std::vector<uint64_t> issuedAt; // access count each block was fetched at
+            uint64_t nextBlock = 0;         // last block of the stream fetched so far
+            uint64_t lastUsed = 0;
+        };
+        void fetch(Buffer &buffer, uint64_t now)
+        {
+            buffer.nextBlock += ~blockMask + 1;
+            buffer.blocks.push_back(buffer.nextBlock);
+            buffer.issuedAt.push_back(now);
+            ++issued;
+        }
+        int depth;
+        std::vector<Buffer> buffers;
+        uint64_t issued = 0;
+    };
+}
+
+std::unique_ptr<CachePrefetcher> CachePrefetcher::create(const CacheConfig &config)
+{
+    // 0 in the config: the prefetcher's usual size
+    auto orDefault = [](int value, int fallback)
+    { return value > 0 ? value : fallback; };
+    switch (config.prefetcher)
+    {
+    case PrefetcherKind::NEXTLINE:
+        return std::make_unique<NextLinePrefetcher>(config.blockSize, orDefault(config.prefetchDegree, 1));
+    case PrefetcherKind::STRIDE:
+        return std::make_unique<StridePrefetcher>(config.blockSize, orDefault(config.prefetchEntries, 64),
+                                                  orDefault(config.prefetchDegree, 2));
+    case PrefetcherKind::STREAM:
+        return std::make_unique<StreamBufferPrefetcher>(config.blockSize, orDefault(config.prefetchEntries, 4),
+                                                        orDefault(config.prefetchDegree, 4));
+    case PrefetcherKind::NONE:
+    default:
+        return nullptr;
+    }
+}
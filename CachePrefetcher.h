@@ -0,0 +1,78 @@
+/**
+ * @class CachePrefetcher
+ * @brief Hardware prefetcher model attached to a Cache.
+ *
+ * Cache reports every demand access to observe(), which appends the blocks to prefetch; Cache
+ * loads those that are not already cached into the cache as prefetched lines. create() builds
+ * the prefetcher a CacheConfig names:
+ *
+ *   NEXTLINE  Next-N-line, tagged: a miss, or the first demand hit on a prefetched line,
+ *             prefetches the next prefetchDegree blocks.
+ *   STRIDE    PC-indexed reference prediction table of prefetchEntries entries. Each entry
+ *             tracks the last address and stride of one load/store PC with a 2-bit confidence
+ *             (a newly learned stride starts at 1, a repeat adds 1, a different stride takes 1
+ *             off); from confidence 2, i.e. once the same stride is seen twice in a row (the
+ *             third access), prefetchDegree strides ahead are prefetched on every access by
+ *             that PC.
+ *   STREAM    prefetchEntries stream buffers (Jouppi), each a FIFO of prefetchDegree blocks
+ *             held outside the cache. A miss that matches a buffer's head is served from it
+ *             (claim()) and the buffer fetches one more block; any other miss reallocates the
+ *             least recently used buffer to the blocks following the miss.
+ *
+ * Buffers hold block addresses only: data comes from Memory when a claimed block is filled,
+ * so a buffer can never return stale bytes. Issue times are access counts, which Cache uses
+ * for timeliness.
+ */
+#ifndef CACHE_PREFETCHER_H
+#define CACHE_PREFETCHER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CacheConfig.h"
+#include "Checkpoint.h"
+
+class CachePrefetcher
+{
+public:
+    virtual ~CachePrefetcher() = default;
+
+    // the prefetcher for config's prefetcher field; nullptr for NONE
+    static std::unique_ptr<CachePrefetcher> create(const CacheConfig &config);
+
+    virtual const char *getName() const = 0;
+
+    // A demand access at access count now. miss: it missed the cache (and no stream buffer
+    // served it); firstUse: it hit a prefetched line for the first time. Appends the block
+    // addresses to load into the cache to prefetches.
+    virtual void observe(uint64_t address, uint64_t pc, bool miss, bool firstUse, uint64_t now,
+                         std::vector<uint64_t> &prefetches) = 0;
+
+    // Stream buffers: if blockAddress is at the head of a buffer, removes it, stores when it was
+    // fetched in issuedAt and returns true. Other prefetchers hold nothing outside the cache.
+    virtual bool claim(uint64_t blockAddress, uint64_t now, uint64_t &issuedAt)
+    {
+        (void)blockAddress;
+        (void)now;
+        (void)issuedAt;
+        return false;
+    }
+    // blocks fetched into the prefetcher's own buffers since the last call
+    virtual uint64_t takeBufferedIssues()
+    {
+        return 0;
+    }
+
+    // forget all history (the cache was invalidated)
+    virtual void reset() = 0;
+    virtual void saveState(CheckpointWriter &writer) const = 0;
+    virtual bool loadState(CheckpointReader &reader) = 0;
+
+protected:
+    explicit CachePrefetcher(uint32_t blockSize) : blockMask(~static_cast<uint64_t>(blockSize - 1))
+    {
+    }
+    uint64_t blockMask; // address & blockMask: the address of its block
+};
+
+#endif // CACHE_PREFETCHER_H
@@ -0,0 +1,330 @@
+/**
+ * @file CacheReplacement.cpp
+ * @brief LRU, FIFO, RANDOM, tree-PLRU, NRU and RRIP (SRRIP/BRRIP/DRRIP) replacement state.
+ */
+#include "CacheReplacement.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Oldest lastUsed (LRU) or insertionTime (FIFO) stamp; the first such way on a tie
+    class StampReplacement : public CacheReplacement
+    {
+    public:
+        StampReplacement(int ways, bool byInsertion) : ways(ways), byInsertion(byInsertion)
+        {
+        }
+        const char *getName() const override
+        {
+            return byInsertion ? "FIFO" : "LRU";
+        }
+        int victim(uint32_t, const uint64_t *lastUsed, const uint64_t *insertionTime) override
+        {
+            const uint64_t *stamps = byInsertion ? insertionTime : lastUsed;
+            int oldest = 0;
+            uint64_t oldestStamp = stamps[0];
+            for (int way = 1; way < ways; ++way)
+            {
+                if (stamps[way] < oldestStamp)
+                {
+                    oldestStamp = stamps[way];
+                    oldest = way;
+                }
+            }
+            return oldest;
+        }
+
+    private:
+        int ways;
+        bool byInsertion;
+    };
+
+    class RandomReplacement : public CacheReplacement
+    {
+    public:
+        RandomReplacement(int ways, uint32_t seed)
+            : ways(ways), seed(seed ? seed : std::minstd_rand::default_seed), engine(this->seed)
+        {
+        }
+        const char *getName() const override
+        {
+            return "RANDOM";
+        }
+        int victim(uint32_t, const uint64_t *, const uint64_t *) override
+        {
+            return std::uniform_int_distribution<int>(0, ways - 1)(engine);
+        }
+        void reset() override
+        {
+            engine.seed(seed);
+        }
+        // the engine's state in its standard text form
+        void saveState(CheckpointWriter &writer) const override
+        {
+            std::ostringstream state;
+            state << engine;
+            writer.writeString(state.str());
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            std::istringstream state(reader.readString());
+            state >> engine;
+            return reader.isGood() && !state.fail();
+        }
+
+    private:
+        int ways;
+        uint32_t seed;
+        std::minstd_rand engine;
+    };
+
+    // Binary tree over the ways rounded up to a power of two, in heap order (node 1 is the
+    // root, node n has children 2n and 2n + 1, leaf leaves + w is way w). bits[n] == 1 means
+    // "evict from the right subtree".
+    class TreePlruReplacement : public CacheReplacement
+    {
+    public:
+        TreePlruReplacement(int numSets, int ways) : ways(ways)
+        {
+            while (leaves < ways)
+                leaves *= 2;
+            bits.assign(static_cast<size_t>(numSets) * leaves, 0);
+        }
+        const char *getName() const override
+        {
+            return "PLRU";
+        }
+        void touch(uint32_t set, int way) override
+        {
+            uint8_t *tree = bits.data() + static_cast<size_t>(set) * leaves;
+            for (int node = leaves + way; node > 1; node /= 2)
+                tree[node / 2] = (node % 2 == 0); // point to the sibling of the accessed side
+        }
+        void insert(uint32_t set, int way) override
+        {
+            touch(set, way);
+        }
+        int victim(uint32_t set, const uint64_t *, const uint64_t *) override
+        {
+            const uint8_t *tree = bits.data() + static_cast<size_t>(set) * leaves;
+            int node = 1;
+            for (int span = leaves / 2; span >= 1; span /= 2)
+            {
+                int child = 2 * node + tree[node];
+                // ways past the set size exist only to round the tree up: never pick them
+                if (child % 2 == 1 && (child * span) - leaves >= ways)
+                    child = 2 * node;
+                node = child;
+            }
+            return node - leaves;
+        }
+        void reset() override
+        {
+            std::fill(bits.begin(), bits.end(), 0);
+        }
+        void saveState(CheckpointWriter &writer) const override
+        {
+            writer.writeBytes(bits.data(), bits.size());
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            reader.readBytes(bits.data(), bits.size());
+            return reader.isGood();
+        }
+
+    private:
+        int ways;
+        int leaves = 1;
+        std::vector<uint8_t> bits; // leaves bytes per set, index 0 unused
+    };
+
+    class NruReplacement : public CacheReplacement
+    {
+    public:
+        NruReplacement(int numSets, int ways)
+            : ways(ways), used(static_cast<size_t>(numSets) * ways, 0), usedCount(numSets, 0)
+        {
+        }
+        const char *getName() const override
+        {
+            return "NRU";
+        }
+        void touch(uint32_t set, int way) override
+        {
+            uint8_t *bits = used.data() + static_cast<size_t>(set) * ways;
+            if (bits[way])
+                return;
+            bits[way] = 1;
+            if (++usedCount[set] == static_cast<uint32_t>(ways) && ways > 1)
+            {
+                // every way recently used: start a new epoch with only this one
+                std::memset(bits, 0, ways);
+                bits[way] = 1;
+                usedCount[set] = 1;
+            }
+        }
+        void insert(uint32_t set, int way) override
+        {
+            touch(set, way);
+        }
+        int victim(uint32_t set, const uint64_t *, const uint64_t *) override
+        {
+            const uint8_t *bits = used.data() + static_cast<size_t>(set) * ways;
+            const void *unused = std::memchr(bits, 0, ways);
+            return unused ? static_cast<int>(static_cast<const uint8_t *>(unused) - bits) : 0;
+        }
+        void reset() override
+        {
+            std::fill(used.begin(), used.end(), 0);
+            std::fill(usedCount.begin(), usedCount.end(), 0);
+        }
+        void saveState(CheckpointWriter &writer) const override
+        {
+            writer.writeBytes(used.data(), used.size());
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            reader.readBytes(used.data(), used.size());
+            for (size_t set = 0; set < usedCount.size(); ++set)
+                usedCount[set] = static_cast<uint32_t>(
+                    std::count(used.begin() + set * ways, used.begin() + (set + 1) * ways, 1));
+            return reader.isGood();
+        }
+
+    private:
+        int ways;
+        std::vector<uint8_t> used;        // MRU bit per way
+        std::vector<uint32_t> usedCount;  // MRU bits set, per set
+    };
+
+    class RripReplacement : public CacheReplacement
+    {
+    public:
+        enum class Insertion { STATIC, BIMODAL, DUELING };
+
+        RripReplacement(int numSets, int ways, Insertion insertion)
+            : ways(ways), insertion(insertion), rrpv(static_cast<size_t>(numSets) * ways, MAX_RRPV)
+        {
+            // DUELING: one SRRIP and one BRRIP leader per constituency of `stride` sets,
+            // up to 32 of each; a single set has no leaders and stays SRRIP
+            if (insertion == Insertion::DUELING && numSets >= 2)
+                stride = std::max(2, numSets / std::min(32, std::max(1, numSets / 8)));
+        }
+        const char *getName() const override
+        {
+            switch (insertion)
+            {
+            case Insertion::STATIC:
+                return "SRRIP";
+            case Insertion::BIMODAL:
+                return "BRRIP";
+            default:
+                return "DRRIP";
+            }
+        }
+        void touch(uint32_t set, int way) override
+        {
+            rrpv[static_cast<size_t>(set) * ways + way] = 0;
+        }
+        void insert(uint32_t set, int way) override
+        {
+            bool bimodal = insertion == Insertion::BIMODAL;
+            if (insertion == Insertion::DUELING)
+            {
+                // a fill is a miss: the leader group that misses more pushes PSEL away from it
+                uint32_t member = stride ? set % stride : 1;
+                if (member == 0)
+                {
+                    psel = std::min(PSEL_MAX, psel + 1);
+                    bimodal = false;
+                }
+                else if (member == static_cast<uint32_t>(stride / 2))
+                {
+                    psel = std::max(0, psel - 1);
+                    bimodal = true;
+                }
+                else
+                {
+                    bimodal = psel > PSEL_MAX / 2;
+                }
+            }
+            uint8_t value = MAX_RRPV - 1;
+            if (bimodal && ++fills % BIMODAL_PERIOD != 0)
+                value = MAX_RRPV;
+            rrpv[static_cast<size_t>(set) * ways + way] = value;
+        }
+        int victim(uint32_t set, const uint64_t *, const uint64_t *) override
+        {
+            uint8_t *values = rrpv.data() + static_cast<size_t>(set) * ways;
+            uint8_t oldest = *std::max_element(values, values + ways);
+            if (oldest < MAX_RRPV)
+            {
+                // age the whole set until some way predicts a distant re-reference
+                for (int way = 0; way < ways; ++way)
+                    values[way] += MAX_RRPV - oldest;
+            }
+            return static_cast<int>(static_cast<const uint8_t *>(std::memchr(values, MAX_RRPV, ways)) - values);
+        }
+        void reset() override
+        {
+            std::fill(rrpv.begin(), rrpv.end(), MAX_RRPV);
+            psel = PSEL_MAX / 2;
+            fills = 0;
+        }
+        void saveState(CheckpointWriter &writer) const override
+        {
+            writer.writeBytes(rrpv.data(), rrpv.size());
+            writer.writeI32(psel);
+            writer.writeU64(fills);
+        }
+        bool loadState(CheckpointReader &reader) override
+        {
+            reader.readBytes(rrpv.data(), rrpv.size());
+            psel = reader.readI32();
+            fills = reader.readU64();
+            return reader.isGood() && psel >= 0 && psel <= PSEL_MAX;
+        }
+
+    private:
+        static constexpr uint8_t MAX_RRPV = 3;      // 2-bit RRPV
+        static constexpr int PSEL_MAX = 1023;       // 10-bit selector
+        static constexpr uint64_t BIMODAL_PERIOD = 32;
+
+        int ways;
+        Insertion insertion;
+        std::vector<uint8_t> rrpv;
+        int stride = 0;                // DRRIP constituency size; 0 = no leader sets
+        int psel = PSEL_MAX / 2;       // > PSEL_MAX / 2: followers insert like BRRIP
+        uint64_t fills = 0;            // bimodal fills so far
+    };
+}
+
+std::unique_ptr<CacheReplacement> CacheReplacement::create(const CacheConfig &config, int numSets, int ways,
+                                                           uint32_t seed)
+{
+    switch (config.replacementPolicy)
+    {
+    case ReplacementPolicy::FIFO:
+        return std::make_unique<StampReplacement>(ways, true);
+    case ReplacementPolicy::RANDOM:
+        return std::make_unique<RandomReplacement>(ways, seed);
+    case ReplacementPolicy::PLRU:
+        return std::make_unique<TreePlruReplacement>(numSets, ways);
+    case ReplacementPolicy::NRU:
+        return std::make_unique<NruReplacement>(numSets, ways);
+    case ReplacementPolicy::SRRIP:
+        return std::make_unique<RripReplacement>(numSets, ways, RripReplacement::Insertion::STATIC);
+    case ReplacementPolicy::BRRIP:
+        return std::make_unique<RripReplacement>(numSets, ways, RripReplacement::Insertion::BIMODAL);
+    case ReplacementPolicy::DRRIP:
+        return std::make_unique<RripReplacement>(numSets, ways, RripReplacement::Insertion::DUELING);
+    case ReplacementPolicy::LRU:
+    default:
+        return std::make_unique<StampReplacement>(ways, false);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @class CacheReplacement
+ * @brief Replacement state of a Cache: which way of a set to evict next.
+ *
+ * Cache tells the policy about every hit (touch) and fill (insert) and asks it for a victim
+ * when a set has no invalid way. create() builds the policy a CacheConfig names:
+ *
+ *   LRU, FIFO  Evict the way with the oldest Cache::lastUsed / insertionTime stamp (the first
+ *              one on a tie). These stamps are printed in dumps, so Cache keeps them for every
+ *              policy and passes a set's stamps to victim().
+ *   RANDOM     A uniformly drawn way from the policy's own std::minstd_rand, seeded with the
+ *              Cache's random seed: no shared state, so caches on different threads do not
+ *              race and every run with the same seed evicts the same ways.
+ *   PLRU       Tree pseudo-LRU: ways - 1 bits per set, each pointing to the half of its subtree
+ *              to evict from; an access flips the bits on its path to point away from it.
+ *   NRU        Bit-PLRU / not-recently-used: one MRU bit per way, set on access (all but the
+ *              accessed one cleared once every bit is set); evicts the first way with a 0 bit.
+ *   SRRIP      2-bit re-reference prediction values: hits set 0, fills insert at 2, the victim
+ *              is the first way at 3 (every way of the set is aged until one is).
+ *   BRRIP      SRRIP that inserts at 3, and at 2 only on every 32nd fill.
+ *   DRRIP      Set dueling between SRRIP and BRRIP: a few leader sets always use one of them,
+ *              their fills (i.e. misses) move a 10-bit selector, and the other sets follow
+ *              whichever leader group misses less.
+ *
+ * All state is a few bits per way in flat arrays, set-major like Cache's tag store. BRRIP's
+ * 1-in-32 choice is a counter rather than a random draw, so runs are reproducible.
+ */
+#ifndef CACHE_REPLACEMENT_H
+#define CACHE_REPLACEMENT_H
+
+#include <cstdint>
+#include <memory>
+#include "CacheConfig.h"
+#include "Checkpoint.h"
+
+class CacheReplacement
+{
+public:
+    virtual ~CacheReplacement() = default;
+
+    // the policy for config's replacementPolicy over numSets sets of ways ways each; seed
+    // seeds RANDOM's generator (0: the generator's default seed)
+    static std::unique_ptr<CacheReplacement> create(const CacheConfig &config, int numSets, int ways,
+                                                    uint32_t seed = 0);
+
+    // name used in the access log ("LRU", "PLRU", ...)
+    virtual const char *getName() const = 0;
+    // a hit on way of set
+    virtual void touch(uint32_t set, int way)
+    {
+        (void)set;
+        (void)way;
+    }
+    // way of set was just filled on a miss
+    virtual void insert(uint32_t set, int way)
+    {
+        (void)set;
+        (void)way;
+    }
+    // the way to evict from a full set; lastUsed and insertionTime point at the set's stamps
+    virtual int victim(uint32_t set, const uint64_t *lastUsed, const uint64_t *insertionTime) = 0;
+    // forget all history (the cache was invalidated)
+    virtual void reset()
+    {
+    }
+
+    // checkpoint: the policy's own state (the stamps are saved by Cache)
+    virtual void saveState(CheckpointWriter &writer) const
+    {
+        (void)writer;
+    }
+    virtual bool loadState(CheckpointReader &reader)
+    {
+        return reader.isGood();
+    }
+};
+
+#endif // CACHE_REPLACEMENT_H
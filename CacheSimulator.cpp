@@ -19,7 +19,10 @@ bool CacheSimulator::enable(const std::string& configFile, Memory& mem) {
         std::cerr << "Failed to load cache configuration.\n";
         return false;
     }
-    
+    return enable(cfg, mem);
+}
+
+bool CacheSimulator::enable(const CacheConfig& cfg, Memory& mem) {
     config = cfg;
     cache.enable(config, mem);
     enabled = true;
@@ -27,6 +30,16 @@ bool CacheSimulator::enable(const std::string& configFile, Memory& mem) {
     return true;
 }
 
+void CacheSimulator::writeBack() {
+    if (!enabled) return;
+    cache.writeBackDirtyBlocks();
+}
+
+void CacheSimulator::drainWriteBuffer() {
+    if (!enabled) return;
+    cache.drainWriteBuffer();
+}
+
 
 void CacheSimulator::disable() {
     enabled = false;
@@ -62,15 +75,15 @@ void CacheSimulator::setProgramName(const std::string& programName) {
 }
 
 
-uint32_t CacheSimulator::read(uint32_t address, MemSize size, bool isUnsigned) {
+int64_t CacheSimulator::read(uint64_t address, MemSize size, bool isUnsigned, uint64_t pc) {
     if (!enabled ) return address;
-    return cache.read(static_cast<uint64_t>(address), size, isUnsigned);
+    return cache.read(address, size, isUnsigned, pc);
     
 }
 
-void CacheSimulator::write(uint32_t address, MemSize size, uint32_t value) {
+void CacheSimulator::write(uint64_t address, MemSize size, uint64_t value, uint64_t pc) {
       if (!enabled ) return;
-    cache.write(static_cast<uint64_t>(address), size, value);
+    cache.write(address, size, value, pc);
     
     
 }
@@ -116,3 +129,53 @@ void CacheSimulator::printStats(std::ostream& out) const {
     out << "Program: " << currentProgramName << "\n";
     cache.printStats(out);
 }
+
+void CacheSimulator::saveState(CheckpointWriter& writer) const {
+    writer.writeBool(enabled);
+    if (!enabled) return;
+    writer.writeI32(config.cacheSize);
+    writer.writeI32(config.blockSize);
+    writer.writeI32(config.associativity);
+    writer.writeU8(static_cast<uint8_t>(config.replacementPolicy));
+    writer.writeU8(static_cast<uint8_t>(config.writePolicy));
+    writer.writeU8(static_cast<uint8_t>(config.model));
+    writer.writeU8(static_cast<uint8_t>(config.prefetcher));
+    writer.writeI32(config.prefetchDegree);
+    writer.writeI32(config.prefetchEntries);
+    writer.writeI32(config.prefetchLatency);
+    writer.writeI32(config.victimEntries);
+    writer.writeU8(static_cast<uint8_t>(config.victimKind));
+    writer.writeU8(static_cast<uint8_t>(config.victimPolicy));
+    writer.writeI32(config.writeBufferEntries);
+    writer.writeI32(config.writeBufferDrain);
+    cache.saveState(writer);
+}
+
+bool CacheSimulator::loadState(CheckpointReader& reader, Memory& mem) {
+    if (!reader.readBool()) {
+        disable();
+        return reader.isGood();
+    }
+    CacheConfig cfg;
+    cfg.cacheSize = reader.readI32();
+    cfg.blockSize = reader.readI32();
+    cfg.associativity = reader.readI32();
+    cfg.replacementPolicy = static_cast<ReplacementPolicy>(reader.readU8());
+    cfg.writePolicy = static_cast<WritePolicy>(reader.readU8());
+    cfg.model = static_cast<CacheModel>(reader.readU8());
+    cfg.prefetcher = static_cast<PrefetcherKind>(reader.readU8());
+    cfg.prefetchDegree = reader.readI32();
+    cfg.prefetchEntries = reader.readI32();
+    cfg.prefetchLatency = reader.readI32();
+    cfg.victimEntries = reader.readI32();
+    cfg.victimKind = static_cast<VictimKind>(reader.readU8());
+    cfg.victimPolicy = static_cast<ReplacementPolicy>(reader.readU8());
+    cfg.writeBufferEntries = reader.readI32();
+    cfg.writeBufferDrain = reader.readI32();
+    if (!reader.isGood() || cfg.blockSize <= 0 || cfg.cacheSize < cfg.blockSize || cfg.associativity < 0 ||
+        cfg.victimEntries < 0 || cfg.writeBufferEntries < 0 || cfg.writeBufferDrain < 0) {
+        return false;
+    }
+    enable(cfg, mem);
+    return cache.loadState(reader);
+}
@@ -32,19 +32,25 @@ public:
     CacheSimulator():enabled(false){};
     //Loads config, creates cache instance
     bool enable(const std::string& configFile, Memory& mem);
+    // Same with a config that is already loaded; the cache starts empty
+    bool enable(const CacheConfig& cfg, Memory& mem);
     // Disables simulation, cleans up
     void disable();
     //set current app name for logs/stats
     void setProgramName(const std::string& programName);
 
     // Read returns data
-    uint32_t read(uint32_t addr, MemSize size, bool isUnsigned);
+    int64_t read(uint64_t addr, MemSize size, bool isUnsigned, uint64_t pc = 0);
 
 
     // Write passes data
-    void write(uint32_t address, MemSize size, uint32_t value);
+    void write(uint64_t address, MemSize size, uint64_t value, uint64_t pc = 0);
     // Clears the entire cache
     void invalidate();
+    // Writes dirty blocks back to memory so memory is current (e.g. before accesses bypass the cache)
+    void writeBack();
+    // Writes the stores pending in the write buffer to memory (the program has finished)
+    void drainWriteBuffer();
     //Dumps current cache content to a file
     void dump(const std::string& filename) const;
 
@@ -62,7 +68,15 @@ public:
     // is simulation active?
     bool isEnabled() const { return enabled; }
 
-    // Set the seed for the random number generator (for testing)
+    // the simulated cache, for reading its statistics
+    const Cache& getCache() const { return cache; }
+
+    // checkpoint: enabled flag, config and cache contents. loadState() re-enables the cache
+    // with the saved config over mem (or disables it) before restoring the blocks.
+    void saveState(CheckpointWriter& writer) const;
+    bool loadState(CheckpointReader& reader, Memory& mem);
+
+    // Seed of the RANDOM replacement policy (takes effect at the next enable())
     void setRandomSeed(uint32_t seed) {
             cache.setRandomSeed(seed);
     }
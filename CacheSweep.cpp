@@ -0,0 +1,202 @@
+/**
+ * @file CacheSweep.cpp
+ * @brief Implementation of the parallel cache design-space sweep.
+ *
+ * Per configuration (on a pool thread): build a Memory and a tag-only (CacheModel::TIMING)
+ * Cache, run the shared trace through Cache::accessBatch() and record the statistics in the
+ * configuration's slot.
+ */
+#include "CacheSweep.h"
+#include "CacheTrace.h"
+#include "WorkStealingPool.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    bool parseNames(const std::string &values, std::vector<std::string> &out)
+    {
+        out.clear();
+        std::istringstream list(values);
+        std::string item;
+        while (std::getline(list, item, ','))
+        {
+            if (item.empty())
+                return false;
+            out.push_back(item);
+        }
+        return !out.empty();
+    }
+
+    double hitRate(const CacheSweepResult &r)
+    {
+        return r.accesses ? static_cast<double>(r.hits) / r.accesses : 0.0;
+    }
+}
+
+bool CacheSweepGrid::parseIntList(const std::string &values, std::vector<int> &out)
+{
+    std::vector<int> parsed;
+    std::istringstream list(values);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        try
+        {
+            size_t used = 0;
+            int value = std::stoi(item, &used);
+            if (used != item.size())
+                return false;
+            parsed.push_back(value);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+    }
+    if (parsed.empty())
+        return false;
+    out = parsed;
+    return true;
+}
+
+bool CacheSweepGrid::set(const std::string &option, const std::string &values)
+{
+    if (option == "--sizes")
+        return parseIntList(values, cacheSizes);
+    if (option == "--blocks")
+        return parseIntList(values, blockSizes);
+    if (option == "--assoc")
+        return parseIntList(values, associativities);
+
+    std::vector<std::string> names;
+    if (!parseNames(values, names))
+        return false;
+    if (option == "--repl")
+    {
+        std::vector<ReplacementPolicy> policies;
+        for (const auto &name : names)
+        {
+            ReplacementPolicy policy;
+            if (!parseReplacementPolicy(name, policy))
+                return false;
+            policies.push_back(policy);
+        }
+        replacementPolicies = policies;
+        return true;
+    }
+    if (option == "--write")
+    {
+        std::vector<WritePolicy> policies;
+        for (const auto &name : names)
+        {
+            if (name == "WB")
+                policies.push_back(WritePolicy::WB);
+            else if (name == "WT")
+                policies.push_back(WritePolicy::WT);
+            else
+                return false;
+        }
+        writePolicies = policies;
+        return true;
+    }
+    return false;
+}
+
+std::vector<CacheConfig> CacheSweepGrid::expand(size_t &skipped) const
+{
+    std::vector<CacheConfig> configs;
+    skipped = 0;
+    for (int size : cacheSizes)
+        for (int block : blockSizes)
+            for (int assoc : associativities)
+                for (ReplacementPolicy repl : replacementPolicies)
+                    for (WritePolicy write : writePolicies)
+                    {
+                        CacheConfig config;
+                        config.cacheSize = size;
+                        config.blockSize = block;
+                        config.associativity = assoc;
+                        config.replacementPolicy = repl;
+                        config.writePolicy = write;
+                        if (config.isValid())
+                            configs.push_back(config);
+                        else
+                            ++skipped;
+                    }
+    return configs;
+}
+
+CacheSweep::CacheSweep(int threads) : threads(WorkStealingPool(threads).getThreadCount())
+{
+}
+
+bool CacheSweep::loadTrace(const std::string &path, std::vector<CacheAccess> &accesses, std::string &error)
+{
+    CacheTraceReader reader;
+    accesses.clear();
+    if (!reader.open(path))
+    {
+        error = reader.getError();
+        return false;
+    }
+    std::vector<CacheAccess> batch;
+    while (reader.nextBatch(batch, 1 << 16) > 0)
+        accesses.insert(accesses.end(), batch.begin(), batch.end());
+    error = reader.getError();
+    return error.empty();
+}
+
+std::vector<CacheSweepResult> CacheSweep::run(const std::vector<CacheConfig> &configs,
+                                              const std::vector<CacheAccess> &trace) const
+{
+    std::vector<CacheSweepResult> results(configs.size());
+    WorkStealingPool pool(threads);
+    pool.parallelFor(configs.size(), [&](size_t i)
+                     {
+        std::ostream nullOut(nullptr);
+        Memory memory(nullOut);
+        // only the statistics are kept, so the cache need not hold data
+        CacheConfig config = configs[i];
+        config.model = CacheModel::TIMING;
+        Cache cache;
+        cache.enable(config, memory);
+        cache.accessBatch(trace);
+        CacheSweepResult &result = results[i];
+        result.config = configs[i];
+        result.accesses = cache.getAccesses();
+        result.hits = cache.getHits();
+        result.misses = cache.getMisses(); });
+    return results;
+}
+
+void CacheSweep::writeCsv(std::ostream &out, const std::vector<CacheSweepResult> &results)
+{
+    out << "cache_size,block_size,associativity,replacement_policy,write_policy,accesses,hits,misses,hit_rate\n";
+    for (const auto &r : results)
+    {
+        out << r.config.cacheSize << "," << r.config.blockSize << "," << r.config.associativity << ","
+            << replacementPolicyToString(r.config.replacementPolicy) << ","
+            << writePolicyToString(r.config.writePolicy) << "," << r.accesses << "," << r.hits << ","
+            << r.misses << "," << std::fixed << std::setprecision(6) << hitRate(r) << "\n";
+        out.unsetf(std::ios::floatfield);
+    }
+}
+
+void CacheSweep::writeJson(std::ostream &out, const std::vector<CacheSweepResult> &results)
+{
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const CacheSweepResult &r = results[i];
+        out << "  {\"cache_size\": " << r.config.cacheSize << ", \"block_size\": " << r.config.blockSize
+            << ", \"associativity\": " << r.config.associativity << ", \"replacement_policy\": \""
+            << replacementPolicyToString(r.config.replacementPolicy) << "\", \"write_policy\": \""
+            << writePolicyToString(r.config.writePolicy) << "\", \"accesses\": " << r.accesses
+            << ", \"hits\": " << r.hits << ", \"misses\": " << r.misses << ", \"hit_rate\": " << std::fixed
+            << std::setprecision(6) << hitRate(r) << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        out.unsetf(std::ios::floatfield);
+    }
+    out << "]\n";
+}
@@ -0,0 +1,79 @@
+/**
+ * @class CacheSweep
+ * @brief Simulates one address trace under every cache configuration of a grid, in parallel.
+ *
+ * The grid lists values per parameter (sizes, block sizes, associativities, replacement and
+ * write policies); every combination that CacheConfig::isValid() accepts becomes one
+ * configuration. The trace is loaded into memory once and shared read-only by all threads.
+ * Each configuration gets its own Cache and Memory on a WorkStealingPool thread and runs the
+ * whole trace through Cache::accessBatch().
+ *
+ * Results are stored in grid order and contain no timing, so the table is the same for any
+ * thread count. Each Cache seeds its own RANDOM generator, so that policy is reproducible too.
+ * writeCsv()/writeJson() produce the table CachesimulatorGUI.py loads.
+ */
+#ifndef CACHE_SWEEP_H
+#define CACHE_SWEEP_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Cache.h"
+#include "CacheConfig.h"
+
+struct CacheSweepGrid
+{
+    std::vector<int> cacheSizes = {1024, 2048, 4096, 8192, 16384, 32768, 65536};
+    std::vector<int> blockSizes = {16, 32, 64};
+    std::vector<int> associativities = {1, 2, 4, 8, 16};
+    std::vector<ReplacementPolicy> replacementPolicies = {ReplacementPolicy::FIFO, ReplacementPolicy::LRU,
+                                                          ReplacementPolicy::RANDOM};
+    std::vector<WritePolicy> writePolicies = {WritePolicy::WB, WritePolicy::WT};
+
+    // Replaces one parameter from a comma-separated list, e.g. ("--sizes", "4096,8192") or
+    // ("--repl", "LRU,FIFO"). Returns false for an unknown option or a bad value.
+    bool set(const std::string &option, const std::string &values);
+    // Parses a comma-separated list of integers, e.g. "16,32,64"; out is unchanged on failure
+    static bool parseIntList(const std::string &values, std::vector<int> &out);
+
+    // Every valid combination, sizes varying slowest and write policies fastest;
+    // skipped counts the invalid ones
+    std::vector<CacheConfig> expand(size_t &skipped) const;
+};
+
+struct CacheSweepResult
+{
+    CacheConfig config;
+    uint64_t accesses = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+class CacheSweep
+{
+public:
+    // threads <= 0: one per host core
+    explicit CacheSweep(int threads = 0);
+
+    // Reads a whole trace (binary or din, see CacheTraceReader) into accesses; on failure
+    // error says why
+    static bool loadTrace(const std::string &path, std::vector<CacheAccess> &accesses, std::string &error);
+
+    // Simulates trace under every config; result i belongs to configs[i]
+    std::vector<CacheSweepResult> run(const std::vector<CacheConfig> &configs,
+                                      const std::vector<CacheAccess> &trace) const;
+
+    static void writeCsv(std::ostream &out, const std::vector<CacheSweepResult> &results);
+    static void writeJson(std::ostream &out, const std::vector<CacheSweepResult> &results);
+
+    int getThreadCount() const
+    {
+        return threads;
+    }
+
+private:
+    int threads;
+};
+
+#endif // CACHE_SWEEP_H
@@ -0,0 +1,121 @@
+/**
+ * @file CacheTrace.cpp
+ * @brief Binary and Dinero din address trace decoding for the standalone cache simulator.
+ */
+#include "CacheTrace.h"
+
+#include <cstring>
+#include <sstream>
+
+bool CacheTraceReader::open(const std::string &path)
+{
+    textFile.close();
+    textFile.clear();
+    lineNumber = 0;
+    skipped = 0;
+    error.clear();
+
+    char magic[8] = {0};
+    {
+        std::ifstream probe(path, std::ios::binary);
+        if (!probe)
+        {
+            error = "cannot open " + path;
+            return false;
+        }
+        probe.read(magic, sizeof(magic));
+    }
+    binary = std::memcmp(magic, "RVTRACE", 8) == 0;
+    if (binary)
+    {
+        if (!binaryReader.open(path))
+        {
+            error = binaryReader.getError();
+            return false;
+        }
+        return true;
+    }
+    textFile.open(path);
+    if (!textFile)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    return true;
+}
+
+size_t CacheTraceReader::nextBatch(std::vector<CacheAccess> &batch, size_t maxCount)
+{
+    batch.clear();
+    if (!error.empty())
+        return 0;
+    if (binary)
+    {
+        TraceRecord record;
+        while (batch.size() < maxCount && binaryReader.next(record))
+        {
+            if (record.accessesMemory)
+                batch.push_back({record.address, record.size, record.isStore, record.pc});
+        }
+        return batch.size();
+    }
+    std::string line;
+    CacheAccess access;
+    while (batch.size() < maxCount && std::getline(textFile, line))
+    {
+        ++lineNumber;
+        if (parseDinLine(line, access))
+            batch.push_back(access);
+        else if (!error.empty())
+            return 0;
+    }
+    return batch.size();
+}
+
+bool CacheTraceReader::parseDinLine(const std::string &line, CacheAccess &access)
+{
+    std::istringstream fields(line);
+    std::string label;
+    std::string address;
+    if (!(fields >> label) || label[0] == '#')
+        return false;
+    if (label != "0" && label != "1")
+    {
+        if (label == "2" || label == "3" || label == "4")
+        {
+            ++skipped;
+            return false;
+        }
+        error = "line " + std::to_string(lineNumber) + ": unknown label '" + label + "'";
+        return false;
+    }
+    unsigned size = 4;
+    if (!(fields >> address))
+    {
+        error = "line " + std::to_string(lineNumber) + ": missing address";
+        return false;
+    }
+    unsigned given = 0;
+    if (fields >> given)
+        size = given;
+    if (size != 1 && size != 2 && size != 4 && size != 8)
+    {
+        error = "line " + std::to_string(lineNumber) + ": access size must be 1, 2, 4 or 8";
+        return false;
+    }
+    try
+    {
+        size_t used = 0;
+        access.address = std::stoull(address, &used, 16);
+        if (used != address.size())
+            throw std::invalid_argument(address);
+    }
+    catch (const std::exception &)
+    {
+        error = "line " + std::to_string(lineNumber) + ": bad address '" + address + "'";
+        return false;
+    }
+    access.size = static_cast<uint8_t>(size);
+    access.isWrite = label == "1";
+    return true;
+}
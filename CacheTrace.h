@@ -0,0 +1,62 @@
+/**
+ * @file CacheTrace.h
+ * @brief Reads memory address traces for the standalone cache simulator (-cachesim).
+ *
+ * Two formats are accepted, told apart by the first bytes of the file:
+ *
+ * - Binary execution traces written by --trace (see Trace.h). Only the loads and stores are
+ *   kept, with their address and size.
+ * - Dinero "din" text traces: one access per line, `label address [size]`, with a decimal
+ *   label and a hexadecimal address (an optional 0x is allowed). Labels 0 and 1 are data
+ *   reads and writes; 2 (instruction fetch), 3 (escape) and 4 (flush) are skipped and
+ *   counted. The size defaults to 4 bytes. Blank lines and lines starting with # are ignored.
+ *
+ * nextBatch() decodes up to a batch of accesses at a time, so a trace of any length is
+ * streamed through Cache::accessBatch() in constant memory.
+ */
+#ifndef CACHE_TRACE_H
+#define CACHE_TRACE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Cache.h"
+#include "Trace.h"
+
+class CacheTraceReader
+{
+public:
+    // Opens a trace in either format; on failure, getError() says why
+    bool open(const std::string &path);
+    // Replaces batch with up to maxCount accesses; returns how many (0 at the end of the
+    // trace or on an error, which getError() then reports)
+    size_t nextBatch(std::vector<CacheAccess> &batch, size_t maxCount);
+
+    bool isBinary() const
+    {
+        return binary;
+    }
+    // din records skipped: instruction fetches, escapes and flushes
+    uint64_t getSkippedCount() const
+    {
+        return skipped;
+    }
+    const std::string &getError() const
+    {
+        return error;
+    }
+
+private:
+    bool binary = false;
+    TraceReader binaryReader;
+    std::ifstream textFile;
+    uint64_t lineNumber = 0;
+    uint64_t skipped = 0;
+    std::string error;
+
+    // parses one din line; false if it holds no access (skipped or malformed)
+    bool parseDinLine(const std::string &line, CacheAccess &access);
+};
+
+#endif // CACHE_TRACE_H
@@ -46,9 +46,76 @@ def parse_log_file(lines):
         grouped.append((config, current_block))
     return grouped
 
-file = st.file_uploader("Upload a cache simulation log file", type="txt")
+def plot_hit_rates(df_summary, key):
+    # 🟢 Write Policy filter
+    write_policy_options = ["All", "WT", "WB"]
+    selected_write_policy = st.selectbox("Filter by Write Policy", write_policy_options, key=key)
 
-if file:
+    if selected_write_policy != "All":
+        df_summary = df_summary[df_summary["Write Policy"] == selected_write_policy]
+
+    if df_summary.empty:
+        st.warning(f"No data available for Write Policy = '{selected_write_policy}'")
+    else:
+        st.subheader("🧠 3D Chart: Avg Hit Rate vs Associativity by Replacement Policy")
+        fig = plt.figure(figsize=(4, 3))
+        ax = fig.add_subplot(111, projection='3d')
+
+        repl_policies = list(df_summary["Replacement Policy"].unique())
+        y_pos_map = {name: i for i, name in enumerate(repl_policies)}
+
+        for repl in repl_policies:
+            subset = df_summary[df_summary["Replacement Policy"] == repl]
+            xs = subset["Associativity"].values
+            ys = [y_pos_map[repl]] * len(subset)
+            zs = [0] * len(subset)
+            dx = 0.4
+            dy = 0.4
+            dz = subset["Hit Rate"].values
+
+            ax.bar3d(xs, ys, zs, dx, dy, dz, label=repl)
+
+        ax.set_xlabel("Associativity")
+        ax.set_ylabel("Replacement Policy")
+        ax.set_yticks(list(y_pos_map.values()))
+        ax.set_yticklabels(list(y_pos_map.keys()))
+        ax.set_zlabel("Hit Rate")
+        ax.set_title(f"3D Bar Chart: Hit Rate by Assoc and Repl Policy\n(Write Policy = {selected_write_policy})")
+        ax.legend()
+        st.pyplot(fig)
+
+# Tables written by `riscv_sim -cachesweep` (CSV or JSON), one row per cache configuration
+SWEEP_COLUMNS = {
+    "cache_size": "Cache Size",
+    "block_size": "Block Size",
+    "associativity": "Associativity",
+    "replacement_policy": "Replacement Policy",
+    "write_policy": "Write Policy",
+    "accesses": "Accesses",
+    "hits": "Hits",
+    "misses": "Misses",
+    "hit_rate": "Hit Rate",
+}
+
+def load_sweep_table(file):
+    df = pd.read_json(file) if file.name.endswith(".json") else pd.read_csv(file)
+    return df.rename(columns=SWEEP_COLUMNS)
+
+file = st.file_uploader("Upload a cache simulation log file or a -cachesweep table", type=["txt", "csv", "json"])
+
+if file and file.name.endswith((".csv", ".json")):
+    df_sweep = load_sweep_table(file)
+    st.subheader(f"Sweep: {len(df_sweep)} configurations")
+    st.dataframe(df_sweep, use_container_width=True)
+
+    sizes = sorted(df_sweep["Cache Size"].unique())
+    blocks = sorted(df_sweep["Block Size"].unique())
+    col1, col2 = st.columns(2)
+    selected_size = col1.selectbox("Cache Size", sizes)
+    selected_block = col2.selectbox("Block Size", blocks)
+    df_selected = df_sweep[(df_sweep["Cache Size"] == selected_size) & (df_sweep["Block Size"] == selected_block)]
+    plot_hit_rates(df_selected[["Associativity", "Replacement Policy", "Write Policy", "Hit Rate"]], "sweep")
+elif file:
     lines = file.readlines()
     lines = [line.decode("utf-8") if isinstance(line, bytes) else line for line in lines]
     grouped_logs = parse_log_file(lines)
@@ -90,41 +157,6 @@ if file:
 
         df_summary = pd.DataFrame(summary_data)
 
-        # 🟢 Write Policy filter
-        write_policy_options = ["All", "WT", "WB"]
-        selected_write_policy = st.selectbox("Filter by Write Policy", write_policy_options)
-
-        if selected_write_policy != "All":
-            df_summary = df_summary[df_summary["Write Policy"] == selected_write_policy]
-
-        if df_summary.empty:
-            st.warning(f"No data available for Write Policy = '{selected_write_policy}'")
-        else:
-            st.subheader("🧠 3D Chart: Avg Hit Rate vs Associativity by Replacement Policy")
-            fig = plt.figure(figsize=(4, 3))
-            ax = fig.add_subplot(111, projection='3d')
-
-            repl_policies = list(df_summary["Replacement Policy"].unique())
-            y_pos_map = {name: i for i, name in enumerate(repl_policies)}
-
-            for repl in repl_policies:
-                subset = df_summary[df_summary["Replacement Policy"] == repl]
-                xs = subset["Associativity"].values
-                ys = [y_pos_map[repl]] * len(subset)
-                zs = [0] * len(subset)
-                dx = 0.4
-                dy = 0.4
-                dz = subset["Hit Rate"].values
-
-                ax.bar3d(xs, ys, zs, dx, dy, dz, label=repl)
-
-            ax.set_xlabel("Associativity")
-            ax.set_ylabel("Replacement Policy")
-            ax.set_yticks(list(y_pos_map.values()))
-            ax.set_yticklabels(list(y_pos_map.keys()))
-            ax.set_zlabel("Hit Rate")
-            ax.set_title(f"3D Bar Chart: Hit Rate by Assoc and Repl Policy\n(Write Policy = {selected_write_policy})")
-            ax.legend()
-            st.pyplot(fig)
+        plot_hit_rates(df_summary, "log")
 else:
-    st.info("Please upload a cache simulation `.txt` file to begin.")
+    st.info("Please upload a cache simulation `.txt` log or a `-cachesweep` `.csv`/`.json` table to begin.")
@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <iostream>
 #include <cstdint>
+#include <string>
 
 /*
  * @class CallFrame
@@ -14,14 +15,15 @@
 class CallFrame {
     private:
     std::string functionName;
-    int sourceLine;
-    uint32_t returnAddress;
+    int sourceLine = 0;
+    uint32_t returnAddress = 0;
 
     public:
         CallFrame(const std::string& funcName, int srcLine, uint32_t retAddr)
             : functionName(funcName), sourceLine(srcLine), returnAddress(retAddr) {}
         uint32_t getReturnAddress() const { return returnAddress; }
         const std::string& getFunctionName() const { return functionName; }
+        int getSourceLine() const { return sourceLine; }
         CallFrame()=default;
         friend std::ostream& operator<<(std::ostream& os, const CallFrame& frame) {
             os << "  "<<frame.getFunctionName() << std::dec << " at line : " << frame.sourceLine << " Next Instruction 0x" << std::hex 
@@ -0,0 +1,167 @@
+/**
+ * @file Checkpoint.cpp
+ * @brief Little-endian encoding, header and integrity check of checkpoint files.
+ */
+#include "Checkpoint.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+    const char MAGIC[8] = {'R', 'V', 'C', 'K', 'P', 'T', 0, 0};
+
+    void appendLE(std::string &buffer, uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+            buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+    uint64_t decodeLE(const char *data, int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        return value;
+    }
+}
+
+uint64_t fnv1a64(const void *data, size_t size, uint64_t hash)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void CheckpointWriter::writeU8(uint8_t value)
+{
+    payload.push_back(static_cast<char>(value));
+}
+
+void CheckpointWriter::writeU32(uint32_t value)
+{
+    appendLE(payload, value, 4);
+}
+
+void CheckpointWriter::writeU64(uint64_t value)
+{
+    appendLE(payload, value, 8);
+}
+
+void CheckpointWriter::writeBytes(const uint8_t *data, size_t size)
+{
+    payload.append(reinterpret_cast<const char *>(data), size);
+}
+
+void CheckpointWriter::writeString(const std::string &text)
+{
+    writeU32(static_cast<uint32_t>(text.size()));
+    payload.append(text);
+}
+
+bool CheckpointWriter::writeTo(std::ostream &out) const
+{
+    std::string header(MAGIC, sizeof(MAGIC));
+    appendLE(header, VERSION, 4);
+    appendLE(header, payload.size(), 8);
+    appendLE(header, fnv1a64(payload.data(), payload.size()), 8);
+    out.write(header.data(), header.size());
+    out.write(payload.data(), payload.size());
+    return static_cast<bool>(out);
+}
+
+bool CheckpointReader::readFrom(std::istream &in)
+{
+    good = false;
+    position = 0;
+    std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const size_t headerSize = sizeof(MAGIC) + 4 + 8 + 8;
+    if (file.size() < headerSize || std::memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = "not a checkpoint file";
+        return false;
+    }
+    const char *header = file.data() + sizeof(MAGIC);
+    uint32_t version = static_cast<uint32_t>(decodeLE(header, 4));
+    uint64_t size = decodeLE(header + 4, 8);
+    uint64_t hash = decodeLE(header + 12, 8);
+    if (version != CheckpointWriter::VERSION)
+    {
+        error = "unsupported checkpoint version " + std::to_string(version);
+        return false;
+    }
+    if (size != file.size() - headerSize)
+    {
+        error = "checkpoint file is truncated";
+        return false;
+    }
+    payload = file.substr(headerSize);
+    if (fnv1a64(payload.data(), payload.size()) != hash)
+    {
+        error = "checkpoint file is corrupted";
+        return false;
+    }
+    good = true;
+    error.clear();
+    return true;
+}
+
+bool CheckpointReader::available(size_t size)
+{
+    if (good && payload.size() - position >= size)
+        return true;
+    good = false;
+    error = "checkpoint payload ends early";
+    return false;
+}
+
+uint8_t CheckpointReader::readU8()
+{
+    if (!available(1))
+        return 0;
+    return static_cast<uint8_t>(payload[position++]);
+}
+
+uint32_t CheckpointReader::readU32()
+{
+    if (!available(4))
+        return 0;
+    uint32_t value = static_cast<uint32_t>(decodeLE(payload.data() + position, 4));
+    position += 4;
+    return value;
+}
+
+uint64_t CheckpointReader::readU64()
+{
+    if (!available(8))
+        return 0;
+    uint64_t value = decodeLE(payload.data() + position, 8);
+    position += 8;
+    return value;
+}
+
+void CheckpointReader::readBytes(uint8_t *data, size_t size)
+{
+    if (!available(size))
+    {
+        std::memset(data, 0, size);
+        return;
+    }
+    std::memcpy(data, payload.data() + position, size);
+    position += size;
+}
+
+std::string CheckpointReader::readString()
+{
+    uint32_t size = readU32();
+    if (!available(size))
+        return "";
+    std::string text = payload.substr(position, size);
+    position += size;
+    return text;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file Checkpoint.h
+ * @brief Binary encoding used to save and restore the full simulator state.
+ *
+ * A checkpoint file is a short header followed by a payload:
+ *
+ *   magic "RVCKPT\0\0" | u32 version | u64 payload size | u64 FNV-1a hash of the payload | payload
+ *
+ * All integers are little-endian. The payload is a fixed sequence of sections, each written
+ * by the class that owns the state (Simulator, Memory, ShadowCallStack, CacheSimulator/Cache,
+ * HazardDetector) through saveState(CheckpointWriter&) and read back by the matching
+ * loadState(CheckpointReader&). There are no section tags: writer and reader must agree on
+ * the order, and the version is bumped whenever it changes.
+ *
+ * CheckpointReader::readFrom() checks the header, size and hash before anything is decoded,
+ * so a truncated or corrupted file is rejected before the simulator state is touched.
+ */
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+class CheckpointWriter
+{
+public:
+    static constexpr uint32_t VERSION = 11;
+
+    void writeU8(uint8_t value);
+    void writeU32(uint32_t value);
+    void writeU64(uint64_t value);
+    void writeI32(int32_t value) { writeU32(static_cast<uint32_t>(value)); }
+    void writeI64(int64_t value) { writeU64(static_cast<uint64_t>(value)); }
+    void writeBool(bool value) { writeU8(value ? 1 : 0); }
+    void writeBytes(const uint8_t *data, size_t size);
+    void writeString(const std::string &text);
+
+    // Writes the header and the payload; false on a stream error
+    bool writeTo(std::ostream &out) const;
+
+private:
+    std::string payload;
+};
+
+class CheckpointReader
+{
+public:
+    // Reads and verifies a whole checkpoint. On failure, getError() says why.
+    bool readFrom(std::istream &in);
+
+    uint8_t readU8();
+    uint32_t readU32();
+    uint64_t readU64();
+    int32_t readI32() { return static_cast<int32_t>(readU32()); }
+    int64_t readI64() { return static_cast<int64_t>(readU64()); }
+    bool readBool() { return readU8() != 0; }
+    void readBytes(uint8_t *data, size_t size);
+    std::string readString();
+
+    // false once a read ran past the end of the payload (reads then return zeros)
+    bool isGood() const { return good; }
+    const std::string &getError() const { return error; }
+
+private:
+    std::string payload;
+    size_t position = 0;
+    bool good = false;
+    std::string error;
+
+    // true if `size` more bytes can be read
+    bool available(size_t size);
+};
+
+// 64-bit FNV-1a, used for the payload hash and for program fingerprints
+uint64_t fnv1a64(const void *data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL);
+
+#endif // CHECKPOINT_H
@@ -143,57 +143,60 @@
         return hazard;
     }
 
-    std::vector<Hazard> HazardDetector::detectHazards( const std::vector<InstructionInstance>& program, int currentPC, bool cacheEnabled) {
+    std::vector<Hazard> HazardDetector::detectHazards(const std::vector<PackedInstruction>& packed,
+                                                      const std::vector<InstructionInstance>& program, int currentPC, bool cacheEnabled) {
 
         std::vector<Hazard> hazards;
         //int windowSize = 6;
 
-        for (int i = currentPC; i < (int)program.size(); ++i) {
-            const InstructionInstance& inst1 = program[i];
-            std::string name1 = inst1.instruction->mnemonic;
+        // Register fields that do not exist for an instruction are packed as x0, so the
+        // "!= 0" checks below also skip them.
+        for (int i = currentPC; i < (int)packed.size(); ++i) {
+            const PackedInstruction& inst1 = packed[i];
+            const Opcode op1 = inst1.op;
 
             // ----- Control Hazards -----
-            if (inst1.instruction->isBranchInstruction(name1) || inst1.instruction->isJumpInstruction(name1)) {
-                int stall = calculateControlStallCycles(inst1);
+            if (opcodeIsBranch(op1) || opcodeIsJump(op1)) {
+                int stall = calculateControlStallCycles(inst1, program[i].pc);
                 std::string reason ;
-                if(name1 == "jalr") {
+                if(op1 == Opcode::JALR) {
                     reason = "Function return: "; 
                 }
                 else reason = "Branch instruction: " ;
-                hazards.push_back(makeControlHazard(&inst1, nullptr, reason + name1, stall));        
+                hazards.push_back(makeControlHazard(&program[i], nullptr, reason + opcodeToMnemonic(op1), stall));        
                 stats.controlStalls += stall;
                 stats.totalStalls += stall;
             }
 
             // ----- Cache Hazards (static estimation) -----
-            if (cacheEnabled && (inst1.instruction->isLoadInstruction(name1) || inst1.instruction->isStoreInstruction(name1))) {
+            if (cacheEnabled && (opcodeIsLoad(op1) || opcodeIsStore(op1))) {
                 uint32_t dummyAddress = 0;  // Or any heuristic estimation of address
                 int stall = calculateCacheStallCycles(); 
-                Hazard h = makeCacheHazard(&inst1, nullptr, dummyAddress,stall);
+                Hazard h = makeCacheHazard(&program[i], nullptr, dummyAddress,stall);
                 hazards.push_back(h);
                 stats.cacheStalls += h.stallCycles;
                 stats.totalStalls += h.stallCycles;
             }
     
-            for (int j = i + 1; j < (int)program.size(); ++j) {
-                const InstructionInstance& inst2 = program[j];
+            for (int j = i + 1; j < (int)packed.size(); ++j) {
+                const PackedInstruction& inst2 = packed[j];
 
                 int distance = j - i;
 
                 // RAW (Read After Write): inst2 reads rs1 or rs2 that inst1 writes to rd
-                if (inst1.rd != -1 && inst1.rd != 0) {
+                if (inst1.rd != 0) {
                     bool hazardDetected = false;
                     
-                    if (inst2.rs1 != -1 && inst2.rs1 == inst1.rd) {
+                    if (inst2.rs1 == inst1.rd) {
                         hazardDetected = true;
                     }
-                    if (inst2.rs2 != -1 && inst2.rs2 == inst1.rd) {
+                    if (inst2.rs2 == inst1.rd) {
                         hazardDetected = true;
                     }
 
                     if (hazardDetected) {
                         int stall = calculateRAWStallCycles(inst1, distance);
-                        Hazard h = makeRAWHazard(&inst1, &inst2, inst1.rd, stall);
+                        Hazard h = makeRAWHazard(&program[i], &program[j], inst1.rd, stall);
                         hazards.push_back(h);
                         stats.rawStalls += h.stallCycles;
                         stats.totalStalls += h.stallCycles;
@@ -201,9 +204,9 @@
                     }
                 }
                 // WAW (Write After Write): both inst1 and inst2 write to same rd
-                if (inst1.rd != -1 && inst2.rd != -1 && inst1.rd == inst2.rd && inst1.rd != 0) {
+                if (inst1.rd == inst2.rd && inst1.rd != 0) {
                     int stall = calculateWAWStallCycles();
-                    Hazard h = makeWAWHazard(&inst1, &inst2, inst1.rd, stall);
+                    Hazard h = makeWAWHazard(&program[i], &program[j], inst1.rd, stall);
                     hazards.push_back(h);
                     stats.wawStalls += h.stallCycles;
                     stats.totalStalls += h.stallCycles;
@@ -211,19 +214,19 @@
                 }
 
                 // WAR (Write After Read): inst1 reads rs1 or rs2 that inst2 writes to rd
-                if (inst2.rd != -1 && inst2.rd != 0) {
+                if (inst2.rd != 0) {
                     bool hazardDetected = false;
 
-                    if (inst1.rs1 != -1 && inst1.rs1 == inst2.rd) {
+                    if (inst1.rs1 == inst2.rd) {
                         hazardDetected = true;
                     }
-                    if (inst1.rs2 != -1 && inst1.rs2 == inst2.rd) {
+                    if (inst1.rs2 == inst2.rd) {
                         hazardDetected = true;
                     }
 
                     if (hazardDetected) {
                         int stall = calculateWARStallCycles();
-                        Hazard h = makeWARHazard(&inst1, &inst2, inst2.rd, stall);
+                        Hazard h = makeWARHazard(&program[i], &program[j], inst2.rd, stall);
                         hazards.push_back(h); 
                         stats.warStalls += h.stallCycles;
                         stats.totalStalls += h.stallCycles;                        
@@ -233,10 +236,10 @@
                 int structStall = calculateStructuralStallCycles(inst1, inst2, distance);
                     if (structStall > 0) {
                         std::string unit = "Functional unit";  
-                        if (inst1.instruction->isMulDivInstruction(name1)) unit = "Mul/Div Unit";
-                        else if (inst1.instruction->isALUInstruction(name1)) unit = "ALU";
-                        else if (inst1.instruction->isLoadInstruction(name1) || inst1.instruction->isStoreInstruction(name1)) unit = "Memory Access Unit";
-                        hazards.push_back(makeStructuralHazard(&inst1, &inst2, unit, structStall));
+                        if (opcodeIsMulDiv(op1)) unit = "Mul/Div Unit";
+                        else if (opcodeIsALU(op1)) unit = "ALU";
+                        else if (opcodeIsLoad(op1) || opcodeIsStore(op1)) unit = "Memory Access Unit";
+                        hazards.push_back(makeStructuralHazard(&program[i], &program[j], unit, structStall));
                         stats.structuralStalls += structStall;
                         stats.totalStalls += structStall;
                     }
@@ -248,9 +251,8 @@
     }
 
 
-    int HazardDetector::calculateRAWStallCycles(const InstructionInstance& inst1,  int distance) {
-       const std::string& name = inst1.instruction->mnemonic;
-       bool isLoad = inst1.instruction->isLoadInstruction(name);
+    int HazardDetector::calculateRAWStallCycles(const PackedInstruction& inst1,  int distance) {
+       bool isLoad = opcodeIsLoad(inst1.op);
         
         int baseStallCycles = 0;
         
@@ -305,22 +307,21 @@
         return 0; // No WAR stalls in in-order pipelines
     }
 
-   int HazardDetector::calculateControlStallCycles(const InstructionInstance& inst) {
+   int HazardDetector::calculateControlStallCycles(const PackedInstruction& inst, uint32_t pc) {
         // Control hazards depend on branch prediction and pipeline depth
-        const std::string& mnemonic = inst.instruction->mnemonic;
-            if (!inst.instruction->isBranchInstruction(mnemonic) && !inst.instruction->isJumpInstruction(mnemonic)) {
+            if (!opcodeIsBranch(inst.op) && !opcodeIsJump(inst.op)) {
                 return 0;
             }
 
 
         
         // Exempt only truly unconditional jumps (like jal)
-        if (mnemonic == "jal") {
+        if (inst.op == Opcode::JAL) {
             return 0;
         }    
 
         // For jalr, treat as unpredictable jump → control hazard
-        if (mnemonic == "jalr") {
+        if (inst.op == Opcode::JALR) {
             switch (pipelineType) {
                 case PIPELINE_3_STAGE: return 1;
                 case PIPELINE_5_STAGE: return 2;
@@ -330,7 +331,7 @@
         }
 
         // Handle conditional branches
-        if (inst.instruction->isBranchInstruction(mnemonic)) {
+        if (opcodeIsBranch(inst.op)) {
             
             bool isLoop = inst.imm < 0; //inst.targetPC < inst.pc;  // Backward branch
             
@@ -338,7 +339,7 @@
             if (isLoop) {
                 // Only mispredict at final iteration
                 bool alreadyReported = std::any_of(this->detectedHazards.begin(), this->detectedHazards.end(),[&](const Hazard& h) {
-                    return h.type == Hazard::CONTROL && h.instruction1 != nullptr && h.instruction1->pc == inst.pc;});
+                    return h.type == Hazard::CONTROL && h.instruction1 != nullptr && h.instruction1->pc == pc;});
 
                 if (!alreadyReported) {
                     
@@ -367,10 +368,10 @@
 
   }
  
-    int HazardDetector::calculateStructuralStallCycles(const InstructionInstance& inst1, const InstructionInstance& inst2, int distance) 
+    int HazardDetector::calculateStructuralStallCycles(const PackedInstruction& inst1, const PackedInstruction& inst2, int distance) 
     {
-        const std::string& name1 = inst1.instruction->mnemonic;
-        const std::string& name2 = inst2.instruction->mnemonic;
+        const Opcode op1 = inst1.op;
+        const Opcode op2 = inst2.op;
 
         // Structural hazards only occur when the same unit is needed by both instructions
         // at overlapping times (i.e., distance too small for reuse).
@@ -378,14 +379,14 @@
         // === 3-stage pipeline: Fetch, Execute, WriteBack ===
         if (pipelineType == PIPELINE_3_STAGE) {
             // ALU unit is used in Execute stage: can't do back-to-back if single ALU
-            if (inst1.instruction->isALUInstruction(name1) &&
-                inst2.instruction->isALUInstruction(name2) &&
+            if (opcodeIsALU(op1) &&
+                opcodeIsALU(op2) &&
                 distance == 0)
                 return 1;
 
             // Load unit used in Execute: also needs 1 cycle gap
-            if (inst1.instruction->isLoadInstruction(name1) &&
-                inst2.instruction->isLoadInstruction(name2) &&
+            if (opcodeIsLoad(op1) &&
+                opcodeIsLoad(op2) &&
                 distance == 0)
                 return 1;
         }
@@ -393,20 +394,20 @@
         // === 5/7-stage pipelines: functional units are more specialized ===
         if (pipelineType == PIPELINE_5_STAGE || pipelineType == PIPELINE_7_STAGE) {
             // ALU executes in EX stage — if only one ALU, back-to-back causes stall
-            if (inst1.instruction->isALUInstruction(name1) &&
-                inst2.instruction->isALUInstruction(name2) &&
+            if (opcodeIsALU(op1) &&
+                opcodeIsALU(op2) &&
                 distance == 0)
                 return 1;
 
             // Memory access unit shared by loads and stores (in MEM stage)
-            if ((inst1.instruction->isLoadInstruction(name1) || inst1.instruction->isStoreInstruction(name1)) &&
-                (inst2.instruction->isLoadInstruction(name2) || inst2.instruction->isStoreInstruction(name2)) &&
+            if ((opcodeIsLoad(op1) || opcodeIsStore(op1)) &&
+                (opcodeIsLoad(op2) || opcodeIsStore(op2)) &&
                 distance < 2)
                 return 1;
 
             // Mult/Div usually uses a long-latency unit — needs 2 cycles spacing
-            if (inst1.instruction->isMulDivInstruction(name1) &&
-                inst2.instruction->isMulDivInstruction(name2) &&
+            if (opcodeIsMulDiv(op1) &&
+                opcodeIsMulDiv(op2) &&
                 distance < 2)
                 return 2;
         }
@@ -415,6 +416,55 @@
         return 0;
     }
 
+    int HazardDetector::mispredictPenalty() const {
+        switch (pipelineType) {
+            case PIPELINE_3_STAGE: return 1;
+            case PIPELINE_5_STAGE: return 2;
+            case PIPELINE_7_STAGE: return 3;
+            default: return 2;
+        }
+    }
+
+    InstructionTiming HazardDetector::timeInstruction(const PackedInstruction& inst, bool branchTaken, bool cacheMiss,
+                                                      int writeBufferStalls) {
+        InstructionTiming timing;
+        timing.writeBufferStalls = writeBufferStalls;
+        int count = static_cast<int>(recentInstructions.size());
+
+        for (int distance = 1; distance <= count; ++distance) {
+            const PackedInstruction& prior = recentInstructions[count - distance];
+            // RAW on the nearest earlier writer of a source register
+            if (timing.rawStalls == 0 && prior.rd != 0 && (inst.rs1 == prior.rd || inst.rs2 == prior.rd)) {
+                timing.rawStalls = calculateRAWStallCycles(prior, distance);
+            }
+            timing.structuralStalls = std::max(timing.structuralStalls,
+                                               calculateStructuralStallCycles(prior, inst, distance));
+        }
+
+        if (inst.op == Opcode::JALR) {
+            timing.controlStalls = mispredictPenalty();
+        } else if (opcodeIsBranch(inst.op)) {
+            bool predictedTaken = inst.imm < 0;
+            if (branchTaken != predictedTaken) {
+                timing.controlStalls = mispredictPenalty();
+            }
+        }
+
+        if (cacheMiss) {
+            timing.cacheStalls = calculateCacheStallCycles();
+        }
+
+        recentInstructions.push_back(inst);
+        if (static_cast<int>(recentInstructions.size()) > TIMING_WINDOW) {
+            recentInstructions.erase(recentInstructions.begin());
+        }
+        return timing;
+    }
+
+    void HazardDetector::resetTiming() {
+        recentInstructions.clear();
+    }
+
     int HazardDetector::calculateCacheStallCycles() const {
         switch (pipelineType) {
             case PIPELINE_3_STAGE: return 5;  // Assume small penalty due to no separate MEM stage
@@ -438,6 +488,10 @@
         }
     }
 
+    void HazardDetector::setPipelineType(PipelineType type) {
+        pipelineType = type;
+    }
+
     std::string HazardDetector::getPipelineTypeName() {
         switch (pipelineType) {
             case PIPELINE_3_STAGE: return "3-Stage";
@@ -521,6 +575,8 @@
             out << "  Structural Hazards: " << stats.structuralStalls << "\n";
         if(stats.cacheStalls > 0)
             out << "  Cache Misses: " << stats.cacheStalls << "\n";
+        if(stats.writeBufferStalls > 0)
+            out << "  Write Buffer Stalls: " << stats.writeBufferStalls << "\n";
         
         out << "  Total Instructions: " << stats.totalInstructions << "\n";
         out << "  Total Cycles: " << stats.totalCycles << "\n";
@@ -582,15 +638,22 @@
 
 
 
-void HazardDetector::performanceAnalysis(std::vector<InstructionInstance> &program, bool cacheEnabled) {
+void HazardDetector::performanceAnalysis(const std::vector<PackedInstruction> &packed,
+                                         const std::vector<InstructionInstance> &program, bool cacheEnabled) {
         
         out << "\n=== PERFORMANCE ANALYSIS ===\n";
         
-        // Analyze entire program for hazards
+        // Analyze entire program for hazards; write buffer stalls were measured, not estimated
+        int writeBufferStalls = stats.writeBufferStalls;
         stats.reset();
         detectedHazards.clear();
         
-        detectedHazards = detectHazards(program, 0, cacheEnabled);
+        detectedHazards = detectHazards(packed, program, 0, cacheEnabled);
+        stats.writeBufferStalls = writeBufferStalls;
+        stats.totalStalls += writeBufferStalls;
+        if (writeBufferStalls > 0) {
+            out << "Write buffer stall cycles (measured): " << writeBufferStalls << "\n";
+        }
         
         
         out << "Program instructions: " << program.size() << "\n";
@@ -614,3 +677,36 @@ void HazardDetector::performanceAnalysis(std::vector<InstructionInstance> &progr
         out << "===========================\n\n";
     }
 
+    void HazardDetector::addWriteBufferStalls(int cycles) {
+        stats.writeBufferStalls += cycles;
+        stats.totalStalls += cycles;
+        stats.totalCycles += cycles;
+    }
+
+    void HazardDetector::saveState(CheckpointWriter& writer) const {
+        writer.writeBool(pipelineEnabled);
+        writer.writeBool(forwardingEnabled);
+        writer.writeU8(static_cast<uint8_t>(pipelineType));
+        writer.writeI32(currentCycle);
+        const int counters[] = {stats.totalStalls, stats.rawStalls, stats.wawStalls, stats.warStalls,
+                                stats.controlStalls, stats.structuralStalls, stats.cacheStalls,
+                                stats.writeBufferStalls, stats.totalInstructions, stats.totalCycles};
+        for (int counter : counters) {
+            writer.writeI32(counter);
+        }
+    }
+
+    bool HazardDetector::loadState(CheckpointReader& reader) {
+        pipelineEnabled = reader.readBool();
+        forwardingEnabled = reader.readBool();
+        pipelineType = static_cast<PipelineType>(reader.readU8());
+        currentCycle = reader.readI32();
+        int* counters[] = {&stats.totalStalls, &stats.rawStalls, &stats.wawStalls, &stats.warStalls,
+                           &stats.controlStalls, &stats.structuralStalls, &stats.cacheStalls,
+                           &stats.writeBufferStalls, &stats.totalInstructions, &stats.totalCycles};
+        for (int* counter : counters) {
+            *counter = reader.readI32();
+        }
+        detectedHazards.clear();
+        return reader.isGood();
+    }
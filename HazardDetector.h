@@ -7,6 +7,8 @@
 #include <iostream>
 #include "stdlib.h"
 #include "InstructionInstance.h"
+#include "PackedInstruction.h"
+#include "Checkpoint.h"
 
 
 
@@ -40,16 +42,34 @@ struct PipelineStats {
     int controlStalls = 0;
     int structuralStalls = 0;
     int cacheStalls = 0;
+    int writeBufferStalls = 0; // measured while running: stores waiting for a full write buffer
     int totalInstructions = 0;
     int totalCycles = 0;
     
     void reset() {
         totalStalls = rawStalls = wawStalls = warStalls = 0;
-        controlStalls = structuralStalls = cacheStalls = 0;
+        controlStalls = structuralStalls = cacheStalls = writeBufferStalls = 0;
         totalInstructions = totalCycles = 0;
     }
 };
 
+// Stall cycles charged to one executed instruction by HazardDetector::timeInstruction()
+struct InstructionTiming {
+    int rawStalls = 0;
+    int structuralStalls = 0;
+    int controlStalls = 0;
+    int cacheStalls = 0;
+    int writeBufferStalls = 0; // a store waiting for a full write buffer
+
+    int totalStalls() const {
+        return rawStalls + structuralStalls + controlStalls + cacheStalls + writeBufferStalls;
+    }
+    // one issue cycle plus stalls
+    int cycles() const {
+        return 1 + totalStalls();
+    }
+};
+
 class HazardDetector {
     private:
         std::vector<InstructionInstance> instructionWindow;
@@ -67,6 +87,9 @@ class HazardDetector {
         PipelineStats stats;
         int currentCycle = 0;
         std::vector<Hazard> detectedHazards;
+        // last executed instructions for timeInstruction(), newest last
+        static constexpr int TIMING_WINDOW = 3;
+        std::vector<PackedInstruction> recentInstructions;
             
     public:
         HazardDetector(std::istream& in = std::cin, std::ostream& out = std::cout)
@@ -85,23 +108,45 @@ class HazardDetector {
         bool isPipelineEnabled() const {
             return pipelineEnabled;
         }   
-
-        std::vector<Hazard> detectHazards(const std::vector<InstructionInstance>& program, int currentPC, 
+        // cycles a store of the running program waited for the cache's write buffer; kept in
+        // the stall totals across "pipeline analyze"
+        void addWriteBufferStalls(int cycles);
+
+        // checkpoint: pipeline settings, cycle and PipelineStats. The hazard list points into
+        // the program and is not saved; run "pipeline analyze" again after a restore.
+        void saveState(CheckpointWriter& writer) const;
+        bool loadState(CheckpointReader& reader);
+
+        // packed is scanned; program (same indices) is only referenced by the returned hazards for printing
+        std::vector<Hazard> detectHazards(const std::vector<PackedInstruction>& packed,
+                                      const std::vector<InstructionInstance>& program, int currentPC, 
                                       bool cacheEnabled = false);
         void setPipelineType(PipelineType type);
-        void performanceAnalysis(std::vector<InstructionInstance> &program, bool cacheEnabled);
+        void performanceAnalysis(const std::vector<PackedInstruction> &packed,
+                                 const std::vector<InstructionInstance> &program, bool cacheEnabled);
         void analyzeHazards(std::vector<InstructionInstance> &program,int pc, bool cacheEnabled);
+
+        // Dynamic timing (sampled simulation): prices one executed instruction against the
+        // instructions executed just before it, with the same stall rules as the static
+        // analysis. Branches pay the control penalty unless the backward-taken /
+        // forward-not-taken prediction was right. writeBufferStalls: cycles the instruction's
+        // store waited for the cache's write buffer, charged as they are.
+        InstructionTiming timeInstruction(const PackedInstruction& inst, bool branchTaken, bool cacheMiss,
+                                          int writeBufferStalls = 0);
+        // forgets the recently executed instructions (after a functional fast-forward)
+        void resetTiming();
  
 private:
         std::istream &in;
         std::ostream &out;
       
-        int calculateRAWStallCycles(const InstructionInstance& inst1, int distance);
+        int calculateRAWStallCycles(const PackedInstruction& inst1, int distance);
         int calculateWAWStallCycles();
         int calculateWARStallCycles() ;
-        int calculateControlStallCycles(const InstructionInstance& inst);
+        int calculateControlStallCycles(const PackedInstruction& inst, uint32_t pc);
         int calculateCacheStallCycles() const;
-        int calculateStructuralStallCycles(const InstructionInstance& inst1, const InstructionInstance& inst2, int distance); 
+        int mispredictPenalty() const;
+        int calculateStructuralStallCycles(const PackedInstruction& inst1, const PackedInstruction& inst2, int distance); 
 
         std::string getSolutionForRAW(int stallCycles);
         std::string getSolutionForWAR(int stallCycles);
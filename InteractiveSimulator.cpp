@@ -20,9 +20,14 @@
  *   - step: Execute the next instruction.
  *   - regs: Display register values.
  *   - mem <addr> <count>: Display memory contents.
+ *   - mem map <file> <addr> [ro|private]: Map a host file into guest memory.
  *   - show-stack: Show the current call stack.
  *   - break <line>: Set a breakpoint at a source line.
  *   - del break <line>: Remove a breakpoint.
+ *   - quiet <on|off>: Turn the per-instruction trace off or on.
+ *   - history: Show the most recently executed instructions.
+ *   - trace start <file> | trace stop | trace dump <file> [count]: Record or print a binary
+ *     execution trace.
  *
  * Error handling and user guidance are provided for invalid commands and arguments.
  */
@@ -146,8 +151,39 @@ void InteractiveSimulator::runInteractive()
         else if (command == "mem")
         {
             std::string addrStr;
-            int count;
-            iss >> addrStr >> count;
+            int count = 0;
+            iss >> addrStr;
+            if (addrStr == "map")
+            {
+                std::string file, guestStr, modeStr = "ro";
+                iss >> file >> guestStr >> modeStr;
+                if (file.empty() || guestStr.empty() || (modeStr != "ro" && modeStr != "private"))
+                {
+                    out << "Usage: mem map <file> <addr> [ro|private]\n";
+                    continue;
+                }
+                uint64_t guestAddress = 0;
+                try
+                {
+                    guestAddress = std::stoull(guestStr, nullptr, 0);
+                }
+                catch (const std::exception &e)
+                {
+                    out << "Invalid address format: " << guestStr << "\n";
+                    continue;
+                }
+                if (guestAddress > UINT32_MAX)
+                {
+                    out << "Invalid address: " << guestStr << " is above 4 GiB\n";
+                    continue;
+                }
+                Memory::MapMode mapMode = modeStr == "private" ? Memory::MapMode::PRIVATE : Memory::MapMode::READ_ONLY;
+                if (mapFile(file, static_cast<uint32_t>(guestAddress), mapMode))
+                    out << "Mapped " << file << " at 0x" << std::hex << guestAddress << std::dec
+                        << (mapMode == Memory::MapMode::PRIVATE ? " (private copy-on-write)\n" : " (read-only)\n");
+                continue;
+            }
+            iss >> count;
             if (addrStr.empty() || count <= 0)
             {
                 out << "Usage: mem <addr> <count>\n";
@@ -171,6 +207,71 @@ void InteractiveSimulator::runInteractive()
         {
             showStack();
         }
+        else if (command == "quiet")
+        {
+            std::string mode;
+            iss >> mode;
+            if (mode == "on")
+                setQuiet(true);
+            else if (mode == "off")
+                setQuiet(false);
+            else
+            {
+                out << "Usage: quiet <on|off>\n";
+                continue;
+            }
+            out << "Quiet mode " << (isQuiet() ? "on" : "off") << "\n";
+        }
+        else if (command == "history")
+        {
+            dumpPcHistory();
+        }
+        else if (command == "trace")
+        {
+            std::string subcmd, filename;
+            iss >> subcmd >> filename;
+            if (subcmd == "start" && !filename.empty())
+            {
+                if (startTrace(filename))
+                    out << "Tracing to " << filename << "\n";
+            }
+            else if (subcmd == "stop")
+            {
+                if (isTracing())
+                    stopTrace();
+                else
+                    out << "No trace is being recorded.\n";
+            }
+            else if (subcmd == "dump" && !filename.empty())
+            {
+                uint64_t count = 0;
+                iss >> count;
+                dumpTrace(filename, out, count);
+            }
+            else
+            {
+                out << "Usage: trace start <filename> | trace stop | trace dump <filename> [count]\n";
+            }
+        }
+        else if (command == "checkpoint")
+        {
+            std::string subcmd, filename;
+            iss >> subcmd >> filename;
+            if ((subcmd != "save" && subcmd != "load") || filename.empty())
+            {
+                out << "Usage: checkpoint <save|load> <filename>\n";
+                continue;
+            }
+            if (program.empty())
+            {
+                out << "Error: No program loaded.\n";
+                continue;
+            }
+            if (subcmd == "save" && saveCheckpoint(filename))
+                out << "Checkpoint saved to " << filename << "\n";
+            else if (subcmd == "load" && loadCheckpoint(filename))
+                out << "Checkpoint restored from " << filename << "; PC=0x" << std::hex << pc << std::dec << "\n";
+        }
         else if (command == "break")
         {
             std::string lineStr;
@@ -318,7 +419,7 @@ void InteractiveSimulator::runInteractive()
             
             else if (subcmd == "analyze")
             {
-                hazardDetector.performanceAnalysis(program, cacheSim.isEnabled() );
+                hazardDetector.performanceAnalysis(packedProgram, program, cacheSim.isEnabled() );
                 out << "Static analysis of pipeline completed.\n";
             }
             else if (subcmd == "hazards")
@@ -384,8 +485,16 @@ void InteractiveSimulator::runInteractive()
                 << "  run                              Execute the loaded RISC-V code till completion or breakpoint\n"
                 << "  regs                             Display all 64-bit registers in hexadecimal format\n"
                 << "  mem <addr> <count>               Display <count> memory values starting at <addr> (data section)\n"
+                << "  mem map <file> <addr> [ro|private]  Map a host file at a 4 KiB aligned <addr> (after load; default ro)\n"
                 << "  step                             Execute the next instruction and show: \"Executed <instruction>; PC=<address>\"\n"
                 << "  show-stack                       Show the current call stack (function calls and returns)\n"
+                << "  quiet <on|off>                   Turn off/on the per-instruction trace and call stack output for long runs\n"
+                << "  history                          Show the last executed instructions (kept even in quiet mode)\n"
+                << "  checkpoint save <filename>       Save registers, memory, cache, call stack and pipeline stats to a file\n"
+                << "  checkpoint load <filename>       Restore a checkpoint saved with the currently loaded program\n"
+                << "  trace start <filename>           Record every executed instruction to a binary trace file\n"
+                << "  trace stop                       Finish the trace file\n"
+                << "  trace dump <filename> [count]    Print the first [count] instructions (default all) of a trace\n"
                 << "  break <line>                     Set a breakpoint at a specific source line (up to 5 breakpoints allowed)\n"
                 << "  del break <line>                 Remove the breakpoint at the specified line. Shows error if none exists\n"
                 << "  cache_sim enable <config_file>   Enable cache simulation with the specified configuration file\n"
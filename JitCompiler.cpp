@@ -0,0 +1,380 @@
+/**
+ * @file JitCompiler.cpp
+ * @brief x86-64 code generation for hot basic blocks.
+ *
+ * Generated function: void block(JitContext *ctx)
+ *   - rbx holds ctx and r12 holds ctx->regs for the whole block (both callee-saved, so they
+ *     survive the callbacks).
+ *   - Each op loads its sources into rax/rcx, computes into rax, sign-extends eax into rax
+ *     (RV32 modes and *W ops) and stores it to regs[rd] (skipped for x0).
+ *   - Callbacks follow the System V ABI: owner in rdi, then rsi, rdx, rcx, r8. Loads and stores
+ *     pass their own guest PC as the last argument.
+ *
+ * The arena is a single RWX mapping filled by a bump pointer. Code is never freed one block
+ * at a time; reset() rewinds the arena when the Simulator drops all blocks (new program).
+ */
+#include "JitCompiler.h"
+
+#include <vector>
+
+#ifdef RISCV_JIT_X86_64
+#include <sys/mman.h>
+#include <cstring>
+#endif
+
+namespace
+{
+#ifdef RISCV_JIT_X86_64
+    constexpr size_t ARENA_SIZE = 16 * 1024 * 1024;
+
+    // host register numbers as used in ModRM
+    constexpr uint8_t RAX = 0, RCX = 1;
+
+    class Emitter
+    {
+    public:
+        std::vector<uint8_t> code;
+
+        void bytes(std::initializer_list<uint8_t> b) { code.insert(code.end(), b); }
+        void imm32(int32_t v)
+        {
+            for (int i = 0; i < 4; ++i)
+                code.push_back(static_cast<uint8_t>(static_cast<uint32_t>(v) >> (8 * i)));
+        }
+        void imm64(uint64_t v)
+        {
+            for (int i = 0; i < 8; ++i)
+                code.push_back(static_cast<uint8_t>(v >> (8 * i)));
+        }
+
+        // <opcode> host, [r12 + 8*guest] (or the reverse, depending on opcode)
+        void guestRegOp(uint8_t opcode, uint8_t host, int guest)
+        {
+            bytes({0x49, opcode, static_cast<uint8_t>(0x84 | (host << 3)), 0x24});
+            imm32(guest * 8);
+        }
+        void loadGuest(uint8_t host, int guest) { guestRegOp(0x8B, host, guest); }  // mov host, regs[guest]
+        void storeGuest(uint8_t host, int guest) { guestRegOp(0x89, host, guest); } // mov regs[guest], host
+        void storeGuestImm(int guest, int32_t value)                               // mov qword regs[guest], simm32
+        {
+            bytes({0x49, 0xC7, 0x84, 0x24});
+            imm32(guest * 8);
+            imm32(value);
+        }
+
+        // rax = sext(eax) if signExtend, then regs[rd] = rax
+        void writeBack(int rd, bool signExtend)
+        {
+            if (rd == 0)
+                return;
+            if (signExtend)
+                bytes({0x48, 0x63, 0xC0}); // movsxd rax, eax
+            storeGuest(RAX, rd);
+        }
+
+        // call [rbx + offset] with rdi = ctx->owner
+        void callback(uint8_t offset)
+        {
+            bytes({0x48, 0x8B, 0x7B, static_cast<uint8_t>(offsetof(JitContext, owner))}); // mov rdi, [rbx+owner]
+            bytes({0xFF, 0x53, offset});                                                  // call [rbx+offset]
+        }
+    };
+
+    bool isWordOp(Opcode op)
+    {
+        switch (op)
+        {
+        case Opcode::ADDW:
+        case Opcode::SUBW:
+        case Opcode::MULW:
+        case Opcode::SLLW:
+        case Opcode::SRLW:
+        case Opcode::SRAW:
+        case Opcode::ADDIW:
+        case Opcode::SLLIW:
+        case Opcode::SRLIW:
+        case Opcode::SRAIW:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Emits one op; returns false if it has no native encoding
+    bool emitNative(Emitter &e, const TranslatedOp &t, int opPC, bool xlen64)
+    {
+        const PackedInstruction &inst = t.inst;
+        const int64_t imm = inst.imm;
+        const uint8_t shiftMask = xlen64 ? 0x3F : 0x1F;
+
+        // rax = rs1, rcx = rs2
+        auto rr = [&]()
+        {
+            e.loadGuest(RAX, inst.rs1);
+            e.loadGuest(RCX, inst.rs2);
+        };
+        auto shiftCount = [&](uint8_t mask)
+        { e.bytes({0x83, 0xE1, mask}); }; // and ecx, mask
+        auto ri = [&](uint8_t opcode)      // rax = rs1 <op> simm32
+        {
+            e.loadGuest(RAX, inst.rs1);
+            e.bytes({0x48, opcode});
+            e.imm32(static_cast<int32_t>(imm));
+        };
+        auto shiftImm = [&](bool wide, uint8_t ext, uint8_t count) // shl/shr/sar rax|eax, count
+        {
+            e.loadGuest(RAX, inst.rs1);
+            if (wide)
+                e.bytes({0x48});
+            e.bytes({0xC1, ext, count});
+        };
+
+        switch (inst.op)
+        {
+        case Opcode::ADD:
+        case Opcode::ADDW:
+            rr();
+            e.bytes({0x48, 0x01, 0xC8}); // add rax, rcx
+            break;
+        case Opcode::SUB:
+        case Opcode::SUBW:
+            rr();
+            e.bytes({0x48, 0x29, 0xC8}); // sub rax, rcx
+            break;
+        case Opcode::AND:
+            rr();
+            e.bytes({0x48, 0x21, 0xC8});
+            break;
+        case Opcode::OR:
+            rr();
+            e.bytes({0x48, 0x09, 0xC8});
+            break;
+        case Opcode::XOR:
+            rr();
+            e.bytes({0x48, 0x31, 0xC8});
+            break;
+        case Opcode::MUL:
+        case Opcode::MULW:
+            rr();
+            e.bytes({0x48, 0x0F, 0xAF, 0xC1}); // imul rax, rcx
+            break;
+        case Opcode::SLL:
+            rr();
+            shiftCount(shiftMask);
+            e.bytes({0x48, 0xD3, 0xE0}); // shl rax, cl
+            break;
+        case Opcode::SLLW:
+            rr();
+            shiftCount(0x1F);
+            e.bytes({0x48, 0xD3, 0xE0});
+            break;
+        case Opcode::SRL:
+            rr();
+            shiftCount(shiftMask);
+            if (xlen64)
+                e.bytes({0x48, 0xD3, 0xE8}); // shr rax, cl
+            else
+                e.bytes({0x48, 0xD3, 0xF8}); // sar rax, cl: the RV32 interpreter shifts the signed value
+            break;
+        case Opcode::SRLW:
+            rr();
+            shiftCount(0x1F);
+            e.bytes({0xD3, 0xE8}); // shr eax, cl
+            break;
+        case Opcode::SRA:
+            rr();
+            shiftCount(shiftMask);
+            if (xlen64)
+                e.bytes({0x48, 0xD3, 0xF8}); // sar rax, cl
+            else
+                e.bytes({0xD3, 0xF8}); // sar eax, cl
+            break;
+        case Opcode::SRAW:
+            rr();
+            shiftCount(0x1F);
+            e.bytes({0xD3, 0xF8});
+            break;
+
+        case Opcode::ADDI:
+            ri(0x05); // add rax, imm32
+            break;
+        case Opcode::ANDI:
+            ri(0x25);
+            break;
+        case Opcode::ORI:
+            ri(0x0D);
+            break;
+        case Opcode::XORI:
+            ri(0x35);
+            break;
+        case Opcode::ADDIW:
+        {
+            int64_t simm = (int64_t)((int32_t)(imm << 20) >> 20);
+            e.loadGuest(RAX, inst.rs1);
+            e.bytes({0x48, 0x05});
+            e.imm32(static_cast<int32_t>(simm));
+            break;
+        }
+        case Opcode::SLLI:
+            shiftImm(true, 0xE0, imm & 0x3F);
+            break;
+        case Opcode::SLLIW:
+            shiftImm(false, 0xE0, imm & 0x1F);
+            break;
+        case Opcode::SRLI:
+            shiftImm(xlen64, 0xE8, imm & shiftMask);
+            break;
+        case Opcode::SRLIW:
+            shiftImm(false, 0xE8, imm & 0x1F);
+            break;
+        case Opcode::SRAI:
+            shiftImm(xlen64, 0xF8, imm & shiftMask);
+            break;
+        case Opcode::SRAIW:
+            shiftImm(false, 0xF8, imm & 0x1F);
+            break;
+
+        case Opcode::LUI:
+            if (inst.rd != 0)
+                e.storeGuestImm(inst.rd, static_cast<int32_t>(imm << 12));
+            return true;
+        case Opcode::AUIPC:
+            if (inst.rd != 0)
+                e.storeGuestImm(inst.rd, static_cast<int32_t>(opPC + (imm << 12)));
+            return true;
+
+        case Opcode::LB:
+        case Opcode::LH:
+        case Opcode::LW:
+        case Opcode::LD:
+        case Opcode::LBU:
+        case Opcode::LHU:
+        case Opcode::LWU:
+            // rsi = rs1 + imm, edx = op, ecx = pc; the load happens even for rd = x0
+            ri(0x05);
+            e.bytes({0x48, 0x89, 0xC6}); // mov rsi, rax
+            e.bytes({0xBA});       // mov edx, op
+            e.imm32(static_cast<int32_t>(inst.op));
+            e.bytes({0xB9});       // mov ecx, pc
+            e.imm32(opPC);
+            e.callback(offsetof(JitContext, load));
+            break;
+
+        case Opcode::SB:
+        case Opcode::SH:
+        case Opcode::SW:
+        case Opcode::SD:
+            ri(0x05);
+            e.bytes({0x48, 0x89, 0xC6}); // mov rsi, rax
+            e.loadGuest(RCX, inst.rs2);
+            e.bytes({0xBA});
+            e.imm32(static_cast<int32_t>(inst.op));
+            e.bytes({0x41, 0xB8}); // mov r8d, pc
+            e.imm32(opPC);
+            e.callback(offsetof(JitContext, store));
+            return true;
+
+        default:
+            return false;
+        }
+
+        e.writeBack(inst.rd, !xlen64 || isWordOp(inst.op));
+        return true;
+    }
+
+    void emitInterpreterCall(Emitter &e, const TranslatedOp &t)
+    {
+        e.bytes({0x48, 0xBE}); // mov rsi, imm64
+        e.imm64(reinterpret_cast<uint64_t>(&t));
+        e.callback(offsetof(JitContext, interpret));
+    }
+
+    static_assert(offsetof(JitContext, regs) == 0, "prologue loads regs from [rbx]");
+    static_assert(offsetof(JitContext, interpret) < 128, "callbacks are addressed with disp8");
+#endif
+}
+
+JitCompiler::JitCompiler(bool xlen64) : xlen64(xlen64)
+{
+#ifdef RISCV_JIT_X86_64
+    void *mem = mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED)
+    {
+        arena = static_cast<uint8_t *>(mem);
+        arenaSize = ARENA_SIZE;
+    }
+#endif
+}
+
+JitCompiler::~JitCompiler()
+{
+#ifdef RISCV_JIT_X86_64
+    if (arena)
+        munmap(arena, arenaSize);
+#endif
+}
+
+bool JitCompiler::isSupported()
+{
+#ifdef RISCV_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool JitCompiler::compile(BasicBlock &block)
+{
+#ifdef RISCV_JIT_X86_64
+    int bodyOps = (int)block.ops.size();
+    if (bodyOps > 0 && TranslationCache::endsBlock(block.ops.back().inst.op))
+        --bodyOps;
+    if (!arena || bodyOps == 0)
+    {
+        block.jitRejected = true;
+        return false;
+    }
+
+    Emitter e;
+    e.bytes({0x53});                   // push rbx
+    e.bytes({0x41, 0x54});             // push r12
+    e.bytes({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8 (keep the stack 16-byte aligned for calls)
+    e.bytes({0x48, 0x89, 0xFB});       // mov rbx, rdi
+    e.bytes({0x4C, 0x8B, 0x23});       // mov r12, [rbx]
+
+    for (int i = 0; i < bodyOps; ++i)
+    {
+        const TranslatedOp &t = block.ops[i];
+        if (!emitNative(e, t, block.startPC + 4 * i, xlen64))
+            emitInterpreterCall(e, t);
+    }
+
+    e.bytes({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+    e.bytes({0x41, 0x5C});             // pop r12
+    e.bytes({0x5B});                   // pop rbx
+    e.bytes({0xC3});                   // ret
+
+    if (arenaUsed + e.code.size() > arenaSize)
+    {
+        block.jitRejected = true;
+        return false;
+    }
+    uint8_t *dest = arena + arenaUsed;
+    std::memcpy(dest, e.code.data(), e.code.size());
+    arenaUsed += (e.code.size() + 15) & ~size_t(15);
+
+    block.jitCode = reinterpret_cast<void (*)(JitContext *)>(dest);
+    block.jitOps = bodyOps;
+    ++compiledBlocks;
+    return true;
+#else
+    block.jitRejected = true;
+    return false;
+#endif
+}
+
+void JitCompiler::reset()
+{
+    arenaUsed = 0;
+    compiledBlocks = 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * @class JitCompiler
+ * @brief Compiles hot basic blocks to native x86-64 code (Linux only).
+ *
+ * The Simulator counts how often each basic block runs. Once a block reaches the hot threshold,
+ * its body is compiled into an mmap'd executable arena, and later executions call the native
+ * code instead of interpreting the ops one by one.
+ *
+ * What gets compiled:
+ * - Every op of the block except a final branch/jal/jalr/ecall/ebreak; that terminator is
+ *   still executed by the interpreter, so control flow and the call stack behave as before.
+ * - ALU and immediate ops, lui and auipc are emitted inline. In RV32 modes every result is
+ *   truncated to 32 bits and sign-extended, exactly as Simulator::setRegValue() does; in RV64
+ *   modes only the *W ops are, and shifts use 6-bit counts.
+ * - Loads and stores call back into the Simulator (readMemory/writeMemory), so memory and
+ *   cache simulation stay exact.
+ * - Anything else (mulh, div, rem, ...) calls back into the interpreter's execute().
+ *
+ * Guest registers stay in the Simulator's register file, reached through JitContext::regs.
+ * Compiled blocks do not print the per-instruction trace.
+ *
+ * On other platforms (and in the WebAssembly build) isSupported() is false and compile()
+ * always rejects the block, so the interpreter is used.
+ */
+#ifndef JIT_COMPILER_H
+#define JIT_COMPILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "TranslationCache.h"
+
+#if defined(__x86_64__) && defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define RISCV_JIT_X86_64 1
+#endif
+
+struct JitContext
+{
+    int64_t *regs; // guest register file x0..x31
+    void *owner;   // passed back as the first argument of every callback
+    // returns the value the load writes to rd (before truncation); pc is the load's own address
+    int64_t (*load)(void *owner, uint64_t addr, uint32_t op, uint32_t pc);
+    void (*store)(void *owner, uint64_t addr, uint32_t op, int64_t value, uint32_t pc);
+    // executes one op the compiler has no native encoding for
+    void (*interpret)(void *owner, const TranslatedOp *op);
+};
+
+class JitCompiler
+{
+public:
+    // blocks run this many times by the interpreter before they are compiled
+    static constexpr uint32_t DEFAULT_HOT_THRESHOLD = 16;
+
+    // xlen64: generate code for the RV64 register width (see Simulator::setRegValue)
+    explicit JitCompiler(bool xlen64 = false);
+    ~JitCompiler();
+    JitCompiler(const JitCompiler &) = delete;
+    JitCompiler &operator=(const JitCompiler &) = delete;
+
+    static bool isSupported();
+
+    // Compiles the body of block into the arena and sets block.jitCode and block.jitOps.
+    // Sets block.jitRejected instead if there is nothing to compile or the arena is full.
+    bool compile(BasicBlock &block);
+
+    // Forgets all compiled code; only call once no block refers to it any more
+    void reset();
+
+    size_t getCompiledBlockCount() const { return compiledBlocks; }
+
+private:
+    bool xlen64;
+    uint8_t *arena = nullptr;
+    size_t arenaSize = 0;
+    size_t arenaUsed = 0;
+    size_t compiledBlocks = 0;
+};
+
+#endif // JIT_COMPILER_H
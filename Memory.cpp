@@ -5,68 +5,470 @@
  *
  * This file provides the implementation for the Memory class, which allows for
  * reading, writing, clearing, and printing memory contents. The memory is modeled
- * as a byte-addressable storage, supporting different data sizes (Byte, HalfWord, Word)
+ * as a byte-addressable storage, supporting different data sizes (Byte, HalfWord, Word, DoubleWord)
  * and both signed and unsigned accesses.
  *
+ * Values are moved with memcpy, so the host must be little-endian like RISC-V (x86-64,
+ * AArch64 and WebAssembly all are).
+ *
  * Functions:
  * - void Memory::clear()
  *      Clears all memory contents.
  *
- * - int32_t Memory::read(uint32_t address, MemSize size, bool isUnsigned) const
+ * - int64_t Memory::read(uint64_t address, MemSize size, bool isUnsigned) const
  *      Reads a value from memory at the specified address and size.
  *      Supports sign-extension for signed accesses.
  *
- * - void Memory::write(uint32_t address, MemSize size, uint32_t value)
+ * - void Memory::write(uint64_t address, MemSize size, uint64_t value)
  *      Writes a value to memory at the specified address and size.
  *
- * - void Memory::print(uint32_t startAddress, uint32_t count) const
+ * - void Memory::print(uint64_t startAddress, uint32_t count) const
  *      Prints the contents of memory starting from a given address for a specified count.
+ *
+ * - bool Memory::mapFile(const std::string &path, uint32_t guestAddress, MapMode mode)
+ *      Maps a host file into the guest address space with mmap.
+ *
+ * - std::shared_ptr<const Memory::Snapshot> Memory::snapshot() / void Memory::restore(const Snapshot&)
+ *      Takes or restores a copy-on-write snapshot that shares pages instead of copying them.
+ *
+ * - uint64_t Memory::nextEpoch() / getDirtyRangesSince(uint64_t since, bool &replaced) const
+ *      Dirty-page tracking: starts an epoch, or lists the pages written since one.
+ *
+ * - void Memory::saveState(CheckpointWriter&) const / bool Memory::loadState(CheckpointReader&)
+ *      Saves or restores all memory contents for a checkpoint.
  */
 #include "Memory.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MEMORY_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Memory copies values with memcpy and needs a little-endian host"
+#endif
 
 void Memory::clear()
 {
-    memory.clear();
+    for (auto &table : directory) {
+        table.reset();
+    }
+    pageCount = 0;
+    ignoredWrites = 0;
+    // files are unmapped once no snapshot refers to them either
+    mappings.clear();
+    dirtyPages.clear();
+    replacedEpoch = epoch;
+}
+
+void Memory::enableDirtyTracking()
+{
+    if (dirtyTracking) {
+        return;
+    }
+    dirtyTracking = true;
+    epoch = 1;
+    replacedEpoch = 0;
+    // every page written so far counts as written in epoch 1
+    for (uint32_t t = 0; t < directory.size(); ++t) {
+        PageTable *table = directory[t].get();
+        if (!table) {
+            continue;
+        }
+        for (uint32_t p = 0; p < table->data.size(); ++p) {
+            if (table->data[p]) {
+                markDirty(*table, (t << TABLE_BITS) | p);
+            }
+        }
+    }
 }
 
-int32_t Memory::read(uint32_t address, MemSize size, bool isUnsigned) const {
+void Memory::markDirty(PageTable &table, uint32_t pageNumber)
+{
+    table.writeEpoch[pageNumber & ((1u << TABLE_BITS) - 1)] = epoch;
+    dirtyPages.push_back(pageNumber);
+}
 
-    int sz = static_cast<int>(size);
-    uint32_t val = 0;
-    for (int i = 0; i < sz; ++i) {
-        val |= (static_cast<uint32_t>(static_cast<uint8_t>(getByte(address + i))) << (8 * i));
+uint64_t Memory::nextEpoch()
+{
+    if (!dirtyTracking) {
+        return epoch;
     }
+    for (uint32_t pageNumber : dirtyPages) {
+        PageTable *table = directory[pageNumber >> TABLE_BITS].get();
+        uint32_t index = pageNumber & ((1u << TABLE_BITS) - 1);
+        if (table && table->data[index] && !(table->flags[index] & PAGE_READ_ONLY)) {
+            table->flags[index] |= PAGE_CLEAN;
+        }
+    }
+    dirtyPages.clear();
+    return ++epoch;
+}
 
-    // Sign-extend for smaller sizes if needed
-    if (!isUnsigned) {
-        if (size == MemSize::HalfWord) {
-            return static_cast<int16_t>(val);
+std::vector<std::pair<uint32_t, uint32_t>> Memory::getDirtyRangesSince(uint64_t since, bool &replaced) const
+{
+    replaced = since <= replacedEpoch;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    for (uint32_t t = 0; t < directory.size(); ++t) {
+        const PageTable *table = directory[t].get();
+        if (!table) {
+            continue;
         }
-        if (size == MemSize::Byte) {
-            return static_cast<int8_t>(val);
+        for (uint32_t p = 0; p < table->data.size(); ++p) {
+            if (!table->data[p] || table->writeEpoch[p] < since) {
+                continue;
+            }
+            uint32_t address = ((t << TABLE_BITS) | p) << PAGE_BITS;
+            if (!ranges.empty() && ranges.back().first + ranges.back().second == address) {
+                ranges.back().second += PAGE_SIZE;
+            } else {
+                ranges.push_back({address, PAGE_SIZE});
+            }
         }
     }
+    return ranges;
+}
 
-    return val;
+uint8_t *Memory::touchPage(uint64_t address) {
+    std::unique_ptr<PageTable> &table = directory[tableIndex(address)];
+    if (!table) {
+        table = std::make_unique<PageTable>();
+    }
+    uint32_t index = pageIndex(address);
+    uint8_t &flags = table->flags[index];
+    if (flags & PAGE_CLEAN) {
+        flags &= ~PAGE_CLEAN;
+        markDirty(*table, static_cast<uint32_t>(address >> PAGE_BITS));
+    }
+    if (flags & PAGE_READ_ONLY) {
+        if (ignoredWrites++ == 0) {
+            out << "Warning: store to read-only mapped memory at 0x" << std::hex << static_cast<uint32_t>(address)
+                << std::dec << " ignored\n";
+        }
+        return nullptr;
+    }
+    if (flags & PAGE_SHARED) {
+        flags &= ~PAGE_SHARED;
+        std::shared_ptr<Page> &owned = table->owned[index];
+        if (owned && owned.use_count() == 1) {
+            // every snapshot that shared the page is gone; pairs with the release in the
+            // other owners' reference count decrements
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return table->data[index];
+        }
+        std::shared_ptr<Page> copy = std::make_shared<Page>();
+        std::memcpy(copy->bytes, table->data[index], PAGE_SIZE);
+        if (!owned) {
+            // a PRIVATE mapped page moves to the heap; PAGE_WRITTEN keeps it in checkpoints
+            // even if the copy is all zeros
+            flags = PAGE_WRITTEN;
+            ++pageCount;
+        }
+        owned = std::move(copy);
+        table->data[index] = owned->bytes;
+        return table->data[index];
+    }
+    if (flags & PAGE_MAPPED) {
+        flags |= PAGE_WRITTEN;
+    } else if (!table->data[index]) {
+        table->owned[index] = std::make_shared<Page>();
+        std::memset(table->owned[index]->bytes, 0, PAGE_SIZE);
+        table->data[index] = table->owned[index]->bytes;
+        ++pageCount;
+        if (dirtyTracking) {
+            markDirty(*table, static_cast<uint32_t>(address >> PAGE_BITS));
+        }
+    }
+    return table->data[index];
 }
 
-void Memory::write(uint32_t address,  MemSize size, uint32_t value) {
-    
+bool Memory::mapFile(const std::string &path, uint32_t guestAddress, MapMode mode) {
+#ifdef MEMORY_HAS_MMAP
+    if (guestAddress & (PAGE_SIZE - 1)) {
+        out << "Error: mapping address 0x" << std::hex << guestAddress << std::dec << " is not 4 KiB aligned\n";
+        return false;
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        out << "Error: Could not open " << path << " for mapping\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        out << "Error: " << path << " is empty or not a regular file\n";
+        close(fd);
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    uint64_t pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint64_t end = guestAddress + pages * PAGE_SIZE;
+    if (end > (uint64_t(1) << 32)) {
+        out << "Error: " << path << " does not fit below 4 GiB at 0x" << std::hex << guestAddress << std::dec << "\n";
+        close(fd);
+        return false;
+    }
+    for (const Mapping &other : mappings) {
+        uint64_t otherEnd = other.guestAddress + (other.size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+        if (guestAddress < otherEnd && other.guestAddress < end) {
+            out << "Error: " << path << " overlaps the mapping of " << other.path << "\n";
+            close(fd);
+            return false;
+        }
+    }
 
-    int sz = static_cast<int>(size);
-    for (int i = 0; i < sz; ++i) {
-        memory[address + i] = static_cast<int8_t>((value >> (8 * i)) & 0xFF);
+    int prot = mode == MapMode::PRIVATE ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *region = mmap(nullptr, size, prot, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED) {
+        out << "Error: mmap of " << path << " failed\n";
+        return false;
     }
+
+    Mapping mapping;
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    mapping.path = ec ? path : absolute.string();
+    mapping.guestAddress = guestAddress;
+    mapping.size = size;
+    mapping.mode = mode;
+    mapping.host = std::shared_ptr<uint8_t>(static_cast<uint8_t *>(region),
+                                            [size](uint8_t *host) { munmap(host, size); });
+
+    // the mapping replaces whatever the guest had stored in the range
+    uint8_t flags = PAGE_MAPPED | (mode == MapMode::READ_ONLY ? PAGE_READ_ONLY : 0);
+    for (uint64_t i = 0; i < pages; ++i) {
+        uint64_t address = guestAddress + i * PAGE_SIZE;
+        std::unique_ptr<PageTable> &table = directory[tableIndex(address)];
+        if (!table) {
+            table = std::make_unique<PageTable>();
+        }
+        uint32_t index = pageIndex(address);
+        if (table->owned[index]) {
+            table->owned[index].reset();
+            --pageCount;
+        }
+        table->data[index] = mapping.host.get() + i * PAGE_SIZE;
+        table->flags[index] = flags;
+        if (dirtyTracking) {
+            markDirty(*table, static_cast<uint32_t>(address >> PAGE_BITS));
+        }
+    }
+    mappings.push_back(mapping);
+    return true;
+#else
+    (void)guestAddress;
+    (void)mode;
+    out << "Error: Could not map " << path << ": file mapping is not supported on this host\n";
+    return false;
+#endif
 }
 
-void Memory::print(uint32_t startAddress, uint32_t count) const {
-    for (uint32_t i = 0; i < count; ++i) {
-        uint32_t addr = startAddress + i * static_cast<int>(MemSize::Word);
-        uint32_t val = 0;
-        for (int j = 0; j < static_cast<int>(MemSize::Word); ++j) {
-            val |= (static_cast<uint32_t>(static_cast<uint8_t>(getByte(addr + j))) << (8 * j));
+size_t Memory::getMappedPageCount() const {
+    size_t pages = 0;
+    for (const Mapping &mapping : mappings) {
+        pages += (mapping.size + PAGE_SIZE - 1) / PAGE_SIZE;
+    }
+    return pages;
+}
+
+int64_t Memory::read(uint64_t address, MemSize size, bool isUnsigned) const {
+    switch (size) {
+    case MemSize::Byte: {
+        uint8_t val = load<uint8_t>(address);
+        return isUnsigned ? static_cast<int64_t>(val) : static_cast<int8_t>(val);
+    }
+    case MemSize::HalfWord: {
+        uint16_t val = load<uint16_t>(address);
+        return isUnsigned ? static_cast<int64_t>(val) : static_cast<int16_t>(val);
+    }
+    case MemSize::Word: {
+        uint32_t val = load<uint32_t>(address);
+        return isUnsigned ? static_cast<int64_t>(val) : static_cast<int32_t>(val);
+    }
+    case MemSize::DoubleWord:
+        return static_cast<int64_t>(load<uint64_t>(address));
+    }
+    return 0;
+}
+
+void Memory::write(uint64_t address,  MemSize size, uint64_t value) {
+    switch (size) {
+    case MemSize::Byte:
+        store<uint8_t>(address, static_cast<uint8_t>(value));
+        break;
+    case MemSize::HalfWord:
+        store<uint16_t>(address, static_cast<uint16_t>(value));
+        break;
+    case MemSize::Word:
+        store<uint32_t>(address, static_cast<uint32_t>(value));
+        break;
+    case MemSize::DoubleWord:
+        store<uint64_t>(address, value);
+        break;
+    }
+}
+
+void Memory::readBytes(uint64_t address, uint8_t *dest, size_t length) const {
+    while (length > 0) {
+        uint32_t offset = address & (PAGE_SIZE - 1);
+        size_t chunk = std::min<size_t>(length, PAGE_SIZE - offset);
+        if (const uint8_t *page = findPage(address)) {
+            std::memcpy(dest, page + offset, chunk);
+        } else {
+            std::memset(dest, 0, chunk);
         }
+        address += chunk;
+        dest += chunk;
+        length -= chunk;
+    }
+}
+
+void Memory::writeBytes(uint64_t address, const uint8_t *src, size_t length) {
+    while (length > 0) {
+        uint32_t offset = address & (PAGE_SIZE - 1);
+        size_t chunk = std::min<size_t>(length, PAGE_SIZE - offset);
+        if (uint8_t *page = writablePage(address)) {
+            std::memcpy(page + offset, src, chunk);
+        }
+        address += chunk;
+        src += chunk;
+        length -= chunk;
+    }
+}
+
+void Memory::print(uint64_t startAddress, uint32_t count) const {
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t addr = static_cast<uint32_t>(startAddress + i * static_cast<int>(MemSize::Word));
+        uint32_t val = load<uint32_t>(addr);
         out << "Memory[0x" << std::hex << addr << "] = 0x" << val << std::dec << "\n";
     }
 }
+
+std::shared_ptr<const Memory::Snapshot> Memory::snapshot() {
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->mappings = mappings;
+    snapshot->pages.reserve(pageCount + getMappedPageCount());
+    for (uint32_t t = 0; t < directory.size(); ++t) {
+        PageTable *table = directory[t].get();
+        if (!table) {
+            continue;
+        }
+        for (uint32_t p = 0; p < table->data.size(); ++p) {
+            if (!table->data[p]) {
+                continue;
+            }
+            // read-only pages are never stored to, so they need no copy-on-write
+            if (!(table->flags[p] & PAGE_READ_ONLY)) {
+                table->flags[p] |= PAGE_SHARED;
+            }
+            uint8_t flags = table->flags[p] & ~PAGE_CLEAN;
+            snapshot->pages.push_back({(t << TABLE_BITS) | p, table->data[p], table->owned[p], flags});
+        }
+    }
+    return snapshot;
+}
+
+void Memory::restore(const Snapshot &snapshot) {
+    clear();
+    mappings = snapshot.mappings;
+    for (const Snapshot::Entry &entry : snapshot.pages) {
+        std::unique_ptr<PageTable> &table = directory[entry.pageNumber >> TABLE_BITS];
+        if (!table) {
+            table = std::make_unique<PageTable>();
+        }
+        uint32_t index = entry.pageNumber & ((1u << TABLE_BITS) - 1);
+        table->data[index] = entry.data;
+        table->owned[index] = entry.owned;
+        table->flags[index] = entry.flags;
+        if (entry.owned) {
+            ++pageCount;
+        }
+        if (dirtyTracking) {
+            markDirty(*table, entry.pageNumber);
+        }
+    }
+}
+
+void Memory::saveState(CheckpointWriter &writer) const {
+    // mapped files are referenced, not copied
+    writer.writeU32(static_cast<uint32_t>(mappings.size()));
+    for (const Mapping &mapping : mappings) {
+        writer.writeString(mapping.path);
+        writer.writeU32(mapping.guestAddress);
+        writer.writeU64(mapping.size);
+        writer.writeU8(static_cast<uint8_t>(mapping.mode));
+    }
+
+    // one run per heap page, skipping pages that only hold zeros (they read the same when
+    // absent), and one per PRIVATE mapped page the guest has written
+    std::vector<uint32_t> pageAddresses;
+    for (uint32_t t = 0; t < directory.size(); ++t) {
+        const PageTable *table = directory[t].get();
+        if (!table) {
+            continue;
+        }
+        for (uint32_t p = 0; p < table->data.size(); ++p) {
+            const uint8_t *page = table->data[p];
+            bool save = (table->flags[p] & PAGE_WRITTEN) ||
+                        (table->owned[p] &&
+                         std::any_of(page, page + PAGE_SIZE, [](uint8_t b) { return b != 0; }));
+            if (save) {
+                pageAddresses.push_back(((t << TABLE_BITS) | p) << PAGE_BITS);
+            }
+        }
+    }
+
+    writer.writeU32(static_cast<uint32_t>(pageAddresses.size()));
+    for (uint32_t address : pageAddresses) {
+        writer.writeU32(address);
+        writer.writeU32(PAGE_SIZE);
+        writer.writeBytes(findPage(address), PAGE_SIZE);
+    }
+}
+
+bool Memory::loadState(CheckpointReader &reader) {
+    clear();
+    uint32_t mappingCount = reader.readU32();
+    for (uint32_t m = 0; m < mappingCount && reader.isGood(); ++m) {
+        std::string path = reader.readString();
+        uint32_t guestAddress = reader.readU32();
+        uint64_t size = reader.readU64();
+        MapMode mode = reader.readU8() == static_cast<uint8_t>(MapMode::PRIVATE) ? MapMode::PRIVATE : MapMode::READ_ONLY;
+        if (!reader.isGood() || !mapFile(path, guestAddress, mode)) {
+            return false;
+        }
+        if (mappings.back().size != size) {
+            out << "Error: mapped file " << path << " changed size since the checkpoint was saved\n";
+            return false;
+        }
+    }
+
+    uint32_t runCount = reader.readU32();
+    std::vector<uint8_t> skipped;
+    for (uint32_t r = 0; r < runCount && reader.isGood(); ++r) {
+        uint32_t start = reader.readU32();
+        uint32_t length = reader.readU32();
+        while (length > 0 && reader.isGood()) {
+            uint32_t offset = start & (PAGE_SIZE - 1);
+            uint32_t chunk = std::min(length, PAGE_SIZE - offset);
+            if (uint8_t *page = touchPage(start)) {
+                reader.readBytes(page + offset, chunk);
+            } else {
+                skipped.resize(chunk);
+                reader.readBytes(skipped.data(), chunk);
+            }
+            start += chunk;
+            length -= chunk;
+        }
+    }
+    return reader.isGood();
+}
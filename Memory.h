@@ -2,32 +2,78 @@
  * @class Memory
  * @brief An abstraction for byte-addressable memory storage.
  *
- * This class simulates a simple memory model using an unordered map to store bytes at specific addresses.
- * It provides methods to write and read values of various sizes (1, 2, or 4 bytes) to and from memory,
+ * This class simulates a sparse 32-bit address space with a two-level page table of 4 KiB pages.
+ * It provides methods to write and read values of various sizes (1, 2, 4 or 8 bytes) to and from memory,
  * supporting both signed and unsigned access. The class also allows dumping memory contents for debugging
  * and resetting the memory state.
  *
  * The abstraction hides the underlying storage mechanism, allowing users to interact with memory
  * conceptually (by address and size) without needing to manage the details of byte storage or address mapping.
  *
+ * Storage:
+ * - address bits 31..22 index the directory, bits 21..12 a page table, bits 11..0 the page.
+ * - Page tables and pages are allocated on the first write that touches them. Reads of
+ *   untouched memory return zero and allocate nothing.
+ * - An access that stays inside one page is a single lookup and a memcpy; only accesses that
+ *   straddle two pages go byte by byte.
+ * - Addresses are 64-bit in the interface; the simulated memory is 4 GiB, so only the low
+ *   32 bits select a byte (higher bits wrap, as a 32-bit address would).
+ *
+ * load<T>() and store<T>() access exactly sizeof(T) bytes with no size dispatch; read() and
+ * write() take a MemSize and forward to them.
+ *
+ * File mappings (mapFile):
+ * - A host file can be mmap'd into a page-aligned guest range. Its page table entries point
+ *   straight into the mapping, so loads read the host page cache and nothing is copied.
+ * - READ_ONLY maps the file read-only; guest stores to it are ignored (the first one prints
+ *   a warning). PRIVATE maps it copy-on-write: stores change only the guest's copy.
+ * - Bytes past the end of the file, up to the end of its last 4 KiB page, read as zero.
+ * - clear() unmaps every file along with the rest of memory.
+ * - Checkpoints record each mapping (path, address, size, mode) instead of its contents,
+ *   plus the pages the guest wrote in PRIVATE mappings; loading remaps the files.
+ * - Only available on POSIX hosts.
+ *
+ * Snapshots (snapshot/restore):
+ * - snapshot() returns an immutable Snapshot that shares every page with this Memory: it
+ *   copies one pointer per page and no page contents.
+ * - Both sides mark shared pages PAGE_SHARED. The first store to such a page copies it
+ *   (unless nothing else holds it any more), so each Memory sees only its own writes.
+ * - restore() fills a Memory from a Snapshot the same way, so any number of Memories can
+ *   diverge from one Snapshot, on different threads. Mapped files stay mapped as long as a
+ *   Memory or Snapshot uses them.
+ *
+ * Dirty-page tracking (enableDirtyTracking, for front ends that redraw memory):
+ * - Time is split into epochs; nextEpoch() starts a new one. Each page remembers the last
+ *   epoch it was written in, and getDirtyRangesSince(e) lists the pages written since e.
+ * - Pages not yet written in the current epoch carry PAGE_CLEAN, so their first store goes
+ *   through touchPage(), which records the page. Later stores in the same epoch take the
+ *   normal fast path, and nextEpoch() re-arms only the pages that were written.
+ * - clear(), restore() and loadState() replace memory wholesale; removed pages cannot be
+ *   listed, so getDirtyRangesSince() reports that instead.
  */
 // E.g : Write 4-byte integer 0x12345678 to address 0x1000
-// writeMemory(0x1000, 0x12345678, 4);
-//      Internally stores:
-//          memory[0x1000] = 0x78;
-//          memory[0x1001] = 0x56;
-//          memory[0x1002] = 0x34;
-//          memory[0x1003] = 0x12;
+// writeMemory(0x1000, MemSize::Word, 0x12345678);
+//      Internally stores (little-endian) in page 0x1, offset 0x000:
+//          byte 0x1000 = 0x78;
+//          byte 0x1001 = 0x56;
+//          byte 0x1002 = 0x34;
+//          byte 0x1003 = 0x12;
 // Read back:
-//      readMemory(0x1000, 4, false) => reconstructs 0x12345678
-//      Read val of given size (1, 2, or 4). isUnsigned determines sign-extension
+//      readMemory(0x1000, MemSize::Word, false) => reconstructs 0x12345678
+//      Read val of given size (1, 2, 4 or 8). isUnsigned determines sign-extension
 
 #ifndef MEMORY_H
 #define MEMORY_H
 
-#include <unordered_map>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Checkpoint.h"
 
 enum class MemSize : int
 {
@@ -40,28 +86,221 @@ enum class MemSize : int
 class Memory
 {
 public:
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+    static constexpr uint32_t TABLE_BITS = 10; // page table entries per level
+
+    enum class MapMode
+    {
+        READ_ONLY, // guest stores are ignored
+        PRIVATE    // copy-on-write; the file is never modified
+    };
+
+    class Snapshot;
+
     Memory(std::ostream &out = std::cout) : out(out) {}
+    // the contents of snapshot, shared copy-on-write
+    Memory(const Snapshot &snapshot, std::ostream &out = std::cout) : out(out)
+    {
+        restore(snapshot);
+    }
+    Memory(const Memory &) = delete;
+    Memory &operator=(const Memory &) = delete;
+
+    // Reads `size` bytes, sign- or zero-extended to 64 bits
+    int64_t read(uint64_t address, MemSize size, bool isUnsigned = false) const;
+    // Writes the low `size` bytes of value
+    void write(uint64_t address, MemSize size, uint64_t value);
+
+    // Fixed-width little-endian access; T is one of uint8_t, uint16_t, uint32_t, uint64_t
+    template <typename T>
+    T load(uint64_t address) const
+    {
+        static_assert(std::is_unsigned<T>::value, "load<T> takes an unsigned width");
+        uint32_t offset = address & (PAGE_SIZE - 1);
+        T value = 0;
+        if (offset + sizeof(T) <= PAGE_SIZE)
+        {
+            if (const uint8_t *page = findPage(address))
+                std::memcpy(&value, page + offset, sizeof(T));
+            return value;
+        }
+        for (uint32_t i = 0; i < sizeof(T); ++i)
+            value |= static_cast<T>(static_cast<T>(getByte(address + i)) << (8 * i));
+        return value;
+    }
 
-    int read(uint32_t address, MemSize size, bool isUnsigned = false) const;
-    void write(uint32_t address, MemSize size, uint32_t value);
+    template <typename T>
+    void store(uint64_t address, T value)
+    {
+        static_assert(std::is_unsigned<T>::value, "store<T> takes an unsigned width");
+        uint32_t offset = address & (PAGE_SIZE - 1);
+        if (offset + sizeof(T) <= PAGE_SIZE)
+        {
+            if (uint8_t *page = writablePage(address))
+                std::memcpy(page + offset, &value, sizeof(T));
+            return;
+        }
+        for (uint32_t i = 0; i < sizeof(T); ++i)
+            setByte(address + i, static_cast<uint8_t>(value >> (8 * i)));
+    }
 
-    void print(uint32_t startAddress, uint32_t count) const;
+    // copies length bytes starting at address; untouched memory reads as zero
+    void readBytes(uint64_t address, uint8_t *dest, size_t length) const;
+    // stores length bytes at address, one memcpy per page touched
+    void writeBytes(uint64_t address, const uint8_t *src, size_t length);
+
+    void print(uint64_t startAddress, uint32_t count) const;
     void clear();
 
-    // simple byte-addressable memory storage
-    std::unordered_map<uint32_t, int8_t> memory;
+    // Maps the host file at path into [guestAddress, guestAddress + file size). The address
+    // must be 4 KiB aligned and the range must not overlap another mapping; memory already
+    // written there is replaced. Prints an error and returns false on failure.
+    bool mapFile(const std::string &path, uint32_t guestAddress, MapMode mode = MapMode::READ_ONLY);
+
+    // Copy-on-write snapshot of the whole memory; costs one pointer copy per page
+    std::shared_ptr<const Snapshot> snapshot();
+    // Replaces the contents with those of snapshot, sharing its pages until they are written
+    void restore(const Snapshot &snapshot);
+
+    // Dirty-page tracking; stays on across clear()
+    void enableDirtyTracking();
+    bool isDirtyTracking() const
+    {
+        return dirtyTracking;
+    }
+    uint64_t getEpoch() const
+    {
+        return epoch;
+    }
+    // Starts a new epoch and returns its number
+    uint64_t nextEpoch();
+    // Page-aligned [address, address + length) ranges written in epoch `since` or later, adjacent
+    // pages merged, in address order. replaced is set if memory was replaced wholesale (cleared,
+    // restored or loaded from a checkpoint) since then; the ranges only cover later writes.
+    std::vector<std::pair<uint32_t, uint32_t>> getDirtyRangesSince(uint64_t since, bool &replaced) const;
+
+    // number of 4 KiB pages allocated so far, including pages shared with a snapshot
+    // (mapped pages are not counted)
+    size_t getPageCount() const
+    {
+        return pageCount;
+    }
+    size_t getMappedPageCount() const;
+    // guest stores dropped because they hit a READ_ONLY mapping
+    uint64_t getIgnoredWriteCount() const
+    {
+        return ignoredWrites;
+    }
+
+    // checkpoint: the file mappings, then runs of consecutive addresses in address order
+    void saveState(CheckpointWriter &writer) const;
+    bool loadState(CheckpointReader &reader);
 
 private:
     std::ostream &out;
 
+    struct Page
+    {
+        uint8_t bytes[PAGE_SIZE];
+    };
+    // per-page flags
+    static constexpr uint8_t PAGE_MAPPED = 1;    // data points into a file mapping
+    static constexpr uint8_t PAGE_READ_ONLY = 2; // stores are ignored
+    static constexpr uint8_t PAGE_WRITTEN = 4;   // a PRIVATE mapped page the guest has stored to
+    static constexpr uint8_t PAGE_SHARED = 8;    // may be shared with a snapshot; copied on the first store
+    static constexpr uint8_t PAGE_CLEAN = 16;    // not written in this epoch yet (dirty tracking)
+    struct PageTable
+    {
+        std::array<uint8_t *, 1u << TABLE_BITS> data{};        // page contents, nullptr if untouched
+        std::array<uint8_t, 1u << TABLE_BITS> flags{};
+        std::array<std::shared_ptr<Page>, 1u << TABLE_BITS> owned; // backing of heap pages
+        std::array<uint64_t, 1u << TABLE_BITS> writeEpoch{};        // last epoch written (dirty tracking)
+    };
+    std::array<std::unique_ptr<PageTable>, 1u << TABLE_BITS> directory;
+    size_t pageCount = 0;
+
+    struct Mapping
+    {
+        std::string path; // absolute, so checkpoints can find the file again
+        uint32_t guestAddress = 0;
+        uint64_t size = 0; // file size in bytes
+        MapMode mode = MapMode::READ_ONLY;
+        std::shared_ptr<uint8_t> host; // unmapped when the last Memory or Snapshot using it goes
+    };
+    std::vector<Mapping> mappings;
+    uint64_t ignoredWrites = 0;
+
+    bool dirtyTracking = false;
+    uint64_t epoch = 0;
+    uint64_t replacedEpoch = 0;      // last epoch in which memory was replaced wholesale
+    std::vector<uint32_t> dirtyPages; // page numbers written in this epoch, to re-arm
+
+    static uint32_t tableIndex(uint64_t address)
+    {
+        return (address >> (PAGE_BITS + TABLE_BITS)) & ((1u << TABLE_BITS) - 1);
+    }
+    static uint32_t pageIndex(uint64_t address)
+    {
+        return (address >> PAGE_BITS) & ((1u << TABLE_BITS) - 1);
+    }
+
+    // the page holding address, or nullptr if it was never written
+    const uint8_t *findPage(uint64_t address) const
+    {
+        const PageTable *table = directory[tableIndex(address)].get();
+        if (!table)
+            return nullptr;
+        return table->data[pageIndex(address)];
+    }
+    // the page a store to address goes to: heap pages directly, everything else through
+    // touchPage(); nullptr if the store must be ignored
+    uint8_t *writablePage(uint64_t address)
+    {
+        PageTable *table = directory[tableIndex(address)].get();
+        if (table && table->data[pageIndex(address)] && table->flags[pageIndex(address)] == 0)
+            return table->data[pageIndex(address)];
+        return touchPage(address);
+    }
+    // allocates a zero-filled page on first use, copies shared pages and tracks stores to
+    // mapped pages and clean pages
+    uint8_t *touchPage(uint64_t address);
+    // records that the page is written in this epoch
+    void markDirty(PageTable &table, uint32_t pageNumber);
+
     // helper to safely read a byte from memory (returns 0 if not present)
-    int8_t getByte(uint32_t address) const
+    uint8_t getByte(uint64_t address) const
+    {
+        const uint8_t *page = findPage(address);
+        return page ? page[address & (PAGE_SIZE - 1)] : 0;
+    }
+    void setByte(uint64_t address, uint8_t value)
+    {
+        if (uint8_t *page = writablePage(address))
+            page[address & (PAGE_SIZE - 1)] = value;
+    }
+};
+
+class Memory::Snapshot
+{
+public:
+    // pages referenced by the snapshot, heap and mapped
+    size_t getPageCount() const
     {
-        auto it = memory.find(address);
-        if (it != memory.end())
-            return it->second;
-        return 0;
+        return pages.size();
     }
+
+private:
+    friend class Memory;
+    struct Entry
+    {
+        uint32_t pageNumber; // address >> PAGE_BITS
+        uint8_t *data;
+        std::shared_ptr<Page> owned; // nullptr for mapped pages
+        uint8_t flags;
+    };
+    std::vector<Entry> pages; // in address order
+    std::vector<Mapping> mappings;
 };
 
 #endif // MEMORY_H
@@ -0,0 +1,223 @@
+/**
+ * @file MultiHartSimulator.cpp
+ * @brief Quantum-synchronized scheduling of several harts over one shared Memory.
+ *
+ * Threaded run, per hart thread:
+ *   1. Run up to the end of the current quantum (Simulator::runFor()).
+ *   2. If the hart stopped (ecall, end of program, ebreak, error), leave the barrier for good.
+ *   3. Otherwise wait at the barrier for the other running harts, then start the next quantum.
+ *
+ * Deterministic run: the same loop, but the harts take turns on the calling thread in hart
+ * order, and the memory lock is not used.
+ */
+#include "MultiHartSimulator.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <iomanip>
+#include <thread>
+
+namespace
+{
+    // CPU time of the calling thread: time a hart spent runnable but descheduled (more harts
+    // than host cores) does not count as work
+    double threadCpuSeconds()
+    {
+        timespec now{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) / 1e9;
+    }
+
+    // Reusable barrier whose participant count shrinks as harts finish
+    class QuantumBarrier
+    {
+    public:
+        explicit QuantumBarrier(int participants) : participants(participants) {}
+
+        void arriveAndWait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            uint64_t arrivedIn = generation;
+            if (++waiting == participants)
+            {
+                release();
+                return;
+            }
+            cv.wait(lock, [&]
+                    { return generation != arrivedIn; });
+        }
+
+        void arriveAndDrop()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --participants;
+            if (participants > 0 && waiting == participants)
+                release();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        int participants;
+        int waiting = 0;
+        uint64_t generation = 0;
+
+        void release()
+        {
+            waiting = 0;
+            ++generation;
+            cv.notify_all();
+        }
+    };
+
+    const char *runResultToString(Simulator::RunResult result)
+    {
+        switch (result)
+        {
+        case Simulator::RunResult::FINISHED:
+            return "finished";
+        case Simulator::RunResult::BREAKPOINT:
+            return "breakpoint";
+        case Simulator::RunResult::PAUSED:
+            return "ebreak";
+        case Simulator::RunResult::LIMIT_REACHED:
+            return "running";
+        case Simulator::RunResult::ERROR:
+            return "error";
+        }
+        return "unknown";
+    }
+}
+
+MultiHartSimulator::MultiHartSimulator(std::ostream &out, ISAMode mode, int hartCount,
+                                       uint64_t quantum, bool deterministic)
+    : out(out), quantum(quantum ? quantum : 1), deterministic(deterministic), sharedMemory(out)
+{
+    for (int i = 0; i < hartCount; ++i)
+    {
+        auto hart = std::make_unique<Hart>();
+        hart->sim = std::make_unique<Simulator>(hart->in, hart->out, mode);
+        hart->sim->attachSharedMemory(&sharedMemory, deterministic ? nullptr : &memoryLock);
+        harts.push_back(std::move(hart));
+    }
+}
+
+bool MultiHartSimulator::load(const std::vector<std::string> &asmLines)
+{
+    for (size_t i = 0; i < harts.size(); ++i)
+    {
+        Hart &hart = *harts[i];
+        Assembler &assembler = hart.sim->getAssembler();
+        if (assembler.assemble(asmLines).empty())
+        {
+            out << hart.out.str();
+            return false;
+        }
+        // load() clears the shared memory, so every hart is loaded before any of them runs
+        hart.sim->load(assembler.getInstructions());
+        hart.sim->setRegValue(10, (int)i);           // a0 = hart id
+        hart.sim->setRegValue(11, (int)harts.size()); // a1 = hart count
+        hart.out.str("");
+        hart.cpuSeconds = 0.0;
+    }
+    return true;
+}
+
+void MultiHartSimulator::setQuiet(bool quiet)
+{
+    for (auto &hart : harts)
+        hart->sim->setQuiet(quiet);
+}
+
+bool MultiHartSimulator::enableJit()
+{
+    bool enabled = true;
+    for (auto &hart : harts)
+        enabled = hart->sim->enableJit() && enabled;
+    return enabled;
+}
+
+bool MultiHartSimulator::runQuantum(Hart &hart)
+{
+    double start = threadCpuSeconds();
+    hart.result = hart.sim->runFor(hart.sim->getInstructionCount() + quantum);
+    hart.cpuSeconds += threadCpuSeconds() - start;
+    return hart.result == Simulator::RunResult::LIMIT_REACHED;
+}
+
+void MultiHartSimulator::runDeterministic()
+{
+    std::vector<Hart *> active;
+    for (auto &hart : harts)
+        active.push_back(hart.get());
+
+    while (!active.empty())
+    {
+        std::vector<Hart *> stillRunning;
+        for (Hart *hart : active)
+        {
+            if (runQuantum(*hart))
+                stillRunning.push_back(hart);
+        }
+        active.swap(stillRunning);
+    }
+}
+
+void MultiHartSimulator::runThreaded()
+{
+    QuantumBarrier barrier((int)harts.size());
+    std::vector<std::thread> threads;
+    for (auto &hart : harts)
+    {
+        threads.emplace_back([this, &barrier, h = hart.get()]
+                             {
+                                 while (runQuantum(*h))
+                                     barrier.arriveAndWait();
+                                 barrier.arriveAndDrop(); });
+    }
+    for (auto &thread : threads)
+        thread.join();
+}
+
+void MultiHartSimulator::run()
+{
+    auto start = std::chrono::steady_clock::now();
+    if (deterministic || harts.size() < 2)
+        runDeterministic();
+    else
+        runThreaded();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t i = 0; i < harts.size(); ++i)
+    {
+        std::istringstream lines(harts[i]->out.str());
+        std::string line;
+        while (std::getline(lines, line))
+            out << "[hart " << i << "] " << line << "\n";
+    }
+    printSummary(wallSeconds);
+}
+
+void MultiHartSimulator::printSummary(double wallSeconds) const
+{
+    uint64_t totalInstructions = 0;
+    double cpuSeconds = 0.0;
+    out << "Harts: " << harts.size() << ", quantum " << quantum << " instructions, "
+        << (deterministic || harts.size() < 2 ? "deterministic" : "threaded") << "\n";
+    for (size_t i = 0; i < harts.size(); ++i)
+    {
+        const Hart &hart = *harts[i];
+        out << "  hart " << i << ": " << hart.sim->getInstructionCount() << " instructions ("
+            << runResultToString(hart.result) << ")\n";
+        totalInstructions += hart.sim->getInstructionCount();
+        cpuSeconds += hart.cpuSeconds;
+    }
+
+    double mips = wallSeconds > 0 ? totalInstructions / wallSeconds / 1e6 : 0.0;
+    double speedup = wallSeconds > 0 ? cpuSeconds / wallSeconds : 0.0;
+    out << "Total: " << totalInstructions << " instructions in " << std::fixed << std::setprecision(3)
+        << wallSeconds << " s = " << std::setprecision(2) << mips << " MIPS, host speedup "
+        << speedup << "x\n";
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,97 @@
+/**
+ * @class MultiHartSimulator
+ * @brief Runs one program on N harts that share a single Memory.
+ *
+ * Each hart is a full Simulator with its own registers, PC, call stack and translation cache.
+ * Only loads and stores are shared: every hart is attached to the same Memory object (see
+ * Simulator::attachSharedMemory()).
+ *
+ * Every hart starts at pc 0 with a0 = hart id and a1 = number of harts, so a parallel kernel
+ * can pick its slice of the work (and its own stack) from a0.
+ *
+ * Scheduling is by instruction quantum:
+ * - Threaded (default): each hart runs on its own host thread. After every `quantum`
+ *   instructions a hart waits at a barrier until all harts still running have done the same,
+ *   so no hart gets more than one quantum ahead of another. Memory accesses are serialized
+ *   by a mutex; their order inside a quantum depends on the host scheduler.
+ * - Deterministic: all harts run on the calling thread, round-robin, one quantum each.
+ *   The same program and quantum always give the same interleaving and the same result.
+ * Quanta end at basic-block boundaries, so a hart may run up to one block past its quantum.
+ *
+ * Each hart writes to its own buffer. run() prints the buffers one hart after another,
+ * followed by per-hart instruction counts, wall time and host speedup (the harts' thread CPU
+ * time / wall time: how many host cores did simulation work at once).
+ *
+ * The cache simulator and breakpoints are not available in multi-hart mode.
+ */
+#ifndef MULTI_HART_SIMULATOR_H
+#define MULTI_HART_SIMULATOR_H
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Simulator.h"
+
+class MultiHartSimulator
+{
+public:
+    static constexpr uint64_t DEFAULT_QUANTUM = 10000;
+
+    MultiHartSimulator(std::ostream &out, ISAMode mode, int hartCount,
+                       uint64_t quantum = DEFAULT_QUANTUM, bool deterministic = false);
+
+    // Assembles and loads the program on every hart; false if assembly fails
+    bool load(const std::vector<std::string> &asmLines);
+
+    // Applied to every hart
+    void setQuiet(bool quiet);
+    bool enableJit();
+
+    // Runs all harts until each one finishes, then prints their output and the summary
+    void run();
+
+    int getHartCount() const
+    {
+        return (int)harts.size();
+    }
+    uint64_t getInstructionCount(int hart) const
+    {
+        return harts[hart]->sim->getInstructionCount();
+    }
+    Simulator &getHart(int hart)
+    {
+        return *harts[hart]->sim;
+    }
+    Memory &getMemory()
+    {
+        return sharedMemory;
+    }
+
+private:
+    struct Hart
+    {
+        std::istringstream in;
+        std::ostringstream out;
+        std::unique_ptr<Simulator> sim;
+        Simulator::RunResult result = Simulator::RunResult::FINISHED;
+        double cpuSeconds = 0.0; // CPU time of the hart's thread while executing (CLOCK_THREAD_CPUTIME_ID)
+    };
+
+    std::ostream &out;
+    uint64_t quantum;
+    bool deterministic;
+
+    Memory sharedMemory;
+    std::mutex memoryLock;
+    std::vector<std::unique_ptr<Hart>> harts;
+
+    // runs one quantum on hart h; false once the hart has stopped
+    bool runQuantum(Hart &hart);
+    void runDeterministic();
+    void runThreaded();
+    void printSummary(double wallSeconds) const;
+};
+
+#endif // MULTI_HART_SIMULATOR_H
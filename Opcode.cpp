@@ -0,0 +1,80 @@
+/**
+ * @file Opcode.cpp
+ * @brief Mnemonic <-> Opcode mapping and per-opcode properties.
+ *
+ * The table below is indexed by Opcode and must stay in the same order as the enum.
+ * Lookups by mnemonic only happen at load time; the execute loop only touches the
+ * writesRd column through opcodeWritesRd().
+ */
+#include "Opcode.h"
+#include <unordered_map>
+
+namespace
+{
+    struct OpcodeInfo
+    {
+        const char *mnemonic;
+        bool writesRd;
+    };
+
+    // Indexed by Opcode. jal links through setRegValue itself and jalr does not link,
+    // so neither is marked as writing rd here.
+    const OpcodeInfo opcodeTable[] = {
+        {"add", true}, {"sub", true}, {"and", true}, {"or", true},
+        {"xor", true}, {"sll", true}, {"srl", true}, {"sra", true},
+
+        {"mul", true}, {"mulh", true}, {"mulhsu", true}, {"mulhu", true},
+        {"div", true}, {"divu", true}, {"rem", true}, {"remu", true},
+
+        {"addw", true}, {"subw", true}, {"sllw", true}, {"srlw", true}, {"sraw", true},
+
+        {"mulw", true}, {"divw", true}, {"divuw", true}, {"remw", true}, {"remuw", true},
+
+        {"addi", true}, {"andi", true}, {"ori", true}, {"xori", true},
+        {"slli", true}, {"srli", true}, {"srai", true},
+
+        {"addiw", true}, {"slliw", true}, {"srliw", true}, {"sraiw", true},
+
+        {"lb", true}, {"lh", true}, {"lw", true}, {"ld", true},
+        {"lbu", true}, {"lhu", true}, {"lwu", true},
+
+        {"sb", false}, {"sh", false}, {"sw", false}, {"sd", false},
+
+        {"beq", false}, {"bne", false}, {"blt", false},
+        {"bge", false}, {"bltu", false}, {"bgeu", false},
+
+        {"jal", false}, {"jalr", false}, {"lui", true}, {"auipc", true},
+
+        {"ecall", false}, {"ebreak", false},
+
+        {"invalid", false}};
+
+    static_assert(sizeof(opcodeTable) / sizeof(opcodeTable[0]) == static_cast<size_t>(Opcode::COUNT),
+                  "opcodeTable must have one entry per Opcode");
+}
+
+Opcode opcodeFromMnemonic(const std::string &mnemonic)
+{
+    static const std::unordered_map<std::string, Opcode> mnemonicToOpcode = []
+    {
+        std::unordered_map<std::string, Opcode> map;
+        for (int i = 0; i < static_cast<int>(Opcode::INVALID); ++i)
+        {
+            map[opcodeTable[i].mnemonic] = static_cast<Opcode>(i);
+        }
+        return map;
+    }();
+
+    auto it = mnemonicToOpcode.find(mnemonic);
+    return (it != mnemonicToOpcode.end()) ? it->second : Opcode::INVALID;
+}
+
+bool opcodeWritesRd(Opcode op)
+{
+    return opcodeTable[static_cast<int>(op)].writesRd;
+}
+
+const char *opcodeToMnemonic(Opcode op)
+{
+    return opcodeTable[static_cast<int>(op)].mnemonic;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file Opcode.h
+ * @brief Dense opcode ids used by the Simulator's execute loop.
+ *
+ * The assembler identifies instructions by mnemonic string. Comparing strings for every
+ * simulated instruction is slow, so Simulator::load() decodes each InstructionInstance once
+ * into an Opcode and execute() dispatches on it with a switch.
+ *
+ * Functions:
+ * - Opcode opcodeFromMnemonic(const std::string& mnemonic):
+ *      Maps a mnemonic such as "addi" to Opcode::ADDI. Unknown mnemonics map to Opcode::INVALID.
+ * - bool opcodeWritesRd(Opcode op):
+ *      True if the simulator writes the result of the instruction back to rd after execute.
+ *      jal writes its link register itself, so it is not included here.
+ * - const char* opcodeToMnemonic(Opcode op):
+ *      Reverse mapping, used for debugging output.
+ * - int opcodeAccessSize(Opcode op):
+ *      Bytes accessed by a load or store, 0 for anything else.
+ * - opcodeIsLoad/Store/Branch/Jump/MulDiv/ALU(Opcode op):
+ *      Instruction classes, grouped like Instruction::isXxxInstruction() but without string lookups.
+ *      They rely on the grouping of the enum below.
+ */
+#ifndef OPCODE_H
+#define OPCODE_H
+
+#include <cstdint>
+#include <string>
+
+enum class Opcode : uint8_t
+{
+    // R-type
+    ADD, SUB, AND, OR, XOR, SLL, SRL, SRA,
+    // RV32M
+    MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU,
+    // RV64I R-type
+    ADDW, SUBW, SLLW, SRLW, SRAW,
+    // RV64M
+    MULW, DIVW, DIVUW, REMW, REMUW,
+    // I-type arithmetic
+    ADDI, ANDI, ORI, XORI, SLLI, SRLI, SRAI,
+    // RV64I I-type arithmetic
+    ADDIW, SLLIW, SRLIW, SRAIW,
+    // Loads
+    LB, LH, LW, LD, LBU, LHU, LWU,
+    // Stores
+    SB, SH, SW, SD,
+    // Branches
+    BEQ, BNE, BLT, BGE, BLTU, BGEU,
+    // Jumps and upper immediates
+    JAL, JALR, LUI, AUIPC,
+    // System
+    ECALL, EBREAK,
+
+    INVALID,
+    COUNT
+};
+
+Opcode opcodeFromMnemonic(const std::string &mnemonic);
+bool opcodeWritesRd(Opcode op);
+const char *opcodeToMnemonic(Opcode op);
+
+inline bool opcodeInRange(Opcode op, Opcode first, Opcode last)
+{
+    return op >= first && op <= last;
+}
+inline bool opcodeIsLoad(Opcode op) { return opcodeInRange(op, Opcode::LB, Opcode::LWU); }
+inline bool opcodeIsStore(Opcode op) { return opcodeInRange(op, Opcode::SB, Opcode::SD); }
+inline bool opcodeIsBranch(Opcode op) { return opcodeInRange(op, Opcode::BEQ, Opcode::BGEU); }
+inline bool opcodeIsJump(Opcode op) { return op == Opcode::JAL || op == Opcode::JALR; }
+inline bool opcodeIsMulDiv(Opcode op)
+{
+    return opcodeInRange(op, Opcode::MUL, Opcode::REMU) || opcodeInRange(op, Opcode::MULW, Opcode::REMUW);
+}
+// bytes a load or store accesses; 0 for other instructions
+inline int opcodeAccessSize(Opcode op)
+{
+    switch (op)
+    {
+    case Opcode::LB: case Opcode::LBU: case Opcode::SB:
+        return 1;
+    case Opcode::LH: case Opcode::LHU: case Opcode::SH:
+        return 2;
+    case Opcode::LW: case Opcode::LWU: case Opcode::SW:
+        return 4;
+    case Opcode::LD: case Opcode::SD:
+        return 8;
+    default:
+        return 0;
+    }
+}
+// shifts count as ALU instructions
+inline bool opcodeIsALU(Opcode op)
+{
+    return opcodeInRange(op, Opcode::ADD, Opcode::SRA) || opcodeInRange(op, Opcode::ADDW, Opcode::SRAW) ||
+           opcodeInRange(op, Opcode::ADDI, Opcode::SRAIW);
+}
+
+#endif // OPCODE_H
@@ -0,0 +1,31 @@
+#include "PackedInstruction.h"
+
+namespace
+{
+    uint8_t packRegister(int reg)
+    {
+        return (reg >= 0 && reg < 32) ? static_cast<uint8_t>(reg) : 0;
+    }
+}
+
+PackedInstruction PackedInstruction::fromInstance(const InstructionInstance &inst)
+{
+    PackedInstruction packed;
+    packed.op = opcodeFromMnemonic(inst.instruction->mnemonic);
+    packed.rd = packRegister(inst.rd);
+    packed.rs1 = packRegister(inst.rs1);
+    packed.rs2 = packRegister(inst.rs2);
+    packed.imm = inst.imm;
+    return packed;
+}
+
+std::vector<PackedInstruction> packProgram(const std::vector<InstructionInstance> &program)
+{
+    std::vector<PackedInstruction> packed;
+    packed.reserve(program.size());
+    for (const auto &inst : program)
+    {
+        packed.push_back(PackedInstruction::fromInstance(inst));
+    }
+    return packed;
+}
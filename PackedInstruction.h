@@ -0,0 +1,43 @@
+/**
+ * @struct PackedInstruction
+ * @brief Compact decoded instruction used on the simulator's hot paths.
+ *
+ * InstructionInstance carries the source text (a heap-allocated std::string) next to the
+ * operands, which makes a program a vector of large, scattered objects. A PackedInstruction
+ * holds only what execution needs, in 8 bytes:
+ *
+ *   | op (1) | rd (1) | rs1 (1) | rs2 (1) | imm (4) |
+ *
+ * Simulator::load() packs the program into a contiguous std::vector<PackedInstruction>. The
+ * interpreter, the translation cache/JIT and the hazard detector read only that array.
+ * The InstructionInstance vector stays as a cold side table for the source text, and is
+ * only used when printing.
+ *
+ * Register fields that the assembler could not parse (-1) are packed as x0, so they read
+ * as zero and are never written.
+ */
+#ifndef PACKED_INSTRUCTION_H
+#define PACKED_INSTRUCTION_H
+
+#include <cstdint>
+#include <vector>
+#include "InstructionInstance.h"
+#include "Opcode.h"
+
+struct PackedInstruction
+{
+    Opcode op = Opcode::INVALID;
+    uint8_t rd = 0;
+    uint8_t rs1 = 0;
+    uint8_t rs2 = 0;
+    int32_t imm = 0;
+
+    static PackedInstruction fromInstance(const InstructionInstance &inst);
+};
+
+static_assert(sizeof(PackedInstruction) == 8, "PackedInstruction should stay 8 bytes");
+
+// Packs every instruction of a program, keeping the same indices
+std::vector<PackedInstruction> packProgram(const std::vector<InstructionInstance> &program);
+
+#endif // PACKED_INSTRUCTION_H
@@ -0,0 +1,15 @@
+#include "PcHistory.h"
+
+std::vector<int> PcHistory::getPCs() const
+{
+    std::vector<int> pcs;
+    pcs.reserve(count);
+    // the oldest entry is `count` slots behind the next write position
+    size_t index = (next + buffer.size() - count) % buffer.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        pcs.push_back(buffer[index]);
+        index = (index + 1 == buffer.size()) ? 0 : index + 1;
+    }
+    return pcs;
+}
@@ -0,0 +1,48 @@
+/**
+ * @class PcHistory
+ * @brief Fixed-size ring buffer of the most recently executed program counters.
+ *
+ * The Simulator records every executed PC here. It costs one store per instruction, so it
+ * stays on in quiet mode, where there is no trace output. The history can be dumped on demand
+ * (the `history` command) and is dumped automatically when a run stops on an error.
+ */
+#ifndef PC_HISTORY_H
+#define PC_HISTORY_H
+
+#include <cstddef>
+#include <vector>
+
+class PcHistory
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit PcHistory(size_t capacity = DEFAULT_CAPACITY) : buffer(capacity, 0) {}
+
+    void record(int pc)
+    {
+        buffer[next] = pc;
+        next = (next + 1 == buffer.size()) ? 0 : next + 1;
+        if (count < buffer.size())
+            ++count;
+    }
+
+    void clear()
+    {
+        next = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return buffer.size(); }
+
+    // recorded PCs, oldest first
+    std::vector<int> getPCs() const;
+
+private:
+    std::vector<int> buffer;
+    size_t next = 0;  // slot the next PC is written to
+    size_t count = 0; // number of valid entries
+};
+
+#endif // PC_HISTORY_H
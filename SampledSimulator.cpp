@@ -0,0 +1,229 @@
+/**
+ * @file SampledSimulator.cpp
+ * @brief Period loop, detailed stepping and extrapolation of sampled simulation.
+ *
+ * Detailed instructions go through Simulator::step() one at a time. For each one the cache
+ * miss counter tells whether it missed, and the PC after the step tells whether a branch was
+ * taken; both feed HazardDetector::timeInstruction(), as do the cycles a store stalled on the
+ * cache's write buffer.
+ *
+ * Estimates use the mean of the per-window ratios (CPI, hit rate, stalls per instruction):
+ *   mean +- 1.96 * stddev / sqrt(windows)
+ * and totals are ratio * instructions executed.
+ */
+#include "SampledSimulator.h"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+
+namespace
+{
+    struct Estimate
+    {
+        double mean = 0.0;
+        double halfWidth = 0.0; // 95% confidence half width; 0 with fewer than two samples
+        size_t samples = 0;
+    };
+
+    Estimate estimate(const std::vector<double> &values)
+    {
+        Estimate e;
+        e.samples = values.size();
+        if (values.empty())
+            return e;
+        for (double v : values)
+            e.mean += v;
+        e.mean /= values.size();
+        if (values.size() < 2)
+            return e;
+        double sumSq = 0.0;
+        for (double v : values)
+            sumSq += (v - e.mean) * (v - e.mean);
+        double stddev = std::sqrt(sumSq / (values.size() - 1));
+        e.halfWidth = 1.96 * stddev / std::sqrt((double)values.size());
+        return e;
+    }
+
+    void printEstimate(std::ostream &out, const std::string &label, const Estimate &e, double scale, int precision)
+    {
+        out << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(precision)
+            << e.mean * scale;
+        if (e.samples >= 2)
+            out << " +- " << e.halfWidth * scale;
+        out << "\n";
+        out.unsetf(std::ios::floatfield);
+    }
+}
+
+SampledSimulator::SampledSimulator(Simulator &sim, const CacheConfig &cacheConfig, const SamplingConfig &sampling,
+                                   PipelineType pipelineType)
+    : sim(sim), cacheConfig(cacheConfig), sampling(sampling), timing(timingIn, timingOut)
+{
+    timing.setPipelineType(pipelineType);
+    sim.setQuiet(true);
+}
+
+bool SampledSimulator::isValid(std::ostream &out) const
+{
+    if (sampling.window == 0 || sampling.warmup + sampling.window > sampling.period)
+    {
+        out << "Error: sampling needs window > 0 and warmup + window <= period\n";
+        return false;
+    }
+    return true;
+}
+
+bool SampledSimulator::fastForward(uint64_t count)
+{
+    if (count == 0)
+        return true;
+    return sim.runFor(sim.getInstructionCount() + count) == Simulator::RunResult::LIMIT_REACHED;
+}
+
+bool SampledSimulator::runDetailed(uint64_t count, WindowStats *stats)
+{
+    const Cache &cache = sim.getCacheSimulator().getCache();
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        int pc = sim.getPC();
+        const PackedInstruction *inst = sim.getInstructionAt(pc);
+        if (!inst)
+            return false;
+        uint64_t accessesBefore = cache.getAccesses();
+        uint64_t hitsBefore = cache.getHits();
+        uint64_t missesBefore = cache.getMisses();
+        uint64_t writeStallsBefore = cache.getWriteBufferStallCycles();
+
+        uint64_t countBefore = sim.getInstructionCount();
+        sim.step();
+        if (sim.getInstructionCount() == countBefore)
+            return false;
+        ++detailedInstructions;
+
+        bool taken = sim.getPC() != pc + 4;
+        int writeStalls = static_cast<int>(cache.getWriteBufferStallCycles() - writeStallsBefore);
+        InstructionTiming t = timing.timeInstruction(*inst, taken, cache.getMisses() != missesBefore, writeStalls);
+        if (stats)
+        {
+            ++stats->instructions;
+            stats->cycles += t.cycles();
+            stats->cacheAccesses += cache.getAccesses() - accessesBefore;
+            stats->cacheHits += cache.getHits() - hitsBefore;
+            stats->rawStalls += t.rawStalls;
+            stats->structuralStalls += t.structuralStalls;
+            stats->controlStalls += t.controlStalls;
+            stats->cacheStalls += t.cacheStalls;
+            stats->writeBufferStalls += t.writeBufferStalls;
+        }
+        if (inst->op == Opcode::EBREAK || sim.hasExited())
+            return false;
+    }
+    return true;
+}
+
+void SampledSimulator::run()
+{
+    windows.clear();
+    partialWindow = WindowStats();
+    detailedInstructions = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    const uint64_t functional = sampling.period - sampling.warmup - sampling.window;
+    bool cacheOn = false;
+    bool running = true;
+    while (running)
+    {
+        if (functional > 0 && cacheOn)
+        {
+            // memory must be current before accesses bypass the cache
+            sim.flushCache();
+            sim.disableCache();
+            cacheOn = false;
+        }
+        if (!fastForward(functional))
+            break;
+
+        if (!cacheOn)
+        {
+            sim.enableCache(cacheConfig);
+            timing.resetTiming();
+            cacheOn = true;
+        }
+        if (!runDetailed(sampling.warmup, nullptr))
+            break;
+
+        WindowStats stats;
+        running = runDetailed(sampling.window, &stats);
+        if (stats.instructions == sampling.window)
+            windows.push_back(stats);
+        else
+            partialWindow = stats;
+    }
+    if (cacheOn)
+    {
+        sim.flushCache();
+        sim.disableCache();
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SampledSimulator::printReport(std::ostream &out) const
+{
+    const uint64_t total = sim.getInstructionCount();
+    // a cut-short window is only used when no complete window exists (short programs)
+    std::vector<WindowStats> used = windows;
+    if (used.empty() && partialWindow.instructions > 0)
+        used.push_back(partialWindow);
+
+    out << "Sampled simulation: period " << sampling.period << ", warmup " << sampling.warmup
+        << ", window " << sampling.window << " instructions\n";
+    out << "  Instructions:         " << total << " (" << detailedInstructions << " detailed, "
+        << used.size() << " measurement windows) in " << std::fixed << std::setprecision(3) << seconds << " s\n";
+    out.unsetf(std::ios::floatfield);
+    if (used.empty())
+    {
+        out << "  No measurement window completed; the program is shorter than warmup.\n";
+        return;
+    }
+
+    auto perWindow = [&](const std::function<double(const WindowStats &)> &value)
+    {
+        std::vector<double> values;
+        for (const auto &w : used)
+            values.push_back(value(w));
+        return estimate(values);
+    };
+    auto perInstruction = [&](uint64_t WindowStats::*field)
+    {
+        return perWindow([field](const WindowStats &w)
+                         { return (double)(w.*field) / w.instructions; });
+    };
+
+    out << "Estimates (95% confidence" << (used.size() < 2 ? "; needs two or more windows" : "") << "):\n";
+    Estimate cpi = perInstruction(&WindowStats::cycles);
+    printEstimate(out, "CPI", cpi, 1.0, 3);
+    printEstimate(out, "Total cycles", cpi, (double)total, 0);
+
+    std::vector<double> hitRates;
+    for (const auto &w : used)
+    {
+        if (w.cacheAccesses > 0)
+            hitRates.push_back((double)w.cacheHits / w.cacheAccesses);
+    }
+    if (hitRates.empty())
+        out << "  D-cache hit rate       no accesses in the measured windows\n";
+    else
+        printEstimate(out, "D-cache hit rate (%)", estimate(hitRates), 100.0, 2);
+
+    Estimate stalls = perWindow([](const WindowStats &w)
+                                { return (double)(w.cycles - w.instructions) / w.instructions; });
+    printEstimate(out, "Total stalls", stalls, (double)total, 0);
+    printEstimate(out, "  RAW stalls", perInstruction(&WindowStats::rawStalls), (double)total, 0);
+    printEstimate(out, "  Structural stalls", perInstruction(&WindowStats::structuralStalls), (double)total, 0);
+    printEstimate(out, "  Control stalls", perInstruction(&WindowStats::controlStalls), (double)total, 0);
+    printEstimate(out, "  Cache stalls", perInstruction(&WindowStats::cacheStalls), (double)total, 0);
+    if (cacheConfig.writeBufferEntries > 0 && cacheConfig.writePolicy == WritePolicy::WT)
+        printEstimate(out, "  Write buffer stalls", perInstruction(&WindowStats::writeBufferStalls), (double)total, 0);
+}
@@ -0,0 +1,86 @@
+/**
+ * @class SampledSimulator
+ * @brief Estimates cache and pipeline behaviour of a long run from short detailed windows.
+ *
+ * The program runs in periods of `period` instructions. Each period is:
+ *   1. Fast-forward: period - warmup - window instructions, functional only (cache off, no
+ *      timing, translated blocks and JIT allowed).
+ *   2. Warmup: `warmup` instructions stepped with the cache on and the timing model running,
+ *      so the cache and the pipeline window are filled; nothing is recorded.
+ *   3. Measurement: `window` instructions stepped like the warmup, recording instructions,
+ *      cycles, cache accesses/hits and stalls by type.
+ * The cache starts empty at each warmup, and dirty blocks are written back before the next
+ * fast-forward, so memory stays exact. With period == warmup + window there is no
+ * fast-forward and the whole run is detailed.
+ *
+ * Timing comes from HazardDetector::timeInstruction(): one cycle per instruction plus RAW,
+ * structural, control and cache-miss stalls, plus the cycles stores wait for a full write buffer
+ * (WT configs with writeBufferEntries). The report extrapolates per-window CPI, hit rate
+ * and stalls per instruction to the whole run, with 95% confidence intervals from the spread
+ * between windows (normal approximation; needs at least two windows).
+ */
+#ifndef SAMPLED_SIMULATOR_H
+#define SAMPLED_SIMULATOR_H
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "Simulator.h"
+#include "HazardDetector.h"
+#include "CacheConfig.h"
+
+struct SamplingConfig
+{
+    uint64_t period = 1000000; // instructions from one measurement window to the next
+    uint64_t warmup = 10000;   // detailed instructions before each window, not measured
+    uint64_t window = 10000;   // measured instructions per period
+};
+
+class SampledSimulator
+{
+public:
+    // sim must have a program loaded; it is switched to quiet mode
+    SampledSimulator(Simulator &sim, const CacheConfig &cacheConfig, const SamplingConfig &sampling,
+                     PipelineType pipelineType = PIPELINE_5_STAGE);
+
+    // false (with a message) if warmup + window does not fit in the period
+    bool isValid(std::ostream &out) const;
+
+    // Runs the program to the end in sampled mode
+    void run();
+
+    void printReport(std::ostream &out) const;
+
+private:
+    struct WindowStats
+    {
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+        uint64_t cacheAccesses = 0;
+        uint64_t cacheHits = 0;
+        uint64_t rawStalls = 0;
+        uint64_t structuralStalls = 0;
+        uint64_t controlStalls = 0;
+        uint64_t cacheStalls = 0;
+        uint64_t writeBufferStalls = 0;
+    };
+
+    Simulator &sim;
+    CacheConfig cacheConfig;
+    SamplingConfig sampling;
+    std::istringstream timingIn;
+    std::ostringstream timingOut;
+    HazardDetector timing;
+
+    std::vector<WindowStats> windows; // complete measurement windows only
+    WindowStats partialWindow;        // a window cut short by the end of the program
+    uint64_t detailedInstructions = 0;
+    double seconds = 0.0;
+
+    // Both return false once the program has stopped
+    bool fastForward(uint64_t count);
+    bool runDetailed(uint64_t count, WindowStats *stats);
+};
+
+#endif // SAMPLED_SIMULATOR_H
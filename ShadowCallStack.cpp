@@ -15,6 +15,8 @@
  * - pushFrame(const Assembler& assembler, int pc): Pushes a new frame based on assembler info and program counter.
  * - popFrameIfMatchingReturnAddress(int rd): Pops the top frame if the return address matches the expected value.
  * - showStack() const: Displays the current call stack from oldest to newest.
+ * - setQuiet(bool): Suppresses the messages and stack dumps printed while popping frames.
+ * - saveState()/loadState(): Saves or restores the frames for a checkpoint.
  *
  * Dependencies:
  * - CallFrame.h: Defines the CallFrame class representing a single stack frame.
@@ -90,19 +92,24 @@
 
             if (shadowReturnAddr == rd) {
                 shadowCallStack.pop_back();
-                out << "Found a shadowReturnAddr removing it\n";
-                showStack();
+                if (!quiet) {
+                    out << "Found a shadowReturnAddr removing it\n";
+                    showStack();
+                }
                 
             } else {
-                out << "Warning! Shadow call stack mismatch! Expected: 0x" 
+                if (!quiet) {
+                    out << "Warning! Shadow call stack mismatch! Expected: 0x" 
                           << std::hex << shadowReturnAddr 
                           << " but asking to pop 0x" << rd << std::dec 
                           << "\n";
+                }
                    
                 shadowCallStack.pop_back(); // Still popping?
-                showStack();
+                if (!quiet)
+                    showStack();
                             }
-        } else {
+        } else if (!quiet) {
             out << "Shadow call stack empty on jalr!\n";
         }
     }
@@ -123,3 +130,36 @@
             out << "#" << i << " " << frames[i];
         }
     }
+
+    namespace {
+        void saveFrame(CheckpointWriter& writer, const CallFrame& frame) {
+            writer.writeString(frame.getFunctionName());
+            writer.writeI32(frame.getSourceLine());
+            writer.writeU32(frame.getReturnAddress());
+        }
+
+        CallFrame loadFrame(CheckpointReader& reader) {
+            std::string name = reader.readString();
+            int sourceLine = reader.readI32();
+            uint32_t returnAddress = reader.readU32();
+            return CallFrame(name, sourceLine, returnAddress);
+        }
+    }
+
+    void ShadowCallStack::saveState(CheckpointWriter& writer) const {
+        writer.writeU32(static_cast<uint32_t>(shadowCallStack.size()));
+        for (const auto& frame : shadowCallStack) {
+            saveFrame(writer, frame);
+        }
+        saveFrame(writer, currCallFrame);
+    }
+
+    bool ShadowCallStack::loadState(CheckpointReader& reader) {
+        shadowCallStack.clear();
+        uint32_t count = reader.readU32();
+        for (uint32_t i = 0; i < count && reader.isGood(); ++i) {
+            shadowCallStack.push_back(loadFrame(reader));
+        }
+        currCallFrame = loadFrame(reader);
+        return reader.isGood();
+    }
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include "CallFrame.h"
 #include "Assembler.h"
+#include "Checkpoint.h"
 
 
 class ShadowCallStack {
@@ -34,6 +35,19 @@ class ShadowCallStack {
         
         void showStack() const ;
 
+        // quiet: popFrameIfMatchingReturnAddress() updates the stack without printing it
+        void setQuiet(bool isQuiet) { quiet = isQuiet; }
+
+        // replaces the frames with a copy of other's (snapshots)
+        void copyFramesFrom(const ShadowCallStack& other) {
+            shadowCallStack = other.shadowCallStack;
+            currCallFrame = other.currCallFrame;
+        }
+
+        // checkpoint: all frames and the frame being built
+        void saveState(CheckpointWriter& writer) const;
+        bool loadState(CheckpointReader& reader);
+
     protected:
         std::istream& in;
         std::ostream& out;
@@ -41,6 +55,7 @@ class ShadowCallStack {
     private:
         std::vector<CallFrame> shadowCallStack;
         CallFrame currCallFrame;
+        bool quiet = false;
 
 
 };
@@ -23,11 +23,22 @@
  * - setRegValue(): Sets a register value, with x0 protection.
  * - load(): Loads a vector of instructions into the simulator.
  * - reset(), resetRegsMemStack(): Resets the simulator state.
- * - run(): Executes the loaded program, handling breakpoints and system calls.
+ * - run(): Executes the loaded program block by block from the translation cache, handling breakpoints and system calls.
+ * - runFor(): Same loop with an instruction limit; MultiHartSimulator interleaves harts with it.
+ * - attachSharedMemory(): Makes loads and stores use a Memory shared with other harts.
  * - step(): Executes a single instruction, updates PC and call stack.
- * - execute(): Decodes and executes a single instruction instance.
+ * - setQuiet(), dumpPcHistory(): Runs without trace output while keeping the last executed PCs.
+ * - enableJit(): Compiles hot basic blocks to native code (x86-64 Linux); setLockstepReference()
+ *   checks every block against an interpreter-only Simulator.
+ * - execute(): Executes a single packed instruction, dispatching on the opcode decoded at load().
  * - readMemory(), writeMemory(): Handles memory access for different data sizes.
  * - printRegisters(), printMemory(): Outputs current register and memory contents.
+ * - saveCheckpoint(), loadCheckpoint(): Saves or restores the full simulator state to a binary file.
+ * - takeSnapshot(), restoreSnapshot(): Copy-on-write snapshots of the state, for forking many runs
+ *   (e.g. with different cache configs) from one program point.
+ * - startTrace(), stopTrace(): Records a compact binary trace of executed instructions (Trace.h).
+ * - enableDirtyTracking(), getDirtyRegionsSince(): Binary diff of registers and memory pages
+ *   changed since an epoch, so a front end does not re-read everything after each step.
  * - setBreakpoint(), removeBreakpoint(): Manages breakpoints by source line.
  * - showStack(): Displays the current call stack.
  *
@@ -45,6 +56,7 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <fstream>
 
 // TBD: The text section spans from 0x0 --> 0x10000. Each instruction is 4 bytes.
 // TBD: The data section starts at 0x10000.
@@ -74,14 +86,14 @@ void Simulator::initializeRegisters()
     }
 }
 
-void Simulator::setRegValue(int regNum, int value)
+void Simulator::setRegValue(int regNum, int64_t value)
 {
     // x0 always zero ; do not allow to overwrite
     if (regNum == 0)
         return;
     // ra value is for managing return addresses; track when it is overwritten for debugging
     // if (regNum == 1)  std::cout <<" Overwriting ra value : "<< value << "\n";
-    regs[regNum] = value;
+    regs[regNum] = xlen64 ? value : (int64_t)(int32_t)value;
 }
 
 void Simulator::load(const std::vector<InstructionInstance> &instructions)
@@ -89,60 +101,120 @@ void Simulator::load(const std::vector<InstructionInstance> &instructions)
     out << "Loading program...\n";
     reset();
     program = instructions;
+    // Decode once into the compact form that execute() dispatches on
+    packedProgram = packProgram(program);
+    // Resolve source lines once instead of scanning the assembler's map on every step
+    sourceLines.assign(program.size(), 0);
+    for (const auto &[line, linePC] : assembler.getSourceLineToPC())
+    {
+        if (linePC >= 0 && linePC % 4 == 0 && linePC / 4 < (int)program.size())
+            sourceLines[linePC / 4] = line;
+    }
+}
+
+int Simulator::sourceLineAt(int pc) const
+{
+    if (pc < 0 || pc % 4 != 0 || pc / 4 >= (int)sourceLines.size())
+        return 0;
+    return sourceLines[pc / 4];
 }
 
 void Simulator::reset()
 {
     resetRegsMemStack();
     program.clear();
+    packedProgram.clear();
+    sourceLines.clear();
     breakpointInfo.reset();
+    translationCache.clear();
+    // compiled code belonged to the dropped blocks
+    if (jit)
+        jit->reset();
 }
 
 void Simulator::resetRegsMemStack()
 {
     pc = 0;
+    instructionCount = 0;
+    exited = false;
+    exitCode = 0;
+    pcHistory.clear();
     initializeRegisters();
-    memory.clear();
-    shadowCallStack.reset();
+    // invalidating drains the write buffer, so do it before memory is cleared
     cacheSim.invalidate();
+    activeMemory->clear();
+    shadowCallStack.reset();
 }
 
 void Simulator::run()
 {
     // run will always start afresh and ignore previous ecall, ebreak.
     running = true;
-    // reset any previous break points hit
-    int hitBreakpoint = false;
+    RunResult result = runFor(UINT64_MAX);
+
+    if (result == RunResult::FINISHED && running)
+    {
+        out << "Program completed (possibly reached end of program).\n";
+        // resetRegsMemStack();
+        // cacheSim.invalidate();
+    }
+    // reset
+    pauseRequested = false;
+}
+
+Simulator::RunResult Simulator::runFor(uint64_t instructionLimit)
+{
+    BasicBlock *block = nullptr;
     while (pc < 4 * (int)program.size())
     {
+        if (instructionCount >= instructionLimit)
+            return RunResult::LIMIT_REACHED;
+
+        // Blocks only ever have a breakpoint on their first instruction, so checking
+        // at block entry is the same as checking before every instruction.
         // if no breakpoint at pc, line =0
         int line = breakpointInfo.getBreakpointAssemblyLine(pc);
 
         if (line && !resumedFromBreakpoint)
         {
             out << "Execution stopped at breakpoint at line: " << std::dec << line << '\n';
-            hitBreakpoint = true;
             resumedFromBreakpoint = true; // next time, we skip this breakpoint once
-            break;
+            return RunResult::BREAKPOINT;
         }
 
         resumedFromBreakpoint = false; // cleared only after stepping
-        step();
+        int blockPC = pc;
+        uint64_t countBefore = instructionCount;
+        block = translationCache.getBlock(pc, block, packedProgram, sourceLines, breakpointInfo);
+        if (block)
+        {
+            executeBlock(*block);
+        }
+        else
+        {
+            step(); // pc is not an instruction address; let step() report it
+            if (instructionCount == countBefore)
+            {
+                out << "Execution stopped: PC 0x" << std::hex << pc << std::dec << " is not an instruction address\n";
+                dumpPcHistory();
+                running = false;
+                return RunResult::ERROR;
+            }
+        }
+        if (lockstepReference && !checkLockstep(instructionCount - countBefore, blockPC))
+        {
+            dumpPcHistory();
+            running = false;
+            return RunResult::ERROR;
+        }
         if (pauseRequested)
         {
             out << "Execution paused due to ebreak.\n";
-            break;
+            return RunResult::PAUSED;
         }
     }
-
-    if (!pauseRequested && running && !hitBreakpoint)
-    {
-        out << "Program completed (possibly reached end of program).\n";
-        // resetRegsMemStack();
-        // cacheSim.invalidate();
-    }
-    // reset
-    pauseRequested = false;
+    cacheSim.drainWriteBuffer();
+    return RunResult::FINISHED;
 }
 
 int Simulator::step()
@@ -160,11 +232,182 @@ int Simulator::step()
     //}
 
     // FInd the assembly source code line from pc.
+    executeAtPC(packedProgram[instrIndex], sourceLineAt(pc));
+    return sourceLineAt(pc); // return the next source line to be executed for debugger
+}
+
+void Simulator::executeBlock(BasicBlock &block)
+{
+    // compiled code cannot be traced instruction by instruction
+    if (jit && !traceWriter && !block.jitCode && !block.jitRejected && ++block.execCount >= jitHotThreshold)
+        jit->compile(block);
+    if (block.jitCode && !traceWriter)
+    {
+        executeCompiledBlock(block);
+        return;
+    }
+
+    // Only the last instruction of a block can branch, jump, exit or pause
+    for (const TranslatedOp &op : block.ops)
+    {
+        executeAtPC(op.inst, op.sourceLine);
+    }
+}
+
+void Simulator::executeCompiledBlock(const BasicBlock &block)
+{
+    // The compiled body has no trace output; do the call stack bookkeeping that
+    // executeAtPC() would have done, once for the whole body
+    if (pc == 0)
+        shadowCallStack.pushFrame(assembler, pc);
+    if (block.jitOps > 1 || block.startPC != 0)
+        shadowCallStack.updateTopFrameSourceLine(block.ops[block.jitOps - 1].sourceLine);
+
+    block.jitCode(&jitContext);
+    instructionCount += block.jitOps;
+    // only the newest PCs survive in the history anyway
+    int firstRecorded = std::max(0, block.jitOps - (int)pcHistory.capacity());
+    for (int i = firstRecorded; i < block.jitOps; ++i)
+    {
+        pcHistory.record(block.startPC + 4 * i);
+    }
+
+    pc = block.startPC + 4 * block.jitOps;
+    shadowCallStack.updateTopFrameReturnAddress(pc);
 
-    int sourceLine = -1;
-    sourceLine = assembler.getCurrentSourceLine(pc);
+    // the terminator (branch, jump, ecall, ebreak) is interpreted
+    for (size_t i = block.jitOps; i < block.ops.size(); ++i)
+    {
+        executeAtPC(block.ops[i].inst, block.ops[i].sourceLine);
+    }
+}
+
+void Simulator::setQuiet(bool isQuiet)
+{
+    quiet = isQuiet;
+    shadowCallStack.setQuiet(isQuiet);
+}
+
+void Simulator::dumpPcHistory() const
+{
+    out << "Last " << pcHistory.size() << " executed instructions (oldest first):\n";
+    char oldFill = out.fill('0');
+    for (int historyPC : pcHistory.getPCs())
+    {
+        out << "  0x" << std::setw(6) << std::hex << historyPC << std::dec
+            << " (line: " << sourceLineAt(historyPC) << ")";
+        int index = historyPC / 4;
+        if (historyPC >= 0 && index < (int)program.size())
+            out << "  " << program[index];
+        out << "\n";
+    }
+    out.fill(oldFill);
+}
+
+bool Simulator::enableJit(uint32_t hotThreshold)
+{
+    if (!JitCompiler::isSupported())
+    {
+        out << "JIT is not supported on this host; using the interpreter.\n";
+        return false;
+    }
+    jit = std::make_unique<JitCompiler>(xlen64);
+    jitHotThreshold = hotThreshold;
+    jitContext.regs = regs;
+    jitContext.owner = this;
+    jitContext.load = &Simulator::jitLoad;
+    jitContext.store = &Simulator::jitStore;
+    jitContext.interpret = &Simulator::jitInterpret;
+    return true;
+}
+
+int64_t Simulator::jitLoad(void *owner, uint64_t addr, uint32_t op, uint32_t pc)
+{
+    Simulator *sim = static_cast<Simulator *>(owner);
+    // the cache log and the prefetchers see the load's own PC, as in the interpreter
+    sim->pc = static_cast<int>(pc);
+    // same reads and casts as the load cases in execute()
+    switch (static_cast<Opcode>(op))
+    {
+    case Opcode::LB:
+        return (int8_t)sim->readMemory(addr, MemSize::Byte, false);
+    case Opcode::LH:
+        return (int16_t)sim->readMemory(addr, MemSize::HalfWord, false);
+    case Opcode::LW:
+        return sim->readMemory(addr, MemSize::Word, false);
+    case Opcode::LD:
+        return sim->readMemory(addr, MemSize::DoubleWord, false);
+    case Opcode::LBU:
+        return sim->readMemory(addr, MemSize::Byte, true);
+    case Opcode::LHU:
+        return sim->readMemory(addr, MemSize::HalfWord, true);
+    case Opcode::LWU:
+        return sim->readMemory(addr, MemSize::Word, true);
+    default:
+        return 0;
+    }
+}
+
+void Simulator::jitStore(void *owner, uint64_t addr, uint32_t op, int64_t value, uint32_t pc)
+{
+    Simulator *sim = static_cast<Simulator *>(owner);
+    sim->pc = static_cast<int>(pc);
+    switch (static_cast<Opcode>(op))
+    {
+    case Opcode::SB:
+        sim->writeMemory(addr, MemSize::Byte, value);
+        break;
+    case Opcode::SH:
+        sim->writeMemory(addr, MemSize::HalfWord, value);
+        break;
+    case Opcode::SW:
+        sim->writeMemory(addr, MemSize::Word, value);
+        break;
+    case Opcode::SD:
+        sim->writeMemory(addr, MemSize::DoubleWord, value);
+        break;
+    default:
+        break;
+    }
+}
+
+void Simulator::jitInterpret(void *owner, const TranslatedOp *op)
+{
+    static_cast<Simulator *>(owner)->execute(op->inst);
+}
+
+bool Simulator::checkLockstep(uint64_t count, int blockPC)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        lockstepReference->step();
+    }
 
+    bool match = (pc == lockstepReference->pc);
+    for (int r = 0; r < 32 && match; ++r)
+    {
+        match = (regs[r] == lockstepReference->regs[r]);
+    }
+    if (match)
+        return true;
+
+    lockstepMismatch = true;
+    out << "Lockstep mismatch after block at PC 0x" << std::hex << blockPC << std::dec
+        << " (" << count << " instructions)\n";
+    if (pc != lockstepReference->pc)
+        out << "  pc: 0x" << std::hex << pc << " (interpreter 0x" << lockstepReference->pc << ")" << std::dec << "\n";
+    for (int r = 0; r < 32; ++r)
+    {
+        if (regs[r] != lockstepReference->regs[r])
+            out << "  x" << r << ": 0x" << std::hex << regs[r] << " (interpreter 0x" << lockstepReference->regs[r] << ")" << std::dec << "\n";
+    }
+    return false;
+}
+
+void Simulator::executeAtPC(const PackedInstruction &inst, int sourceLine)
+{
     int old_pc = pc;
+    pcHistory.record(pc);
     out << std::dec;
 
     if (pc == 0)
@@ -172,34 +415,43 @@ int Simulator::step()
     else
         shadowCallStack.updateTopFrameSourceLine(sourceLine);
 
-    execute(program[instrIndex]);
+    uint64_t accessAddress = 0;
+    if (traceWriter && opcodeAccessSize(inst.op))
+        accessAddress = regs[inst.rs1] + inst.imm; // before a load can overwrite rs1
+    execute(inst);
+    ++instructionCount;
+    if (traceWriter)
+        traceInstruction(old_pc, inst, accessAddress);
 
-    out << "Executed: " << program[instrIndex]
-        << " (line: " << sourceLine << ") ; PC = " << " hex: 0x" << std::setfill('0') << std::setw(6)
-        << std::hex << old_pc << std::dec << "\n";
+    if (!quiet)
+    {
+        out << "Executed: " << program[old_pc / 4]
+            << " (line: " << sourceLine << ") ; PC = " << " hex: 0x" << std::setfill('0') << std::setw(6)
+            << std::hex << old_pc << std::dec << "\n";
+    }
     // Advance to nexte step ; Every instruction is 4 bytes
     if (pc <= 4 * (int)program.size() - 4)
         pc += 4; // dont update pc if you are already at last line
                  // add nextInstr to top of the stack
     shadowCallStack.updateTopFrameReturnAddress(pc);
-    sourceLine = assembler.getCurrentSourceLine(pc);
-    return sourceLine; // return the next source line to be executed for debugger
 }
 
-void Simulator::execute(const InstructionInstance &inst)
+void Simulator::execute(const PackedInstruction &inst)
 {
-
-    const std::string &name = inst.instruction->mnemonic;
-    if (name == "ecall")
+    const Opcode op = inst.op;
+    if (op == Opcode::ECALL)
     {
-        int exitCode = regs[10]; // a0
+        exitCode = regs[10]; // a0
+        exited = true;
         out << "Program exited with code: " << exitCode << "\n";
+        // write-through stores are committed: let them reach memory
+        cacheSim.drainWriteBuffer();
         // TBD: Implement syscall handling logic. for now simply stopping the program execution
         pc = program.size() * 4;
         running = false; // Stop the simulator (halt)
         return;
     }
-    else if (name == "ebreak")
+    else if (op == Opcode::EBREAK)
     {
         pauseRequested = true; // mark that a pause is requested
         return;
@@ -211,82 +463,106 @@ void Simulator::execute(const InstructionInstance &inst)
     rs2 = regs[inst.rs2];
 
     imm = inst.imm;
-    int64_t simm = (int64_t)((int32_t)(imm << 20) >> 20);
-    // Implement R, I, S, B, U, J instructions based on `name`
-
+    // Implement R, I, S, B, U, J instructions based on the decoded opcode
+    switch (op)
+    {
     // R-type instructions
-    if (name == "add")
+    case Opcode::ADD:
         rd = rs1 + rs2;
-    else if (name == "sub")
+        break;
+    case Opcode::SUB:
         rd = rs1 - rs2;
-    else if (name == "and")
+        break;
+    case Opcode::AND:
         rd = rs1 & rs2;
-    else if (name == "or")
+        break;
+    case Opcode::OR:
         rd = rs1 | rs2;
-    else if (name == "xor")
+        break;
+    case Opcode::XOR:
         rd = rs1 ^ rs2;
-    else if (name == "sll")
-        rd = rs1 << (rs2 & 0x1F);
-    else if (name == "srl")
-        rd = rs1 >> (rs2 & 0x1F);
-    else if (name == "sra")
-        rd = (int32_t)rs1 >> (rs2 & 0x1F);
+        break;
+    case Opcode::SLL:
+        rd = xlen64 ? (int64_t)((uint64_t)rs1 << (rs2 & 0x3F)) : rs1 << (rs2 & 0x1F);
+        break;
+    case Opcode::SRL:
+        rd = xlen64 ? (int64_t)((uint64_t)rs1 >> (rs2 & 0x3F)) : rs1 >> (rs2 & 0x1F);
+        break;
+    case Opcode::SRA:
+        rd = xlen64 ? rs1 >> (rs2 & 0x3F) : (int32_t)rs1 >> (rs2 & 0x1F);
+        break;
 
     // --- RV32M Extension (Multiply/Divide) ---
-    else if (name == "mul")
-        rd = (int32_t)rs1 * (int32_t)rs2;
-    else if (name == "mulh")
+    case Opcode::MUL:
+        rd = xlen64 ? (int64_t)((uint64_t)rs1 * (uint64_t)rs2) : (int32_t)rs1 * (int32_t)rs2;
+        break;
+    case Opcode::MULH:
         rd = ((__int128_t)(int64_t)rs1 * (__int128_t)(int64_t)rs2) >> 64; // Use 128-bit intermediate for high bits
-    else if (name == "mulhsu")
+        break;
+    case Opcode::MULHSU:
         rd = ((__int128_t)(int64_t)rs1 * (__int128_t)(uint64_t)rs2) >> 64;
-    else if (name == "mulhu")
+        break;
+    case Opcode::MULHU:
         rd = ((__int128_t)(uint64_t)rs1 * (__int128_t)(uint64_t)rs2) >> 64;
-    else if (name == "div")
+        break;
+    case Opcode::DIV:
         if (rs2 == 0)
             rd = -1; // Division by zero
         else if (rs1 == INT64_MIN && rs2 == -1)
             rd = INT64_MIN; // Overflow
         else
             rd = (int64_t)rs1 / (int64_t)rs2;
-    else if (name == "divu")
+        break;
+    case Opcode::DIVU:
         if (rs2 == 0)
             rd = UINT64_MAX; // Division by zero
         else
             rd = (uint64_t)rs1 / (uint64_t)rs2;
-    else if (name == "rem")
+        break;
+    case Opcode::REM:
         if (rs2 == 0)
             rd = rs1; // Remainder is dividend
         else if (rs1 == INT64_MIN && rs2 == -1)
             rd = 0; // Overflow
         else
             rd = (int64_t)rs1 % (int64_t)rs2;
-    else if (name == "remu")
+        break;
+    case Opcode::REMU:
         if (rs2 == 0)
             rd = rs1; // Remainder is dividend
         else
             rd = (uint64_t)rs1 % (uint64_t)rs2;
+        break;
 
     // --- RV64I Extension (64-bit Base) ---
-    else if (name == "addw")
+    case Opcode::ADDW:
         rd = (int64_t)(int32_t)(rs1 + rs2);
-    else if (name == "subw")
+        break;
+    case Opcode::SUBW:
         rd = (int64_t)(int32_t)(rs1 - rs2);
-    else if (name == "sllw")
+        break;
+    case Opcode::SLLW:
         rd = (int64_t)(int32_t)(rs1 << (rs2 & 0x1F));
-    else if (name == "srlw")
+        break;
+    case Opcode::SRLW:
         rd = (int64_t)(int32_t)((uint32_t)rs1 >> (rs2 & 0x1F));
-    else if (name == "sraw")
+        break;
+    case Opcode::SRAW:
         rd = (int64_t)(int32_t)((int32_t)rs1 >> (rs2 & 0x1F));
+        break;
 
-    else if (name == "ld")
+    case Opcode::LD:
         rd = readMemory(rs1 + imm, MemSize::DoubleWord, false);
-    else if (name == "sd")
+        break;
+    case Opcode::SD:
         writeMemory(rs1 + imm, MemSize::DoubleWord, rs2);
+        break;
 
     // --- RV64M Extension (64-bit Multiply/Divide) ---
-    else if (name == "mulw")
+    case Opcode::MULW:
         rd = (int64_t)(int32_t)(rs1 * rs2);
-    else if (name == "divw")
+        break;
+    case Opcode::DIVW:
     {
         int32_t dividend = rs1;
         int32_t divisor = rs2;
@@ -296,8 +572,9 @@ void Simulator::execute(const InstructionInstance &inst)
             rd = (int64_t)INT32_MIN;
         else
             rd = (int64_t)(dividend / divisor);
+        break;
     }
-    else if (name == "divuw")
+    case Opcode::DIVUW:
     {
         uint32_t dividend = rs1;
         uint32_t divisor = rs2;
@@ -305,8 +582,9 @@ void Simulator::execute(const InstructionInstance &inst)
             rd = -1;
         else
             rd = (int64_t)(int32_t)(dividend / divisor);
+        break;
     }
-    else if (name == "remw")
+    case Opcode::REMW:
     {
         int32_t dividend = rs1;
         int32_t divisor = rs2;
@@ -316,8 +594,9 @@ void Simulator::execute(const InstructionInstance &inst)
             rd = 0;
         else
             rd = (int64_t)(dividend % divisor);
+        break;
     }
-    else if (name == "remuw")
+    case Opcode::REMUW:
     {
         uint32_t dividend = rs1;
         uint32_t divisor = rs2;
@@ -325,76 +604,115 @@ void Simulator::execute(const InstructionInstance &inst)
             rd = (int64_t)(int32_t)dividend;
         else
             rd = (int64_t)(int32_t)(dividend % divisor);
+        break;
     }
 
     // I-type instructions
-    else if (name == "addi")
+    case Opcode::ADDI:
         rd = rs1 + imm;
-    else if (name == "andi")
+        break;
+    case Opcode::ANDI:
         rd = rs1 & imm;
-    else if (name == "ori")
+        break;
+    case Opcode::ORI:
         rd = rs1 | imm;
-    else if (name == "xori")
+        break;
+    case Opcode::XORI:
         rd = rs1 ^ imm;
-    else if (name == "slli")
+        break;
+    case Opcode::SLLI:
         rd = rs1 << (imm & 0x3F);
-    else if (name == "srli")
-        rd = ((uint32_t)rs1) >> (imm & 0x1F); // logical shift right
-    else if (name == "srai")
-        rd = (int32_t)rs1 >> (imm & 0x1F);
+        break;
+    case Opcode::SRLI:
+        // logical shift right
+        rd = xlen64 ? (int64_t)((uint64_t)rs1 >> (imm & 0x3F)) : ((uint32_t)rs1) >> (imm & 0x1F);
+        break;
+    case Opcode::SRAI:
+        rd = xlen64 ? rs1 >> (imm & 0x3F) : (int32_t)rs1 >> (imm & 0x1F);
+        break;
 
     // --- RV64I Extension (64-bit Base) ---
-    else if (name == "addiw")
+    case Opcode::ADDIW:
+    {
+        int64_t simm = (int64_t)((int32_t)(imm << 20) >> 20);
         rd = (int64_t)(int32_t)(rs1 + simm);
-    else if (name == "slliw")
+        break;
+    }
+    case Opcode::SLLIW:
         rd = (int64_t)(int32_t)(((uint32_t)rs1) << (imm & 0x1F));
-    else if (name == "srliw")
+        break;
+    case Opcode::SRLIW:
         rd = (int64_t)(int32_t)((uint32_t)rs1 >> (imm & 0x1F));
-    else if (name == "sraiw")
+        break;
+    case Opcode::SRAIW:
         rd = (int64_t)(int32_t)((int32_t)rs1 >> (imm & 0x1F));
+        break;
 
     // Load instructions
-    else if (name == "lw")
+    case Opcode::LW:
         rd = readMemory(rs1 + imm, MemSize::Word, false);
-    else if (name == "lh")
+        break;
+    case Opcode::LH:
         rd = (int16_t)readMemory(rs1 + imm, MemSize::HalfWord, false);
-    else if (name == "lb")
+        break;
+    case Opcode::LB:
         rd = (int8_t)readMemory(rs1 + imm, MemSize::Byte, false);
-    else if (name == "lhu")
+        break;
+    case Opcode::LHU:
         rd = readMemory(rs1 + imm, MemSize::HalfWord, true);
-    else if (name == "lbu")
+        break;
+    case Opcode::LBU:
         rd = readMemory(rs1 + imm, MemSize::Byte, true);
+        break;
 
     // 64-bit load/store (assuming MemSize::DoubleWord is defined)
-    else if (name == "lwu")
+    case Opcode::LWU:
         rd = readMemory(rs1 + imm, MemSize::Word, true); // Load word (32 bits) with zero extension
+        break;
 
     // Store instructions
-    else if (name == "sw")
+    case Opcode::SW:
         writeMemory(rs1 + imm, MemSize::Word, rs2);
-    else if (name == "sh")
+        break;
+    case Opcode::SH:
         writeMemory(rs1 + imm, MemSize::HalfWord, rs2);
-    else if (name == "sb")
+        break;
+    case Opcode::SB:
         writeMemory(rs1 + imm, MemSize::Byte, rs2);
+        break;
 
     // Branch instructions -
-    else if (name == "beq" && rs1 == rs2)
-        pc += imm - 4; // Subtract 4 because PC will be incremented after instruction
-    else if (name == "bne" && rs1 != rs2)
-        pc += imm - 4; // Subtract 4 because PC will be incremented after instruction
-    else if (name == "blt" && (int32_t)rs1 < (int32_t)rs2)
-        pc += imm - 4; // Subtract 4 because PC will be incremented after instruction
-    else if (name == "bge" && (int32_t)rs1 >= (int32_t)rs2)
-        pc += imm - 4; // Subtract 4 because PC will be incremented after instruction
-    else if (name == "bltu" && (uint32_t)rs1 < (uint32_t)rs2)
-        pc += imm - 4; // Subtract 4 because PC will be incremented after instruction
-    else if (name == "bgeu" && (uint32_t)rs1 >= (uint32_t)rs2)
-        pc += imm - 4; // Subtract 4 because PC will be incremented after instruction
+    // Subtract 4 from the target because PC will be incremented after instruction.
+    // Registers hold sign-extended values in RV32 modes, so 64-bit compares give the
+    // 32-bit answers there too.
+    case Opcode::BEQ:
+        if (rs1 == rs2)
+            pc += imm - 4;
+        break;
+    case Opcode::BNE:
+        if (rs1 != rs2)
+            pc += imm - 4;
+        break;
+    case Opcode::BLT:
+        if (rs1 < rs2)
+            pc += imm - 4;
+        break;
+    case Opcode::BGE:
+        if (rs1 >= rs2)
+            pc += imm - 4;
+        break;
+    case Opcode::BLTU:
+        if ((uint64_t)rs1 < (uint64_t)rs2)
+            pc += imm - 4;
+        break;
+    case Opcode::BGEU:
+        if ((uint64_t)rs1 >= (uint64_t)rs2)
+            pc += imm - 4;
+        break;
 
     // Jump instructions
-    else if (name == "jal")
+    case Opcode::JAL:
     {
-
         // save the next instruction before jumping
         int nextInstr = pc + 4;
 
@@ -414,10 +732,10 @@ void Simulator::execute(const InstructionInstance &inst)
         }
         // Subtract 4 because PC will be incremented after instruction
         pc = pc - 4;
+        break;
     }
-    else if (name == "jalr")
+    case Opcode::JALR:
     {
-
         // Always update PC, regardless of whether it's a call or return
         pc = (rs1 + imm) & ~1; // Clear lowest bit as per RISC-V spec
 
@@ -441,42 +759,28 @@ void Simulator::execute(const InstructionInstance &inst)
         // Not Return: jalr x1, func, 0 (this is a call)
         // Adjust because PC will be incremented after each instruction in step
         pc = pc - 4;
+        break;
     }
-    else if (name == "lui")
-    {
+    case Opcode::LUI:
         // Upper immediate instructions
         //  U-type instructions like LUI and AUIPC use this format:
         // [ imm[31:12] | rd | opcode ]: The immediate is 20 bits, but it is placed in bits 31 to 12.
         // When executed, this 20-bit value is shifted left by 12 bits, so:
         // lui x1, 0x10000 means: x1 = 0x10000 << 12 = 0x10000000
-        rd = imm << 12;
-    }
-    else if (name == "auipc")
-    {
-        rd = pc + (imm << 12);
-    }
-
-    // Check if instruction writes to a register
-    bool writesToRegister = (name == "add" || name == "sub" || name == "and" || name == "or" || name == "xor" ||
-                             name == "sll" || name == "srl" || name == "sra" ||
-                             name == "addi" || name == "andi" || name == "ori" || name == "xori" ||
-                             name == "slli" || name == "srli" || name == "srai" ||
-                             name == "lw" || name == "lh" || name == "lb" || name == "lhu" || name == "lbu" ||
-                             /*name == "jal" || name == "jalr" || */ name == "lui" || name == "auipc" ||
-                             // RV32M
-                             name == "mul" ||
-                             name == "mulh" || name == "mulhsu" || name == "mulhu" ||
-                             name == "div" || name == "divu" || name == "rem" || name == "remu" ||
-                             // RV64I
-                             name == "addw" || name == "subw" || name == "sllw" || name == "srlw" || name == "sraw" ||
-                             name == "addiw" || name == "slliw" || name == "srliw" || name == "sraiw" ||
-                             name == "ld" || name == "lwu" ||
-                             // RV64M
-                             name == "mulw" || name == "divw" || name == "divuw" || name == "remw" || name == "remuw");
+        // the 32-bit result is sign-extended in RV64
+        rd = (int32_t)(imm << 12);
+        break;
+    case Opcode::AUIPC:
+        rd = pc + (int64_t)(int32_t)(imm << 12);
+        break;
+
+    default:
+        break;
+    }
 
     // Impt: do not write to register for jal and jalr here
     // Update destination register if needed
-    if (writesToRegister && inst.rd != 0)
+    if (opcodeWritesRd(op) && inst.rd != 0)
     {
         setRegValue(inst.rd, rd);
     }
@@ -550,6 +854,16 @@ void Simulator::enableCache(const std::string &configFile)
     }
 }
 
+void Simulator::enableCache(const CacheConfig &config)
+{
+    cacheSim.enable(config, memory);
+}
+
+void Simulator::flushCache()
+{
+    cacheSim.writeBack();
+}
+
 void Simulator::disableCache()
 {
     cacheSim.disable();
@@ -570,28 +884,298 @@ void Simulator::printCacheStats() const
     cacheSim.printStats(out);
 }
 
-int Simulator::readMemory(uint32_t addr, MemSize size, bool isUnsigned)
+// pc is the load/store's own address here: executeAtPC() advances it only afterwards, and
+// compiled JIT blocks set it from the PC each access passes to jitLoad()/jitStore()
+int64_t Simulator::readMemory(uint64_t addr, MemSize size, bool isUnsigned)
 {
     if (cacheSim.isEnabled())
     {
-        return cacheSim.read(addr, size, isUnsigned);
+        return cacheSim.read(addr, size, isUnsigned, static_cast<uint64_t>(pc));
+    }
+    if (memoryLock)
+    {
+        std::lock_guard<std::mutex> guard(*memoryLock);
+        return activeMemory->read(addr, size, isUnsigned);
     }
-    return memory.read(addr, size, isUnsigned);
+    return activeMemory->read(addr, size, isUnsigned);
 }
 
-void Simulator::writeMemory(uint32_t addr, MemSize size, uint32_t val)
+void Simulator::writeMemory(uint64_t addr, MemSize size, uint64_t val)
 {
     if (cacheSim.isEnabled())
     {
-        cacheSim.write(addr, size, val);
+        uint64_t stallsBefore = cacheSim.getCache().getWriteBufferStallCycles();
+        cacheSim.write(addr, size, val, static_cast<uint64_t>(pc));
+        uint64_t stalls = cacheSim.getCache().getWriteBufferStallCycles() - stallsBefore;
+        if (stalls && hazardDetector.isPipelineEnabled())
+            hazardDetector.addWriteBufferStalls(static_cast<int>(stalls));
+        return;
+    }
+    if (memoryLock)
+    {
+        std::lock_guard<std::mutex> guard(*memoryLock);
+        activeMemory->write(addr, size, val);
         return;
     }
-    memory.write(addr, size, val);
+    activeMemory->write(addr, size, val);
 }
 
 void Simulator::printMemory(uint32_t address, uint32_t count) const
 {
-    memory.print(address, count);
+    activeMemory->print(address, count);
+}
+
+bool Simulator::mapFile(const std::string &path, uint32_t guestAddress, Memory::MapMode mode)
+{
+    if (cacheSim.isEnabled())
+    {
+        // cached blocks of the range would hide the file; store them first, then drop them
+        cacheSim.writeBack();
+        cacheSim.invalidate();
+    }
+    return activeMemory->mapFile(path, guestAddress, mode);
+}
+
+uint64_t Simulator::programFingerprint() const
+{
+    uint64_t hash = fnv1a64(nullptr, 0);
+    for (const PackedInstruction &inst : packedProgram)
+    {
+        // field by field, so padding bytes never enter the hash
+        const int32_t fields[] = {static_cast<int32_t>(inst.op), inst.rd, inst.rs1, inst.rs2, inst.imm};
+        hash = fnv1a64(fields, sizeof(fields), hash);
+    }
+    return hash;
+}
+
+bool Simulator::saveCheckpoint(std::ostream &file) const
+{
+    CheckpointWriter writer;
+    writer.writeU32(static_cast<uint32_t>(isaMode));
+    writer.writeU64(programFingerprint());
+    writer.writeU32(static_cast<uint32_t>(program.size()));
+    writer.writeI32(pc);
+    for (int64_t reg : regs)
+        writer.writeI64(reg);
+    writer.writeU64(instructionCount);
+    writer.writeBool(exited);
+    writer.writeI32(exitCode);
+    writer.writeBool(resumedFromBreakpoint);
+
+    activeMemory->saveState(writer);
+    shadowCallStack.saveState(writer);
+    cacheSim.saveState(writer);
+    hazardDetector.saveState(writer);
+    return writer.writeTo(file);
 }
 
+bool Simulator::saveCheckpoint(const std::string &filename) const
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file || !saveCheckpoint(file))
+    {
+        out << "Error: Could not write checkpoint file " << filename << "\n";
+        return false;
+    }
+    return true;
+}
 
+bool Simulator::loadCheckpoint(std::istream &file)
+{
+    CheckpointReader reader;
+    if (!reader.readFrom(file))
+    {
+        out << "Error: " << reader.getError() << "\n";
+        return false;
+    }
+    // registers are read back at the checkpoint's XLEN, so the mode must match
+    ISAMode mode = static_cast<ISAMode>(reader.readU32());
+    if (mode != isaMode)
+    {
+        out << "Error: checkpoint was saved in " << isaModeToString(mode) << " mode, simulator is in "
+            << isaModeToString(isaMode) << " mode\n";
+        return false;
+    }
+    uint64_t fingerprint = reader.readU64();
+    uint32_t programSize = reader.readU32();
+    if (fingerprint != programFingerprint() || programSize != program.size())
+    {
+        out << "Error: checkpoint was saved with a different program; load that program first\n";
+        return false;
+    }
+
+    pc = reader.readI32();
+    for (int64_t &reg : regs)
+        reg = reader.readI64();
+    instructionCount = reader.readU64();
+    exited = reader.readBool();
+    exitCode = reader.readI32();
+    resumedFromBreakpoint = reader.readBool();
+    pcHistory.clear();
+
+    bool restored = activeMemory->loadState(reader) && shadowCallStack.loadState(reader) &&
+                    cacheSim.loadState(reader, memory) && hazardDetector.loadState(reader);
+    if (!restored)
+    {
+        // the payload passed its hash check, so this only happens for inconsistent files
+        out << "Error: checkpoint contents are inconsistent; simulator state was reset\n";
+        resetRegsMemStack();
+        return false;
+    }
+    return true;
+}
+
+bool Simulator::loadCheckpoint(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        out << "Error: Could not open checkpoint file " << filename << "\n";
+        return false;
+    }
+    return loadCheckpoint(file);
+}
+
+std::shared_ptr<const Simulator::Snapshot> Simulator::takeSnapshot()
+{
+    // memory must be current before its pages are shared
+    cacheSim.writeBack();
+
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->mode = isaMode;
+    snapshot->program = program;
+    snapshot->packedProgram = packedProgram;
+    snapshot->sourceLines = sourceLines;
+    snapshot->pc = pc;
+    std::copy(std::begin(regs), std::end(regs), std::begin(snapshot->regs));
+    snapshot->instructionCount = instructionCount;
+    snapshot->exited = exited;
+    snapshot->exitCode = exitCode;
+    snapshot->callStack.copyFramesFrom(shadowCallStack);
+    snapshot->memory = activeMemory->snapshot();
+    return snapshot;
+}
+
+bool Simulator::restoreSnapshot(const Snapshot &snapshot)
+{
+    if (snapshot.mode != isaMode)
+    {
+        out << "Error: snapshot was taken in " << isaModeToString(snapshot.mode) << " mode, simulator is in "
+            << isaModeToString(isaMode) << " mode\n";
+        return false;
+    }
+    reset();
+    program = snapshot.program;
+    packedProgram = snapshot.packedProgram;
+    sourceLines = snapshot.sourceLines;
+    pc = snapshot.pc;
+    std::copy(std::begin(snapshot.regs), std::end(snapshot.regs), std::begin(regs));
+    instructionCount = snapshot.instructionCount;
+    exited = snapshot.exited;
+    exitCode = snapshot.exitCode;
+    shadowCallStack.copyFramesFrom(snapshot.callStack);
+    activeMemory->restore(*snapshot.memory);
+    return true;
+}
+
+void Simulator::enableDirtyTracking()
+{
+    activeMemory->enableDirtyTracking();
+}
+
+std::vector<uint8_t> Simulator::getDirtyRegionsSince(uint64_t epoch)
+{
+    // stores still in dirty write-back lines or the write buffer must reach memory to show up
+    cacheSim.writeBack();
+
+    std::vector<uint8_t> buffer;
+    auto append = [&buffer](uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+            buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    };
+
+    bool replaced = false;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges = activeMemory->getDirtyRangesSince(epoch, replaced);
+    bool allRegisters = epoch == 0 || epoch != diffEpoch;
+    uint64_t newEpoch = activeMemory->nextEpoch();
+
+    append(newEpoch, 8);
+    append(replaced ? 1 : 0, 1);
+    append(static_cast<uint32_t>(pc), 4);
+
+    size_t countAt = buffer.size();
+    append(0, 1);
+    uint8_t changed = 0;
+    for (int i = 0; i < 32; ++i)
+    {
+        if (allRegisters || regs[i] != diffRegs[i])
+        {
+            append(i, 1);
+            append(static_cast<uint64_t>(regs[i]), 8);
+            ++changed;
+        }
+        diffRegs[i] = regs[i];
+    }
+    buffer[countAt] = changed;
+    diffEpoch = newEpoch;
+
+    append(ranges.size(), 4);
+    for (const auto &[address, length] : ranges)
+    {
+        append(address, 4);
+        append(length, 4);
+        size_t offset = buffer.size();
+        buffer.resize(offset + length);
+        activeMemory->readBytes(address, buffer.data() + offset, length);
+    }
+    return buffer;
+}
+
+bool Simulator::startTrace(const std::string &filename)
+{
+    stopTrace();
+    auto writer = std::make_unique<TraceWriter>();
+    if (!writer->open(filename))
+    {
+        out << "Error: Could not create trace file " << filename << "\n";
+        return false;
+    }
+    traceWriter = std::move(writer);
+    traceFile = filename;
+    return true;
+}
+
+void Simulator::stopTrace()
+{
+    if (!traceWriter)
+        return;
+    bool ok = traceWriter->close();
+    out << "Trace " << traceFile << ": " << traceWriter->getRecordCount() << " instructions, "
+        << traceWriter->getBytesWritten() << " bytes\n";
+    if (!ok)
+        out << "Error: writing trace file " << traceFile << " failed\n";
+    traceWriter.reset();
+}
+
+void Simulator::traceInstruction(int instructionPC, const PackedInstruction &inst, uint64_t accessAddress)
+{
+    TraceRecord record;
+    record.pc = static_cast<uint32_t>(instructionPC);
+    record.op = inst.op;
+    // jal links through setRegValue itself, so opcodeWritesRd() leaves it out
+    if (inst.rd != 0 && (opcodeWritesRd(inst.op) || inst.op == Opcode::JAL))
+    {
+        record.writesRd = true;
+        record.rd = inst.rd;
+        record.rdValue = regs[inst.rd];
+    }
+    if (int size = opcodeAccessSize(inst.op))
+    {
+        record.accessesMemory = true;
+        record.isStore = opcodeIsStore(inst.op);
+        record.size = static_cast<uint8_t>(size);
+        record.address = accessAddress;
+    }
+    traceWriter->write(record);
+}
@@ -13,6 +13,13 @@
 #include "PipelineSimulator.h"
 #include "Memory.h"
 #include "HazardDetector.h"
+#include "PackedInstruction.h"
+#include "TranslationCache.h"
+#include "JitCompiler.h"
+#include "PcHistory.h"
+#include "Trace.h"
+#include <memory>
+#include <mutex>
 
 class Simulator : public ExecutionEngine
 {
@@ -20,11 +27,61 @@ class Simulator : public ExecutionEngine
 public:
     Simulator(std::istream &in = std::cin, std::ostream &out = std::cout, ISAMode mode = ISAMode::RV32I)
         : in(in), out(out), assembler(in, out, mode), breakpointInfo(in, out), memory(out), 
-        hazardDetector(in,out), shadowCallStack(in, out)  {}
+        hazardDetector(in,out), shadowCallStack(in, out)
+    {
+        isaMode = mode;
+        xlen64 = (mode == ISAMode::RV64I || mode == ISAMode::RV64IM);
+        // A breakpoint changes where basic blocks end: drop blocks containing its PC, and
+        // the block ending just before it (which may now continue through that PC)
+        breakpointInfo.setChangeListener([this](int bpPC)
+                                         { translationCache.invalidate(bpPC);
+                                           translationCache.invalidate(bpPC - 4); });
+    }
+    // Copy-on-write image of a Simulator's state: program, registers, pc, instruction count,
+    // call stack and memory. The memory pages are shared, not copied (see Memory::Snapshot),
+    // so one snapshot can seed many Simulators cheaply, also on different threads.
+    struct Snapshot
+    {
+        ISAMode mode = ISAMode::RV32I;
+        std::vector<InstructionInstance> program;
+        std::vector<PackedInstruction> packedProgram;
+        std::vector<int> sourceLines;
+        int pc = 0;
+        int64_t regs[32] = {0};
+        uint64_t instructionCount = 0;
+        bool exited = false;
+        int exitCode = 0;
+        ShadowCallStack callStack;
+        std::shared_ptr<const Memory::Snapshot> memory;
+    };
+
+    // Starts in the state of snapshot. The cache, JIT, breakpoints and pipeline statistics start
+    // off/empty as in a new Simulator, and the assembler is empty, so breakpoints by source line
+    // and names of functions called after the snapshot are not available.
+    explicit Simulator(const Snapshot &snapshot, std::istream &in = std::cin, std::ostream &out = std::cout)
+        : Simulator(in, out, snapshot.mode)
+    {
+        restoreSnapshot(snapshot);
+    }
+
     // load the program into the simulator
     void load(const std::vector<InstructionInstance> &instructions) override;
     // this will run until the program ends or a breakpoint is hit
     void run() override;
+
+    // Why runFor() returned
+    enum class RunResult
+    {
+        FINISHED,      // pc left the program (end of program or ecall)
+        BREAKPOINT,    // stopped in front of a breakpoint
+        PAUSED,        // ebreak
+        LIMIT_REACHED, // executed at least instructionLimit instructions in total
+        ERROR          // pc is not an instruction address, or lockstep mismatch
+    };
+    // Runs like run() until getInstructionCount() reaches instructionLimit. The limit is
+    // checked at block boundaries, so a run may overshoot it by up to one basic block.
+    // Prints no "Program completed" line; used to interleave several harts.
+    RunResult runFor(uint64_t instructionLimit);
     // this will run one instruction and return next line number to be executed
     int step() override;
     // this will reset the simulator
@@ -47,7 +104,8 @@ public:
     void initializeRegisters();
 
     // track anyone setting special register values like x[0] and x[1]
-    void setRegValue(int regNum, int value);
+    // In RV32 modes the value is truncated to 32 bits and sign-extended.
+    void setRegValue(int regNum, int64_t value);
 
     Assembler &getAssembler()
     {
@@ -56,6 +114,10 @@ public:
     // Does the overall simulation, integrating cache and pipeline simulators.
     // Cache related
     void enableCache(const std::string &configFile);
+    // starts with an empty cache built from an already loaded config
+    void enableCache(const CacheConfig &config);
+    // writes dirty cache blocks back to memory (before disabling the cache mid-run)
+    void flushCache();
     void disableCache();
     void invalidateCache();
     void dumpCache(const std::string &filename) const;
@@ -70,6 +132,111 @@ public:
     {
         return pc;
     }
+
+    // the decoded instruction at pc, or nullptr if pc is not an instruction address
+    const PackedInstruction *getInstructionAt(int pc) const
+    {
+        if (pc < 0 || pc % 4 != 0 || pc / 4 >= (int)packedProgram.size())
+            return nullptr;
+        return &packedProgram[pc / 4];
+    }
+
+    // number of instructions executed since the last load/reset
+    uint64_t getInstructionCount() const
+    {
+        return instructionCount;
+    }
+
+    // true once an ecall ended the program; getExitCode() is then the value of a0
+    bool hasExited() const
+    {
+        return exited;
+    }
+    int getExitCode() const
+    {
+        return exitCode;
+    }
+
+    // Quiet mode: no per-instruction trace and no call stack dumps on return, for long runs.
+    // Executed PCs are still kept in a ring buffer; see dumpPcHistory().
+    void setQuiet(bool isQuiet);
+    bool isQuiet() const
+    {
+        return quiet;
+    }
+    // prints the most recently executed instructions, oldest first
+    void dumpPcHistory() const;
+
+    // Checkpoints: registers, pc, instruction count, memory, cache (blocks, dirty data and
+    // replacement metadata), call stack and pipeline statistics. A checkpoint can only be
+    // loaded into a Simulator in the same ISA mode with the same program loaded. Errors are
+    // printed to out.
+    bool saveCheckpoint(const std::string &filename) const;
+    bool loadCheckpoint(const std::string &filename);
+    bool saveCheckpoint(std::ostream &file) const;
+    bool loadCheckpoint(std::istream &file);
+
+    // Captures the current state. Dirty cache blocks are written back first (they stay cached,
+    // clean), so the snapshot's memory is current.
+    std::shared_ptr<const Snapshot> takeSnapshot();
+    // Replaces program, registers, pc and memory with the snapshot's, like load() followed by
+    // running to the snapshot point; the cache is invalidated. The ISA mode must match.
+    bool restoreSnapshot(const Snapshot &snapshot);
+
+    // Binary execution trace (see Trace.h): pc, opcode, rd value and memory access of every
+    // executed instruction, written by a background thread. JIT-compiled blocks are not run
+    // while tracing. startTrace() prints an error and returns false if the file cannot be created.
+    bool startTrace(const std::string &filename);
+    // Finishes the file and prints how many instructions it holds
+    void stopTrace();
+    bool isTracing() const
+    {
+        return traceWriter != nullptr;
+    }
+
+    // Incremental state for front ends (the web UI). enableDirtyTracking() turns on dirty-page
+    // tracking in memory; each getDirtyRegionsSince(epoch) then encodes what changed since
+    // `epoch` and starts a new epoch. Pass 0 for the full state, then the epoch from the
+    // previous result. Little-endian:
+    //   u64 new epoch | u8 flags (bit 0: memory was replaced; forget cached contents) | u32 pc
+    //   u8 n, n x (u8 register, i64 value): registers changed since the previous call (all 32
+    //     unless `epoch` is the one that call returned)
+    //   u32 m, m x (u32 address, u32 length, bytes): dirty memory, page-aligned, address order
+    // With the cache simulator on, dirty lines (and pending write-buffer stores) are first
+    // written back, as for takeSnapshot(), so the diff shows every store the program made; the
+    // lines stay cached, now clean, so later evictions skip those write-backs.
+    void enableDirtyTracking();
+    std::vector<uint8_t> getDirtyRegionsSince(uint64_t epoch);
+
+    // JIT: compile basic blocks to native code once they have run hotThreshold times.
+    // Returns false (and keeps interpreting) if the host has no JIT backend.
+    bool enableJit(uint32_t hotThreshold = JitCompiler::DEFAULT_HOT_THRESHOLD);
+    bool isJitEnabled() const
+    {
+        return jit != nullptr;
+    }
+    // Lockstep validation: after every block, step `reference` (an interpreter-only Simulator
+    // loaded with the same program) over the same instructions and compare registers and pc.
+    // run() stops at the first difference.
+    void setLockstepReference(Simulator *reference)
+    {
+        lockstepReference = reference;
+    }
+    bool hasLockstepMismatch() const
+    {
+        return lockstepMismatch;
+    }
+    // Multi-hart: loads, stores and memory dumps go to `shared` instead of this Simulator's own
+    // memory. If `lock` is given, every access holds it (harts running on several threads).
+    // The cache simulator is not shared and must stay disabled.
+    void attachSharedMemory(Memory *shared, std::mutex *lock = nullptr)
+    {
+        activeMemory = shared ? shared : &memory;
+        memoryLock = lock;
+    }
+    // Maps a host file into guest memory (see Memory::mapFile). Loading a program clears
+    // memory, so map after load().
+    bool mapFile(const std::string &path, uint32_t guestAddress, Memory::MapMode mode = Memory::MapMode::READ_ONLY);
     //void enableHazardDetection(bool enable = true, PipelineType type = PIPELINE_5_STAGE);
     //void analyzeHazards() ;
     //void performanceAnalysis() ;
@@ -83,18 +250,25 @@ protected:
     // break points with  program counter as key and original assembly line as value
     BreakPointInfo breakpointInfo;
 
-    void writeMemory(uint32_t addr, MemSize size, uint32_t val);
-    int readMemory(uint32_t addr, MemSize size, bool isUnsigned);
+    void writeMemory(uint64_t addr, MemSize size, uint64_t val);
+    int64_t readMemory(uint64_t addr, MemSize size, bool isUnsigned);
 
     CacheSimulator cacheSim;
 
     // simple byte-addressable memory
     Memory memory;
+    // memory that loads and stores use: `memory`, or the one shared by all harts
+    Memory *activeMemory = &memory;
+    std::mutex *memoryLock = nullptr;
 
     HazardDetector hazardDetector;
 
-    // list of instructions
+    // list of instructions; cold side table, only used to print source text
     std::vector<InstructionInstance> program;
+    // packedProgram[i] is the compact decoded form of program[i] that execution reads; filled in by load()
+    std::vector<PackedInstruction> packedProgram;
+    // sourceLines[i] is the assembly source line of program[i]; filled in by load()
+    std::vector<int> sourceLines;
 
     
     // this is the offset from base addr of the next instruction to be executed in bytes. pc/4 is instruction number
@@ -117,10 +291,57 @@ private:
 
     // registers; RISC-V has 32 registers; x0 is hardwired to 0
     int64_t regs[32] = {0};
+    // RV64 modes keep all 64 bits of a register; RV32 modes keep 32 bits, sign-extended
+    bool xlen64 = false;
+    ISAMode isaMode = ISAMode::RV32I;
+
+    // instructions executed since the last load/reset
+    uint64_t instructionCount = 0;
+
+    // set by ecall; cleared with the registers
+    bool exited = false;
+    int exitCode = 0;
+
+    bool quiet = false;
+    // last executed PCs; cleared with the registers
+    PcHistory pcHistory;
 
-    void execute(const InstructionInstance &inst);
+    // basic blocks of the loaded program, used by run()
+    TranslationCache translationCache;
+
+    void execute(const PackedInstruction &inst);
+    // executes one instruction at pc with the bookkeeping shared by step() and run()
+    void executeAtPC(const PackedInstruction &inst, int sourceLine);
+    // executes a whole basic block, natively if the JIT has compiled it
+    void executeBlock(BasicBlock &block);
+    void executeCompiledBlock(const BasicBlock &block);
+    // source line of the instruction at pc, 0 if there is none
+    int sourceLineAt(int pc) const;
     void resetRegsMemStack();
+    // identifies the loaded program in checkpoints
+    uint64_t programFingerprint() const;
 
     std::string programName;
+
+    std::unique_ptr<JitCompiler> jit;
+    uint32_t jitHotThreshold = JitCompiler::DEFAULT_HOT_THRESHOLD;
+    JitContext jitContext{};
+    // callbacks used by compiled code; owner is the Simulator
+    static int64_t jitLoad(void *owner, uint64_t addr, uint32_t op, uint32_t pc);
+    static void jitStore(void *owner, uint64_t addr, uint32_t op, int64_t value, uint32_t pc);
+    static void jitInterpret(void *owner, const TranslatedOp *op);
+
+    std::unique_ptr<TraceWriter> traceWriter;
+    std::string traceFile;
+    void traceInstruction(int instructionPC, const PackedInstruction &inst, uint64_t accessAddress);
+
+    // registers and epoch as of the last getDirtyRegionsSince() call
+    int64_t diffRegs[32] = {0};
+    uint64_t diffEpoch = 0;
+
+    Simulator *lockstepReference = nullptr;
+    bool lockstepMismatch = false;
+    // steps the reference over `count` instructions and compares; false on mismatch
+    bool checkLockstep(uint64_t count, int blockPC);
 };
 #endif
\ No newline at end of file
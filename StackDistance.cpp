@@ -0,0 +1,165 @@
+/**
+ * @file StackDistance.cpp
+ * @brief Fenwick-tree stack-distance histogram and miss-ratio curve.
+ */
+#include "StackDistance.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    const uint32_t INITIAL_CAPACITY = 64;
+}
+
+StackDistanceProfiler::StackDistanceProfiler(uint32_t blockSize, uint32_t setCount, uint32_t maxAssociativity)
+    : blockSize(blockSize), setCount(setCount), maxAssociativity(maxAssociativity), sets(setCount),
+      histogram(maxAssociativity, 0)
+{
+    while ((1u << offsetBits) < blockSize)
+        ++offsetBits;
+}
+
+void StackDistanceProfiler::add(SetStack &set, uint32_t position, int32_t delta)
+{
+    for (; position < set.tree.size(); position += position & (~position + 1))
+        set.tree[position] += delta;
+}
+
+uint32_t StackDistanceProfiler::prefixSum(const SetStack &set, uint32_t position)
+{
+    uint32_t sum = 0;
+    for (; position > 0; position -= position & (~position + 1))
+        sum += set.tree[position];
+    return sum;
+}
+
+void StackDistanceProfiler::compact(SetStack &set)
+{
+    // keep only the latest access of every block, in timestamp order
+    std::vector<uint64_t> live;
+    for (uint32_t t = 1; t <= set.now; ++t)
+    {
+        auto it = lastAccess.find(set.blockAt[t]);
+        if (it != lastAccess.end() && it->second == t)
+            live.push_back(set.blockAt[t]);
+    }
+    uint32_t capacity = std::max<uint32_t>(INITIAL_CAPACITY, static_cast<uint32_t>(live.size()) * 2);
+    set.blockAt.assign(capacity + 1, 0);
+    set.tree.assign(capacity + 1, 0);
+    set.now = 0;
+    for (uint64_t block : live)
+    {
+        ++set.now;
+        set.blockAt[set.now] = block;
+        lastAccess[block] = set.now;
+        set.tree[set.now] = 1;
+    }
+    // O(n) Fenwick construction: push each node's sum to its parent
+    for (uint32_t i = 1; i <= capacity; ++i)
+    {
+        uint32_t parent = i + (i & (~i + 1));
+        if (parent <= capacity)
+            set.tree[parent] += set.tree[i];
+    }
+}
+
+void StackDistanceProfiler::access(uint64_t address)
+{
+    uint64_t block = address >> offsetBits;
+    SetStack &set = sets[block & (setCount - 1)];
+    ++accesses;
+    if (set.now + 1 >= set.tree.size())
+        compact(set);
+
+    uint32_t now = ++set.now;
+    set.blockAt[now] = block;
+    auto inserted = lastAccess.emplace(block, now);
+    if (inserted.second)
+    {
+        ++coldMisses;
+    }
+    else
+    {
+        uint32_t previous = inserted.first->second;
+        // blocks whose latest access is after `previous`: each one is above this block in the stack
+        uint32_t distance = prefixSum(set, now - 1) - prefixSum(set, previous);
+        if (distance < maxAssociativity)
+            ++histogram[distance];
+        add(set, previous, -1);
+        inserted.first->second = now;
+    }
+    add(set, now, 1);
+}
+
+void StackDistanceProfiler::accessBatch(const CacheAccess *batch, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        access(batch[i].address);
+}
+
+uint64_t StackDistanceProfiler::getMisses(uint32_t associativity) const
+{
+    uint64_t hits = 0;
+    for (uint32_t d = 0; d < associativity && d < maxAssociativity; ++d)
+        hits += histogram[d];
+    return accesses - hits;
+}
+
+std::vector<StackDistanceProfiler::CurvePoint> StackDistanceProfiler::missRatioCurve() const
+{
+    std::vector<CurvePoint> curve;
+    uint64_t hits = 0;
+    uint32_t counted = 0;
+    for (uint32_t ways = 1; ways <= maxAssociativity; ways *= 2)
+    {
+        for (; counted < ways; ++counted)
+            hits += histogram[counted];
+        CurvePoint point;
+        point.associativity = ways;
+        point.cacheSize = static_cast<uint64_t>(setCount) * ways * blockSize;
+        point.misses = accesses - hits;
+        point.missRatio = accesses ? static_cast<double>(point.misses) / accesses : 0.0;
+        curve.push_back(point);
+        if (ways > UINT32_MAX / 2)
+            break;
+    }
+    return curve;
+}
+
+void StackDistanceProfiler::writeCsv(std::ostream &out, const std::vector<StackDistanceProfiler> &profilers)
+{
+    out << "block_size,sets,associativity,cache_size,accesses,misses,miss_ratio\n";
+    for (const auto &profiler : profilers)
+    {
+        for (const CurvePoint &point : profiler.missRatioCurve())
+        {
+            out << profiler.blockSize << "," << profiler.setCount << "," << point.associativity << ","
+                << point.cacheSize << "," << profiler.accesses << "," << point.misses << "," << std::fixed
+                << std::setprecision(6) << point.missRatio << "\n";
+            out.unsetf(std::ios::floatfield);
+        }
+    }
+}
+
+void StackDistanceProfiler::writeJson(std::ostream &out, const std::vector<StackDistanceProfiler> &profilers)
+{
+    out << "[\n";
+    for (size_t i = 0; i < profilers.size(); ++i)
+    {
+        const StackDistanceProfiler &profiler = profilers[i];
+        out << "  {\"block_size\": " << profiler.blockSize << ", \"sets\": " << profiler.setCount
+            << ", \"accesses\": " << profiler.accesses << ", \"cold_misses\": " << profiler.coldMisses
+            << ", \"curve\": [";
+        std::vector<CurvePoint> curve = profiler.missRatioCurve();
+        for (size_t j = 0; j < curve.size(); ++j)
+        {
+            out << (j ? ", " : "") << "{\"associativity\": " << curve[j].associativity << ", \"cache_size\": "
+                << curve[j].cacheSize << ", \"misses\": " << curve[j].misses << ", \"miss_ratio\": "
+                << std::fixed << std::setprecision(6) << curve[j].missRatio << "}";
+            out.unsetf(std::ios::floatfield);
+        }
+        out << "]}" << (i + 1 < profilers.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
@@ -0,0 +1,103 @@
+/**
+ * @class StackDistanceProfiler
+ * @brief One-pass LRU stack-distance (Mattson) profile of an address trace.
+ *
+ * For a fixed block size and set count, the stack distance of an access is the number of
+ * distinct other blocks of the same set touched since the previous access to its block
+ * (infinite on the first access). An LRU cache with A ways per set hits exactly the accesses
+ * with distance < A, so one histogram of distances gives the misses of every associativity,
+ * i.e. the whole miss-ratio curve over cache size, in one pass.
+ *
+ * Each set keeps a Fenwick tree over its access timestamps, with a 1 at every timestamp that
+ * is the latest access of its block. The distance of an access is the sum between the
+ * block's previous timestamp and now, so each access costs O(log n). When a set runs out of
+ * timestamps, its live entries are renumbered from 1 and the tree is rebuilt.
+ *
+ * The model is write-allocate LRU: reads and writes alike move their block to the top of the
+ * stack, as Cache does with the WB write policy. (WT does not allocate on a write miss, so its
+ * contents are not an LRU stack and it has no single-pass curve.)
+ */
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include "Cache.h"
+
+class StackDistanceProfiler
+{
+public:
+    struct CurvePoint
+    {
+        uint32_t associativity;
+        uint64_t cacheSize; // bytes: sets * associativity * block size
+        uint64_t misses;
+        double missRatio;
+    };
+
+    // blockSize and setCount are powers of two; distances of maxAssociativity or more are
+    // only counted as misses
+    StackDistanceProfiler(uint32_t blockSize, uint32_t setCount, uint32_t maxAssociativity);
+
+    void access(uint64_t address);
+    void accessBatch(const CacheAccess *batch, size_t count);
+
+    // misses of an LRU cache with this geometry and `associativity` ways (<= maxAssociativity)
+    uint64_t getMisses(uint32_t associativity) const;
+    // one point per power-of-two associativity from 1 to maxAssociativity
+    std::vector<CurvePoint> missRatioCurve() const;
+
+    uint64_t getAccesses() const
+    {
+        return accesses;
+    }
+    // first accesses to a block (misses at every size)
+    uint64_t getColdMisses() const
+    {
+        return coldMisses;
+    }
+    uint32_t getBlockSize() const
+    {
+        return blockSize;
+    }
+    uint32_t getSetCount() const
+    {
+        return setCount;
+    }
+    uint32_t getMaxAssociativity() const
+    {
+        return maxAssociativity;
+    }
+
+    // One row (CSV) or curve (JSON) per point of every profiler's miss-ratio curve
+    static void writeCsv(std::ostream &out, const std::vector<StackDistanceProfiler> &profilers);
+    static void writeJson(std::ostream &out, const std::vector<StackDistanceProfiler> &profilers);
+
+private:
+    struct SetStack
+    {
+        std::vector<uint32_t> tree;     // Fenwick tree over timestamps 1..capacity
+        std::vector<uint64_t> blockAt;  // block accessed at each timestamp (index 0 unused)
+        uint32_t now = 0;               // last timestamp handed out
+    };
+
+    uint32_t blockSize;
+    uint32_t setCount;
+    uint32_t maxAssociativity;
+    int offsetBits = 0;
+    std::vector<SetStack> sets;
+    std::unordered_map<uint64_t, uint32_t> lastAccess; // block -> timestamp in its set
+
+    std::vector<uint64_t> histogram; // histogram[d]: accesses at distance d < maxAssociativity
+    uint64_t accesses = 0;
+    uint64_t coldMisses = 0;
+
+    static void add(SetStack &set, uint32_t position, int32_t delta);
+    static uint32_t prefixSum(const SetStack &set, uint32_t position);
+    // renumbers the live timestamps of a full set from 1 and rebuilds its tree
+    void compact(SetStack &set);
+};
+
+#endif // STACK_DISTANCE_H
@@ -0,0 +1,22 @@
+# Scenario: CONFIG EXTRA WORDS - sd_ld_wt with a config that has words and an unknown setting
+#           after the write policy
+# Expected: they are ignored with a warning, as before the optional MODEL and key=value
+#           settings existed; output matches sd_ld_wt.
+    lui t0, 0x1000          # t0 = 0x1000000 (set 0)
+    addi t1, zero, 1
+    slli t1, t1, 40
+    addi t1, t1, 0x123      # t1 = 0x100_0000_0123
+
+    sd t1, 0(t0)            # write miss, written to memory only
+    ld t2, 0(t0)            # read miss, block loaded from memory
+    sd t2, 8(t0)            # write hit, cache and memory updated
+
+    # Two more blocks in set 0 evict the clean block (LRU)
+    lw t3, 512(t0)          # miss, second way
+    lw t3, 1024(t0)         # miss, evicts the block at 0x1000000
+
+    ld t4, 8(t0)            # miss, block reloaded from memory
+    sd t4, 16(t0)           # write miss in set 1, written to memory only
+    ld t5, 16(t0)           # read miss, block loaded from memory
+
+    # Program end
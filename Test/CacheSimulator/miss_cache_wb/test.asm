@@ -0,0 +1,15 @@
+# Scenario: MISS CACHE - Direct-mapped WB cache with a 2-entry LRU miss cache
+# Expected: The miss cache remembers the block addresses of the last demand fills. A hit in
+# it is still a cache miss filled from memory, so a dirty line is written back as usual when
+# the cache evicts it.
+    lui   t0, 0x1          # t0 = 0x1000
+    addi  t2, zero, 77
+
+    sw    t2, 0(t0)        # A 0x1000 - MISS, MC miss, allocate dirty (77)      MC: A
+    lw    t3, 1024(t0)     # B 0x1400 - MISS, MC miss, A written back           MC: A B
+    lw    t3, 0(t0)        # A - MISS, MC hit, filled from memory (77)          MC: A B
+    lw    t3, 1024(t0)     # B - MISS, MC hit                                   MC: A B
+    lw    t3, -1024(t0)    # C 0x0c00 - MISS, MC miss, replaces A (LRU)         MC: C B
+    lw    t4, 0(t0)        # A - MISS, MC miss, replaces B (LRU)                MC: C A
+
+    # Miss cache: Hits 2, Misses 4; set 0 holds A with 77 (0x4d)
@@ -0,0 +1,12 @@
+# Scenario: PREFETCH - Next-line (degree 1, latency 2)
+# Expected: A miss, or the first hit on a prefetched block, prefetches the next block ('P' log
+# lines). A prefetched block used 2 or more accesses after its prefetch is timely, sooner is late.
+    lui   t0, 0x1          # t0 = 0x1000
+
+    lw    t1, 0(t0)        # access 1: 0x1000 MISS -> prefetch 0x1010 (at 1)
+    lw    t1, 4(t0)        # access 2: 0x1000 HIT (not prefetched, nothing issued)
+    lw    t1, 16(t0)       # access 3: 0x1010 first use, lead 2: timely -> prefetch 0x1020 (at 3)
+    lw    t1, 32(t0)       # access 4: 0x1020 first use, lead 1: late   -> prefetch 0x1030 (at 4)
+    lw    t1, 256(t0)      # access 5: 0x1100 MISS -> prefetch 0x1110 (at 5)
+
+    # Issued 4, Useful 2 (one late), 0x1030 and 0x1110 never used
@@ -0,0 +1,15 @@
+# Scenario: PREFETCH - Stream buffers (2 buffers of 2 blocks, latency 2)
+# Expected: A miss no buffer serves fills the least recently used buffer with the next 2 blocks.
+# A miss on a buffer's head moves that block into the cache (a stream buffer hit: still a cache
+# miss, but no memory wait) and the buffer fetches one more block. Blocks in buffers are not
+# in the cache, so there are no 'P' log lines.
+    lui   t0, 0x1          # t0 = 0x1000
+
+    lw    t1, 0(t0)        # access 1: 0x1000 MISS -> buffer 0: 0x1010 0x1020 (at 1)
+    lw    t1, 16(t0)       # access 2: 0x1010 buffer 0 head, lead 1 (late) -> 0x1020 0x1030
+    lw    t1, 256(t0)      # access 3: 0x1100 MISS -> buffer 1: 0x1110 0x1120 (at 3)
+    lw    t1, 32(t0)       # access 4: 0x1020 buffer 0 head, lead 3 -> 0x1030 0x1040
+    lw    t1, 288(t0)      # access 5: 0x1120 not a head: MISS -> LRU buffer 1: 0x1130 0x1140
+    lw    t1, 48(t0)       # access 6: 0x1030 buffer 0 head, lead 4 -> 0x1040 0x1050
+
+    # Issued 9 (2 + 1 + 2 + 1 + 2 + 1), stream buffer hits 3, Useful 3 (leads 1, 3, 4: one late)
@@ -0,0 +1,21 @@
+# Scenario: PREFETCH - PC-indexed stride (degree 2, latency 3)
+# Expected: Each load PC has its own table entry. The first access allocates it, the second
+# learns the stride, the third repeats it and prefetches 2 strides ahead; from then on each
+# access prefetches the block 2 strides ahead (the one 1 stride ahead is already cached).
+# A strides by 32 (even sets), B by 64 from 0x2010 (odd sets), so nothing is evicted.
+    lui   t0, 0x1          # t0 = 0x1000, A
+    lui   t1, 0x2
+    addi  t1, t1, 16       # t1 = 0x2010, B
+    addi  t2, zero, 5
+loop:
+    lw    t3, 0(t0)        # A: 0x1000 0x1020 0x1040 0x1060 0x1080
+    lw    t4, 0(t1)        # B: 0x2010 0x2050 0x2090 0x20d0 0x2110
+    addi  t0, t0, 32
+    addi  t1, t1, 64
+    addi  t2, t2, -1
+    bne   t2, zero, loop
+
+    # Accesses 1-10 alternate A, B. Iteration 3 (accesses 5, 6) prefetches 0x1060, 0x1080 and
+    # 0x20d0, 0x2110; iterations 4 and 5 hit them and prefetch 0x10a0, 0x10c0, 0x2150, 0x2190.
+    # Leads: 0x1060 and 0x20d0 are used 2 accesses later (late), 0x1080 and 0x2110 4 later.
+    # Issued 8, Useful 4, Timely 50%, avg lead 3; Hits 4, Misses 6
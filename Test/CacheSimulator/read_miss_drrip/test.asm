@@ -0,0 +1,18 @@
+# Scenario: READ - Cache Miss (DRRIP set dueling, 4-way, 16 sets)
+# Expected: With 16 sets the constituencies are 8 sets: sets 0 and 8 are SRRIP leaders,
+# sets 4 and 12 BRRIP leaders, the rest follow PSEL (starts at 511; above 511 = BRRIP).
+# A miss in an SRRIP leader raises PSEL, a miss in a BRRIP leader lowers it. SRRIP fills
+# insert at RRPV 2; BRRIP fills insert at 3 (2 only on every 32nd BRRIP fill).
+    lui   t0, 0x1          # t0 = 0x1000
+
+    lw    t1, 16(t0)       # Q (set 1) - MISS, PSEL 511: SRRIP, RRPV 2         set 1: 2 3 3 3
+    lw    t1, 0(t0)        # A (set 0, SRRIP leader) - MISS, PSEL 512
+    lw    t1, 272(t0)      # P (set 1) - MISS, PSEL 512: BRRIP, RRPV 3         set 1: 2 3 3 3
+    lw    t1, 64(t0)       # L (set 4, BRRIP leader) - MISS, PSEL 511
+    lw    t1, 528(t0)      # R (set 1) - MISS, PSEL 511: SRRIP, RRPV 2         set 1: 2 3 2 3
+    lw    t1, 784(t0)      # S (set 1) - MISS, SRRIP, RRPV 2                   set 1: 2 3 2 2
+    lw    t1, 1040(t0)     # T (set 1) - MISS, evicts P (way 1) without aging  set 1: 2 2 2 2
+    lw    t1, 272(t0)      # P (set 1) - MISS, age to 3 3 3 3, evicts Q (way 0) set 1: 2 3 3 3
+    lw    t1, 1040(t0)     # T (set 1) - HIT                                    set 1: 2 0 3 3
+
+    # Final set 1: P, T, R, S in ways 0-3 (plain SRRIP would have evicted Q, then P)
@@ -0,0 +1,18 @@
+# Scenario: READ - Cache Miss (NRU / bit-PLRU eviction, 4-way, 16 sets)
+# Expected: Each way has an MRU bit set on access; when the last 0 bit would be set, all
+# bits but the accessed one are cleared. The victim is the first way with a 0 bit.
+    lui   t0, 0x1          # t0 = 0x1000, all blocks below map to set 0
+
+    lw    t1, 0(t0)        # A - MISS, way 0      bits 1000
+    lw    t1, 256(t0)      # B - MISS, way 1      bits 1100
+    lw    t1, 512(t0)      # C - MISS, way 2      bits 1110
+    lw    t1, 768(t0)      # D - MISS, way 3      bits 1111 -> cleared to 0001
+    lw    t1, 512(t0)      # C - HIT              bits 0011
+    lw    t1, 256(t0)      # B - HIT              bits 0111
+    lw    t1, 0(t0)        # A - HIT              bits 1111 -> cleared to 1000
+    lw    t1, 1024(t0)     # E - MISS, evicts B (way 1; true LRU would evict D)   bits 1100
+    lw    t1, 1280(t0)     # F - MISS, evicts C (way 2)                           bits 1110
+    lw    t1, 768(t0)      # D - HIT              bits 1111 -> cleared to 0001
+    lw    t1, 256(t0)      # B - MISS, evicts A (way 0)                           bits 1001
+
+    # Final set 0: B, E, F, D in ways 0-3
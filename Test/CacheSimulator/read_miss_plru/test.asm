@@ -0,0 +1,17 @@
+# Scenario: READ - Cache Miss (tree PLRU eviction, 4-way, 16 sets)
+# Expected: The victim follows the tree bits, not true LRU order.
+# Tree of a set: root bit b1 picks ways 0-1 (0) or 2-3 (1); b2 picks way 0/1, b3 way 2/3.
+# An access points every bit on its path away from the accessed way.
+    lui   t0, 0x1          # t0 = 0x1000, all blocks below map to set 0
+
+    lw    t1, 0(t0)        # A - MISS, way 0      b1=1 b2=1 b3=0
+    lw    t1, 256(t0)      # B - MISS, way 1      b1=1 b2=0 b3=0
+    lw    t1, 512(t0)      # C - MISS, way 2      b1=0 b2=0 b3=1
+    lw    t1, 768(t0)      # D - MISS, way 3      b1=0 b2=0 b3=0
+    lw    t1, 0(t0)        # A - HIT,  way 0      b1=1 b2=1 b3=0
+    lw    t1, 1024(t0)     # E - MISS, evicts C (way 2; true LRU would evict B)   b1=0 b3=1
+    lw    t1, 1280(t0)     # F - MISS, evicts B (way 1)                            b1=1 b2=0
+    lw    t1, 512(t0)      # C - MISS, evicts D (way 3)                            b1=0 b3=0
+    lw    t1, 0(t0)        # A - HIT,  way 0
+
+    # Final set 0: A, F, E, C in ways 0-3
@@ -0,0 +1,18 @@
+# Scenario: READ - Cache Miss (SRRIP eviction, 4-way, 16 sets)
+# Expected: Fills insert with RRPV 2, hits set RRPV 0. The victim is the first way with
+# RRPV 3; when there is none, every way of the set is aged until one reaches 3.
+    lui   t0, 0x1          # t0 = 0x1000, all blocks below map to set 0
+
+    lw    t1, 0(t0)        # A - MISS, way 0      RRPV 2 3 3 3
+    lw    t1, 256(t0)      # B - MISS, way 1      RRPV 2 2 3 3
+    lw    t1, 512(t0)      # C - MISS, way 2      RRPV 2 2 2 3
+    lw    t1, 768(t0)      # D - MISS, way 3      RRPV 2 2 2 2
+    lw    t1, 0(t0)        # A - HIT              RRPV 0 2 2 2
+    lw    t1, 1024(t0)     # E - MISS, age +1 to 1 3 3 3, evicts B (way 1)   RRPV 1 2 3 3
+    lw    t1, 1280(t0)     # F - MISS, no aging, evicts C (way 2)            RRPV 1 2 2 3
+    lw    t1, 1024(t0)     # E - HIT              RRPV 1 0 2 3
+    lw    t1, 1536(t0)     # G - MISS, no aging, evicts D (way 3)            RRPV 1 0 2 2
+    lw    t1, 1792(t0)     # H - MISS, age +1 to 2 1 3 3, evicts F (way 2)   RRPV 2 1 2 3
+    lw    t1, 256(t0)      # B - MISS, no aging, evicts G (way 3)            RRPV 2 1 2 2
+
+    # Final set 0: A, E, H, B in ways 0-3
@@ -0,0 +1,21 @@
+# Scenario: SD/LD ROUND TRIP - WT + No Allocate (LRU)
+# Expected: a doubleword with bits above 32 set survives sd/ld with write-through,
+#           reading back from memory whenever the write did not allocate.
+    lui t0, 0x1000          # t0 = 0x1000000 (set 0)
+    addi t1, zero, 1
+    slli t1, t1, 40
+    addi t1, t1, 0x123      # t1 = 0x100_0000_0123
+
+    sd t1, 0(t0)            # write miss, written to memory only
+    ld t2, 0(t0)            # read miss, block loaded from memory
+    sd t2, 8(t0)            # write hit, cache and memory updated
+
+    # Two more blocks in set 0 evict the clean block (LRU)
+    lw t3, 512(t0)          # miss, second way
+    lw t3, 1024(t0)         # miss, evicts the block at 0x1000000
+
+    ld t4, 8(t0)            # miss, block reloaded from memory
+    sd t4, 16(t0)           # write miss in set 1, written to memory only
+    ld t5, 16(t0)           # read miss, block loaded from memory
+
+    # Program end
@@ -0,0 +1,16 @@
+# Scenario: VICTIM CACHE - Direct-mapped WB cache with a 2-entry LRU victim cache
+# Expected: A, B, C and D all map to set 0. A conflict miss that hits the victim cache swaps
+# the block back in and moves the evicted line out; a dirty line keeps its data through the
+# swaps, and is written to memory when it is pushed out of the full victim cache.
+    lui   t0, 0x1          # t0 = 0x1000
+    addi  t2, zero, 77
+
+    sw    t2, 0(t0)        # A 0x1000 - MISS, allocate dirty (77)      VC: -
+    lw    t3, 1024(t0)     # B 0x1400 - MISS, A (dirty) to VC          VC: A*
+    lw    t3, 0(t0)        # A - MISS, VC hit: A swapped in, B to VC   VC: B
+    lw    t3, 1024(t0)     # B - MISS, VC hit: B swapped in, A to VC   VC: A*
+    lw    t3, -1024(t0)    # C 0x0c00 - MISS, B to VC                   VC: A* B
+    lw    t3, -2048(t0)    # D 0x0800 - MISS, C to VC pushes out A (LRU): A written back   VC: C B
+    lw    t4, 0(t0)        # A - MISS, VC miss: filled from memory with 77, D to VC pushes out B   VC: C D
+
+    # Victim cache: Hits 2, Misses 5, Writebacks 1; set 0 holds A with 77 (0x4d)
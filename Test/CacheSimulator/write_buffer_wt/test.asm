@@ -0,0 +1,17 @@
+# Scenario: WRITE BUFFER - WT + No Allocate (LRU) with a 2-entry buffer draining every 10 cycles
+# Expected: stores to a buffered block coalesce; a load that misses sees the bytes still in the
+# buffer; a store to a third block waits for the oldest entry to drain; what is left drains to
+# memory when the program ends. Time is the access count plus the cycles stalled so far.
+    lui   t0, 0x1          # t0 = 0x1000
+    addi  t1, zero, 0x11
+    addi  t2, zero, 0x22
+
+    sw    t1, 0(t0)        # access 1: write miss, entry 0x1000 (drains at 11)
+    sw    t2, 4(t0)        # access 2: coalesced into 0x1000
+    lw    t3, 0(t0)        # access 3: read miss, memory still 0; the block gets 11 .. 22 from the buffer
+    sw    t1, 16(t0)       # access 4: write miss, entry 0x1010 - buffer full
+    sw    t2, 32(t0)       # access 5: write miss, stalls 6 cycles until 0x1000 drains at 11, entry 0x1020
+    sw    t1, 36(t0)       # access 6: coalesced into 0x1020
+
+    # Program end: 0x1010 and 0x1020 drain to memory
+    # Write buffer: Stores 5, Coalesced 2, Memory writes 3, Full stalls 1, Stall cycles 6
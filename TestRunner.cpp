@@ -602,6 +602,10 @@ int TestRunner::integrationTests()
  *   - config: Cache configuration file.
  *   - test.asm: Assembly file to be loaded and executed.
  *   - test.expected: Expected output file for the test.
+ *   - jit (optional, contents ignored): run with every basic block JIT-compiled and quiet output, since
+ *     compiled code prints no per-instruction trace. Skipped on hosts without JIT support.
+ *   - memory (optional): one "<addr> <count>" per line; after the run, prints count words of memory from
+ *     addr (mem command), to check what actually reached memory.
  *
  * For each valid test directory:
  *   1. Constructs a sequence of simulator commands to enable cache simulation, load the assembly file, run the program,
@@ -619,7 +623,7 @@ int TestRunner::integrationTests()
  * @return 0 if all tests pass, 1 otherwise.
  */
 
-int TestRunner::runCacheTests(const std::string &rootDir)
+int TestRunner::runCacheTests(const std::string &rootDir, ISAMode mode)
 {
     int testsRun = 0;
     int testsPassed = 0;
@@ -640,8 +644,23 @@ int TestRunner::runCacheTests(const std::string &rootDir)
             continue;
         }
 
+        bool useJit = fs::exists(dirPath / "jit");
+        if (useJit && !JitCompiler::isSupported())
+        {
+            std::cout << "[SKIP] Cache Test: " << asmFile << " (JIT not supported on this host)\n";
+            continue;
+        }
+
         // Generate standard commands
         std::vector<std::string> commands = standardCacheCommands(configFile.string(), asmFile.string());
+        std::ifstream memoryIn(dirPath / "memory");
+        std::string memoryRange;
+        auto memoryAt = std::find(commands.begin(), commands.end(), "cache_sim disable");
+        while (std::getline(memoryIn, memoryRange))
+        {
+            if (!memoryRange.empty())
+                memoryAt = commands.insert(memoryAt, "mem " + memoryRange) + 1;
+        }
 
         // Convert to input stream
         std::stringstream commandInput;
@@ -652,9 +671,14 @@ int TestRunner::runCacheTests(const std::string &rootDir)
 
         // Run simulator
         std::ostringstream simOutput;
-        InteractiveSimulator interactiveSim(commandInput, simOutput);
+        InteractiveSimulator interactiveSim(commandInput, simOutput, mode);
         // Set a fixed random number seed so that tests dont give different results everytime and fail
         interactiveSim.getCacheSimulator().setRandomSeed(12345);
+        if (useJit)
+        {
+            interactiveSim.setQuiet(true);
+            interactiveSim.enableJit(1);
+        }
         interactiveSim.runInteractive();
         // 💡 Force log flush
         interactiveSim.invalidateCache(); // flush the output of log generator
@@ -797,7 +821,7 @@ int TestRunner::runAllTests(ISAMode mode)
     unitTests();
     integrationTests();
     runIntegrationTestSuite("Test", mode);
-    runCacheTests();
+    runCacheTests("Test/CacheSimulator", mode);
     runHazardTests("Test/PipelineHazards",mode);
     return 0;
 
@@ -12,7 +12,7 @@ public:
     int unitTests();
     int integrationTests();
     int runIntegrationTestSuite(const std::string &testDir, ISAMode mode = ISAMode::RV32I);
-    int runCacheTests(const std::string &rootDir = "Test/CacheSimulator");
+    int runCacheTests(const std::string &rootDir = "Test/CacheSimulator", ISAMode mode = ISAMode::RV32I);
     int runAllTests(ISAMode mode = ISAMode::RV32I);
     int runHazardTests(const std::string &rootDir,ISAMode mode= ISAMode::RV32I);
 
@@ -0,0 +1,318 @@
+/**
+ * @file Trace.cpp
+ * @brief Varint/delta encoding, double-buffered writer thread and reader of execution traces.
+ *
+ * Signed deltas are zigzag-encoded ((d << 1) ^ (d >> 63)) so small negative steps stay
+ * small, then written as LEB128 varints (7 bits per byte, high bit = more bytes follow).
+ */
+#include "Trace.h"
+
+#include <cstring>
+#include <iomanip>
+#include <system_error>
+
+namespace
+{
+    const char MAGIC[8] = {'R', 'V', 'T', 'R', 'A', 'C', 'E', 0};
+    const size_t HEADER_SIZE = sizeof(MAGIC) + 4;
+    const size_t READ_CHUNK = 1 << 20;
+
+    uint64_t zigzag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    uint8_t log2Size(uint8_t size)
+    {
+        return size >= 8 ? 3 : size >= 4 ? 2 : size >= 2 ? 1 : 0;
+    }
+}
+
+TraceWriter::TraceWriter()
+    : filling(new uint8_t[BUFFER_SIZE]), draining(new uint8_t[BUFFER_SIZE])
+{
+}
+
+TraceWriter::~TraceWriter()
+{
+    close();
+}
+
+bool TraceWriter::open(const std::string &path)
+{
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    file.write(MAGIC, sizeof(MAGIC));
+    for (int i = 0; i < 4; ++i)
+        file.put(static_cast<char>((VERSION >> (8 * i)) & 0xFF));
+    bytesWritten = HEADER_SIZE;
+
+    used = 0;
+    records = 0;
+    pending = false;
+    stopping = false;
+    failed = false;
+    previousPC = static_cast<uint64_t>(-4);
+    std::memset(previousValue, 0, sizeof(previousValue));
+    previousAddress = 0;
+    try
+    {
+        writer = std::thread(&TraceWriter::writerLoop, this);
+    }
+    catch (const std::system_error &)
+    {
+        // no threads on this host (e.g. WebAssembly without pthreads)
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool TraceWriter::close()
+{
+    if (!writer.joinable())
+        return !failed;
+    handOff();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    writer.join();
+    file.close();
+    return !failed;
+}
+
+void TraceWriter::putVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        filling[used++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    filling[used++] = static_cast<uint8_t>(value);
+}
+
+void TraceWriter::encode(const TraceRecord &record)
+{
+    size_t flagsAt = used++;
+    uint8_t flags = 0;
+    if (record.pc != previousPC + 4)
+    {
+        flags |= 1;
+        putVarint(zigzag(static_cast<int64_t>(record.pc - (previousPC + 4))));
+    }
+    previousPC = record.pc;
+    filling[used++] = static_cast<uint8_t>(record.op);
+    if (record.writesRd)
+    {
+        flags |= 2;
+        uint8_t rd = record.rd & 31;
+        filling[used++] = rd;
+        putVarint(zigzag(static_cast<int64_t>(static_cast<uint64_t>(record.rdValue) -
+                                              static_cast<uint64_t>(previousValue[rd]))));
+        previousValue[rd] = record.rdValue;
+    }
+    if (record.accessesMemory)
+    {
+        flags |= 4 | (record.isStore ? 8 : 0) | (log2Size(record.size) << 4);
+        putVarint(zigzag(static_cast<int64_t>(record.address - previousAddress)));
+        previousAddress = record.address;
+    }
+    filling[flagsAt] = flags;
+}
+
+void TraceWriter::handOff()
+{
+    if (used == 0)
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]
+            { return !pending; });
+    std::swap(filling, draining);
+    drainingUsed = used;
+    bytesWritten += used;
+    used = 0;
+    pending = true;
+    lock.unlock();
+    cv.notify_all();
+}
+
+void TraceWriter::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [this]
+                { return pending || stopping; });
+        if (!pending)
+            return; // stopping, and everything is written
+        // the simulator does not touch `draining` while pending is set
+        lock.unlock();
+        file.write(reinterpret_cast<const char *>(draining.get()), drainingUsed);
+        bool ok = static_cast<bool>(file);
+        lock.lock();
+        failed = failed || !ok;
+        pending = false;
+        cv.notify_all();
+    }
+}
+
+bool TraceReader::open(const std::string &path)
+{
+    file.close();
+    file.clear();
+    buffer.clear();
+    position = 0;
+    previousPC = static_cast<uint64_t>(-4);
+    std::memset(previousValue, 0, sizeof(previousValue));
+    previousAddress = 0;
+
+    file.open(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    fill(HEADER_SIZE);
+    if (buffer.size() < HEADER_SIZE || std::memcmp(buffer.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = path + " is not a trace file";
+        return false;
+    }
+    uint32_t version = 0;
+    for (int i = 0; i < 4; ++i)
+        version |= static_cast<uint32_t>(buffer[sizeof(MAGIC) + i]) << (8 * i);
+    if (version != TraceWriter::VERSION)
+    {
+        error = "unsupported trace version " + std::to_string(version);
+        return false;
+    }
+    position = HEADER_SIZE;
+    error.clear();
+    return true;
+}
+
+void TraceReader::fill(size_t count)
+{
+    if (buffer.size() - position >= count || !file)
+        return;
+    buffer.erase(buffer.begin(), buffer.begin() + position);
+    position = 0;
+    size_t kept = buffer.size();
+    buffer.resize(kept + READ_CHUNK);
+    file.read(reinterpret_cast<char *>(buffer.data() + kept), READ_CHUNK);
+    buffer.resize(kept + static_cast<size_t>(file.gcount()));
+}
+
+bool TraceReader::getVarint(uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (position >= buffer.size())
+            return false;
+        uint8_t byte = buffer[position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool TraceReader::next(TraceRecord &record)
+{
+    fill(TraceWriter::MAX_RECORD_SIZE);
+    if (position >= buffer.size())
+        return false; // clean end of the trace
+    uint8_t flags = buffer[position++];
+    uint64_t value = 0;
+
+    record = TraceRecord();
+    record.pc = previousPC + 4;
+    if (flags & 1)
+    {
+        if (!getVarint(value))
+            return false;
+        record.pc += static_cast<uint64_t>(unzigzag(value));
+    }
+    previousPC = record.pc;
+
+    if (position >= buffer.size())
+        return false;
+    uint8_t op = buffer[position++];
+    record.op = op < static_cast<uint8_t>(Opcode::COUNT) ? static_cast<Opcode>(op) : Opcode::INVALID;
+
+    if (flags & 2)
+    {
+        if (position >= buffer.size())
+            return false;
+        record.writesRd = true;
+        record.rd = buffer[position++] & 31;
+        if (!getVarint(value))
+            return false;
+        record.rdValue = static_cast<int64_t>(static_cast<uint64_t>(previousValue[record.rd]) +
+                                              static_cast<uint64_t>(unzigzag(value)));
+        previousValue[record.rd] = record.rdValue;
+    }
+    if (flags & 4)
+    {
+        if (!getVarint(value))
+            return false;
+        record.accessesMemory = true;
+        record.isStore = (flags & 8) != 0;
+        record.size = static_cast<uint8_t>(1u << ((flags >> 4) & 3));
+        record.address = previousAddress + static_cast<uint64_t>(unzigzag(value));
+        previousAddress = record.address;
+    }
+    return true;
+}
+
+bool dumpTrace(const std::string &path, std::ostream &out, uint64_t limit)
+{
+    TraceReader reader;
+    if (!reader.open(path))
+    {
+        out << "Error: " << reader.getError() << "\n";
+        return false;
+    }
+    TraceRecord record;
+    uint64_t count = 0;
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    while (reader.next(record))
+    {
+        if (record.accessesMemory)
+            ++(record.isStore ? stores : loads);
+        if (limit == 0 || count < limit)
+        {
+            out << std::setw(10) << count << "  pc 0x" << std::hex << std::setw(8) << std::setfill('0') << record.pc
+                << std::setfill(' ') << std::dec << "  " << std::left << std::setw(7) << opcodeToMnemonic(record.op)
+                << std::right;
+            if (record.writesRd)
+                out << "  x" << (int)record.rd << " = 0x" << std::hex << static_cast<uint64_t>(record.rdValue) << std::dec;
+            if (record.accessesMemory)
+                out << "  " << (record.isStore ? "store " : "load ") << (int)record.size << " @ 0x" << std::hex
+                    << record.address << std::dec;
+            out << "\n";
+        }
+        ++count;
+    }
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    uint64_t bytes = file ? static_cast<uint64_t>(file.tellg()) : 0;
+    out << "Trace " << path << ": " << count << " instructions, " << loads << " loads, " << stores << " stores, "
+        << bytes << " bytes";
+    if (count > 0)
+        out << " (" << std::fixed << std::setprecision(2) << (double)(bytes - std::min<uint64_t>(bytes, HEADER_SIZE)) / count
+            << " bytes/instruction)";
+    out << "\n";
+    out.unsetf(std::ios::floatfield);
+    return true;
+}
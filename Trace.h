@@ -0,0 +1,153 @@
+/**
+ * @file Trace.h
+ * @brief Compact binary execution trace: one record per executed instruction.
+ *
+ * A trace file is a header followed by records until the end of the file:
+ *
+ *   magic "RVTRACE\0" | u32 version | records...
+ *
+ * Each record starts with a flags byte, followed by only the fields it announces:
+ *
+ *   flags | [pc delta] | op | [rd | rd value delta] | [address delta]
+ *
+ *   flags bit 0: pc is not the previous pc + 4; a zigzag varint (pc - (previous pc + 4)) follows
+ *   flags bit 1: the instruction wrote rd; rd (u8) and a zigzag varint
+ *                (value - previous value written to rd) follow
+ *   flags bit 2: the instruction accessed memory; a zigzag varint
+ *                (address - previous address) follows
+ *   flags bit 3: the access was a store (otherwise a load)
+ *   flags bits 4-5: log2 of the access size in bytes
+ *   op: the Opcode of the instruction (u8)
+ *
+ * Straight-line code, loop counters and strided accesses therefore take 2-5 bytes per
+ * instruction. All deltas start from zero (pc from -4), so a trace decodes front to back only.
+ *
+ * TraceWriter encodes into one of two buffers while a background thread writes the other
+ * to the file, so the simulator only waits for the disk when it fills a buffer before the
+ * previous one is written. TraceReader decodes a file record by record, and dumpTrace()
+ * prints one as text.
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Opcode.h"
+
+struct TraceRecord
+{
+    uint64_t pc = 0;
+    Opcode op = Opcode::INVALID;
+    bool writesRd = false;
+    uint8_t rd = 0;
+    int64_t rdValue = 0;
+    bool accessesMemory = false;
+    bool isStore = false;
+    uint8_t size = 0; // access size in bytes: 1, 2, 4 or 8
+    uint64_t address = 0;
+};
+
+class TraceWriter
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+    static constexpr size_t MAX_RECORD_SIZE = 1 + 10 + 1 + 1 + 10 + 10;
+
+    TraceWriter();
+    ~TraceWriter();
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    // Creates the file, writes the header and starts the writer thread; false on failure
+    bool open(const std::string &path);
+    // Writes what is left and stops the writer thread; false if a write failed
+    bool close();
+
+    void write(const TraceRecord &record)
+    {
+        if (used + MAX_RECORD_SIZE > BUFFER_SIZE)
+            handOff();
+        encode(record);
+        ++records;
+    }
+
+    uint64_t getRecordCount() const
+    {
+        return records;
+    }
+    // bytes written to the file so far, header included
+    uint64_t getBytesWritten() const
+    {
+        return bytesWritten;
+    }
+
+private:
+    std::ofstream file;
+    // the simulator fills `filling`; the writer thread writes `draining` while pending is set
+    std::unique_ptr<uint8_t[]> filling;
+    std::unique_ptr<uint8_t[]> draining;
+    size_t used = 0;
+    size_t drainingUsed = 0;
+    bool pending = false;
+    bool stopping = false;
+    bool failed = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread writer;
+
+    uint64_t records = 0;
+    uint64_t bytesWritten = 0;
+
+    // delta state
+    uint64_t previousPC = static_cast<uint64_t>(-4);
+    int64_t previousValue[32] = {0};
+    uint64_t previousAddress = 0;
+
+    void encode(const TraceRecord &record);
+    void putVarint(uint64_t value);
+    // waits for the writer to finish the other buffer, then swaps them
+    void handOff();
+    void writerLoop();
+};
+
+class TraceReader
+{
+public:
+    // Opens a trace and checks its header; on failure, getError() says why
+    bool open(const std::string &path);
+    // Decodes the next record; false at the end of the trace or on a truncated record
+    bool next(TraceRecord &record);
+
+    const std::string &getError() const
+    {
+        return error;
+    }
+
+private:
+    std::ifstream file;
+    std::vector<uint8_t> buffer;
+    size_t position = 0;
+    std::string error;
+
+    uint64_t previousPC = static_cast<uint64_t>(-4);
+    int64_t previousValue[32] = {0};
+    uint64_t previousAddress = 0;
+
+    // makes sure `count` bytes are buffered if the file has them
+    void fill(size_t count);
+    bool getVarint(uint64_t &value);
+};
+
+// Prints the first `limit` records (0: all) of a trace as text, then a summary line.
+// Returns false if the file is not a trace.
+bool dumpTrace(const std::string &path, std::ostream &out, uint64_t limit = 0);
+
+#endif // TRACE_H
@@ -0,0 +1,123 @@
+/**
+ * @file TranslationCache.cpp
+ * @brief Basic-block formation, lookup, chaining and invalidation.
+ *
+ * Block formation starting at pc:
+ *   1. Append the instruction at pc with its decoded opcode and source line.
+ *   2. Stop if it is a branch, jal, jalr, ecall or ebreak.
+ *   3. Stop if the next PC is past the end of the program or has a breakpoint.
+ *   4. Otherwise continue with the next PC.
+ *
+ * Chaining: each block keeps its last two distinct successors. getBlock() checks those
+ * first, and only falls back to the hash map (and to translation) when neither matches.
+ */
+#include "TranslationCache.h"
+
+bool TranslationCache::endsBlock(Opcode op)
+{
+    switch (op)
+    {
+    case Opcode::BEQ:
+    case Opcode::BNE:
+    case Opcode::BLT:
+    case Opcode::BGE:
+    case Opcode::BLTU:
+    case Opcode::BGEU:
+    case Opcode::JAL:
+    case Opcode::JALR:
+    case Opcode::ECALL:
+    case Opcode::EBREAK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+BasicBlock *TranslationCache::getBlock(int pc, BasicBlock *from, const std::vector<PackedInstruction> &program,
+                                       const std::vector<int> &sourceLines,
+                                       const BreakPointInfo &breakpoints)
+{
+    // Fast path: follow the chain from the previous block
+    if (from)
+    {
+        if (from->successors[0] && from->successors[0]->startPC == pc)
+            return from->successors[0];
+        if (from->successors[1] && from->successors[1]->startPC == pc)
+            return from->successors[1];
+    }
+
+    if (pc < 0 || pc % 4 != 0 || pc / 4 >= (int)program.size())
+        return nullptr;
+
+    BasicBlock *block = nullptr;
+    auto it = blocks.find(pc);
+    if (it != blocks.end())
+        block = it->second.get();
+    else
+        block = translate(pc, program, sourceLines, breakpoints);
+
+    if (from)
+    {
+        // keep the most recent successor in slot 0
+        from->successors[1] = from->successors[0];
+        from->successors[0] = block;
+    }
+    return block;
+}
+
+BasicBlock *TranslationCache::translate(int pc, const std::vector<PackedInstruction> &program,
+                                        const std::vector<int> &sourceLines,
+                                        const BreakPointInfo &breakpoints)
+{
+    auto block = std::make_unique<BasicBlock>();
+    block->startPC = pc;
+
+    int index = pc / 4;
+    while (index < (int)program.size())
+    {
+        block->ops.push_back({program[index], sourceLines[index]});
+        block->endPC = index * 4;
+        if (endsBlock(program[index].op))
+            break;
+        ++index;
+        // a breakpoint must be the first instruction of its block
+        if (breakpoints.hasBreakpoinaAtpc(index * 4))
+            break;
+    }
+
+    BasicBlock *result = block.get();
+    blocks[pc] = std::move(block);
+    return result;
+}
+
+void TranslationCache::invalidate(int pc)
+{
+    bool removed = false;
+    for (auto it = blocks.begin(); it != blocks.end();)
+    {
+        if (it->second->contains(pc))
+        {
+            it = blocks.erase(it);
+            removed = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Chains may point at removed blocks; unlink everything and let them rebuild
+    if (removed)
+    {
+        for (auto &[startPC, block] : blocks)
+        {
+            block->successors[0] = nullptr;
+            block->successors[1] = nullptr;
+        }
+    }
+}
+
+void TranslationCache::clear()
+{
+    blocks.clear();
+}
@@ -0,0 +1,84 @@
+/**
+ * @class TranslationCache
+ * @brief Caches the loaded program as basic blocks keyed by their start PC.
+ *
+ * A basic block is a run of instructions that ends at a branch, jal, jalr, ecall or ebreak
+ * (or at the end of the program). Each instruction in a block is pre-resolved into a
+ * TranslatedOp holding a copy of its PackedInstruction and its source line, so Simulator::run() can execute
+ * the whole block without fetching, bounds-checking or looking up source lines per instruction.
+ *
+ * Blocks also remember the blocks that followed them last time (taken and fall-through),
+ * so a loop goes from block to block without a hash lookup.
+ *
+ * Breakpoints:
+ * - A block never contains a breakpoint except on its first instruction, because block
+ *   formation stops in front of any PC that has a breakpoint. Simulator::run() therefore
+ *   only has to check for breakpoints at block boundaries.
+ * - When a breakpoint is set or removed, every block containing that PC is invalidated
+ *   and retranslated on next use.
+ */
+#ifndef TRANSLATION_CACHE_H
+#define TRANSLATION_CACHE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "PackedInstruction.h"
+#include "BreakPointInfo.h"
+
+struct JitContext;
+
+// One pre-resolved instruction of a basic block
+struct TranslatedOp
+{
+    PackedInstruction inst;
+    int sourceLine; // assembly source line of this instruction
+};
+
+struct BasicBlock
+{
+    int startPC = 0;
+    int endPC = 0; // PC of the last instruction in the block
+    std::vector<TranslatedOp> ops;
+    // last two distinct successors seen (e.g. branch taken / not taken)
+    BasicBlock *successors[2] = {nullptr, nullptr};
+
+    // JIT state, see JitCompiler
+    uint32_t execCount = 0;
+    void (*jitCode)(JitContext *) = nullptr;
+    int jitOps = 0; // leading ops covered by jitCode; the rest are interpreted
+    bool jitRejected = false;
+
+    bool contains(int pc) const { return pc >= startPC && pc <= endPC; }
+};
+
+class TranslationCache
+{
+public:
+    // Returns the block starting at pc, translating it on first use.
+    // `from` is the block that just finished (or nullptr); it is linked to the result.
+    // Returns nullptr if pc is not the address of a loaded instruction.
+    BasicBlock *getBlock(int pc, BasicBlock *from, const std::vector<PackedInstruction> &program,
+                         const std::vector<int> &sourceLines,
+                         const BreakPointInfo &breakpoints);
+
+    // Drops every block that contains pc
+    void invalidate(int pc);
+
+    // Drops all blocks (new program loaded)
+    void clear();
+
+    size_t size() const { return blocks.size(); }
+
+    // true if op ends a basic block
+    static bool endsBlock(Opcode op);
+
+private:
+    std::unordered_map<int, std::unique_ptr<BasicBlock>> blocks;
+
+    BasicBlock *translate(int pc, const std::vector<PackedInstruction> &program,
+                          const std::vector<int> &sourceLines,
+                          const BreakPointInfo &breakpoints);
+};
+
+#endif // TRANSLATION_CACHE_H
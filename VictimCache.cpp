@@ -0,0 +1,189 @@
+/**
+ * @file VictimCache.cpp
+ * @brief Victim / miss cache entries, FIFO or LRU replacement, statistics and checkpointing.
+ */
+#include "VictimCache.h"
+
+#include <algorithm>
+#include <iomanip>
+#include "CacheBlock.h"
+
+VictimCache::VictimCache(const CacheConfig &config, bool holdsData)
+    : kind(config.victimKind), lru(config.victimPolicy != ReplacementPolicy::FIFO),
+      blockSize(static_cast<uint32_t>(config.blockSize))
+{
+    size_t entries = static_cast<size_t>(config.victimEntries);
+    blocks.assign(entries, 0);
+    valid.assign(entries, 0);
+    dirty.assign(entries, 0);
+    lastUsed.assign(entries, 0);
+    insertedAt.assign(entries, 0);
+    if (holdsData)
+    {
+        data.assign(entries * blockSize, 0);
+        taken.resize(blockSize);
+    }
+}
+
+int VictimCache::find(uint64_t blockAddress) const
+{
+    for (size_t entry = 0; entry < blocks.size(); ++entry)
+    {
+        if (blocks[entry] == blockAddress && valid[entry])
+            return static_cast<int>(entry);
+    }
+    return -1;
+}
+
+bool VictimCache::lookup(uint64_t blockAddress, uint64_t now)
+{
+    int entry = find(blockAddress);
+    if (entry < 0)
+    {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    lastUsed[entry] = now;
+    return true;
+}
+
+const uint8_t *VictimCache::take(int entry, bool &wasDirty)
+{
+    wasDirty = dirty[entry];
+    valid[entry] = 0;
+    dirty[entry] = 0;
+    if (data.empty())
+        return nullptr;
+    std::copy(entryData(entry), entryData(entry) + blockSize, taken.begin());
+    return taken.data();
+}
+
+void VictimCache::insert(uint64_t blockAddress, const uint8_t *bytes, bool isDirty, uint64_t now, Memory &memory)
+{
+    int entry = find(blockAddress);
+    if (entry < 0)
+    {
+        auto slot = std::find(valid.begin(), valid.end(), 0);
+        if (slot != valid.end())
+        {
+            entry = static_cast<int>(slot - valid.begin());
+        }
+        else
+        {
+            const std::vector<uint64_t> &stamps = lru ? lastUsed : insertedAt;
+            entry = static_cast<int>(std::min_element(stamps.begin(), stamps.end()) - stamps.begin());
+            if (dirty[entry] && !data.empty())
+            {
+                memory.writeBytes(blocks[entry], entryData(entry), blockSize);
+            }
+            writebacks += dirty[entry];
+        }
+        blocks[entry] = blockAddress;
+        valid[entry] = 1;
+        insertedAt[entry] = now;
+    }
+    dirty[entry] = isDirty;
+    lastUsed[entry] = now;
+    if (bytes && !data.empty())
+        std::copy(bytes, bytes + blockSize, entryData(entry));
+}
+
+void VictimCache::write(int entry, uint64_t address, MemSize size, uint64_t value)
+{
+    if (!data.empty())
+        CacheBlock::writeBytes(entryData(entry), blockSize, address, size, value, blockSize);
+}
+
+void VictimCache::writeBackDirtyEntries(Memory &memory)
+{
+    for (size_t entry = 0; entry < blocks.size(); ++entry)
+    {
+        if (valid[entry] && dirty[entry])
+        {
+            if (!data.empty())
+                memory.writeBytes(blocks[entry], entryData(static_cast<int>(entry)), blockSize);
+            dirty[entry] = 0;
+        }
+    }
+}
+
+void VictimCache::invalidate()
+{
+    std::fill(valid.begin(), valid.end(), 0);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    std::fill(lastUsed.begin(), lastUsed.end(), 0);
+    std::fill(insertedAt.begin(), insertedAt.end(), 0);
+    hits = 0;
+    misses = 0;
+    writebacks = 0;
+}
+
+void VictimCache::printStats(std::ostream &out, uint64_t cacheHits, uint64_t cacheAccesses) const
+{
+    auto percent = [](uint64_t part, uint64_t whole)
+    { return whole ? static_cast<double>(part) / whole * 100.0 : 0.0; };
+    out << (holdsVictims() ? "Victim" : "Miss") << " cache (" << blocks.size() << " entries, "
+        << (lru ? "LRU" : "FIFO") << "):   Hits: " << hits << "   Misses: " << misses
+        << "   Hit Rate: " << percent(hits, hits + misses) << "%";
+    if (holdsVictims())
+        out << "   Writebacks: " << writebacks;
+    // a hit here is still a cache miss, but memory was not waited for
+    out << "   Hit Rate incl. " << (holdsVictims() ? "victim" : "miss") << " cache: "
+        << percent(cacheHits + hits, cacheAccesses) << "%\n";
+}
+
+void VictimCache::dump(std::ostream &out) const
+{
+    if (std::find(valid.begin(), valid.end(), 1) == valid.end())
+        return;
+    out << (holdsVictims() ? "Victim" : "Miss") << " cache:\n";
+    for (size_t entry = 0; entry < blocks.size(); ++entry)
+    {
+        if (!valid[entry])
+            continue;
+        out << "  Block: 0x" << std::hex << blocks[entry] << " | " << (dirty[entry] ? "Dirty" : "Clean");
+        if (!data.empty())
+        {
+            out << " | Data: [";
+            const uint8_t *bytes = entryData(static_cast<int>(entry));
+            for (uint32_t i = 0; i < blockSize; ++i)
+                out << (i ? " " : "") << std::setw(2) << std::setfill('0') << static_cast<int>(bytes[i]);
+            out << "]";
+        }
+        out << std::dec << "\n";
+    }
+}
+
+void VictimCache::saveState(CheckpointWriter &writer) const
+{
+    writer.writeU64(hits);
+    writer.writeU64(misses);
+    writer.writeU64(writebacks);
+    for (size_t entry = 0; entry < blocks.size(); ++entry)
+    {
+        writer.writeBool(valid[entry]);
+        writer.writeBool(dirty[entry]);
+        writer.writeU64(blocks[entry]);
+        writer.writeU64(lastUsed[entry]);
+        writer.writeU64(insertedAt[entry]);
+    }
+    writer.writeBytes(data.data(), data.size());
+}
+
+bool VictimCache::loadState(CheckpointReader &reader)
+{
+    hits = reader.readU64();
+    misses = reader.readU64();
+    writebacks = reader.readU64();
+    for (size_t entry = 0; entry < blocks.size(); ++entry)
+    {
+        valid[entry] = reader.readBool();
+        dirty[entry] = reader.readBool();
+        blocks[entry] = reader.readU64();
+        lastUsed[entry] = reader.readU64();
+        insertedAt[entry] = reader.readU64();
+    }
+    reader.readBytes(data.data(), data.size());
+    return reader.isGood();
+}
@@ -0,0 +1,99 @@
+/**
+ * @class VictimCache
+ * @brief Small fully-associative buffer beside a Cache: a victim cache or a miss cache (Jouppi).
+ *
+ * Cache probes it on every demand miss (lookup(), which counts hits and misses). The
+ * CacheConfig's victimKind decides what it holds:
+ *
+ *   VICTIM  Lines evicted from the cache, dirty ones included, with their bytes. A miss that
+ *           hits an entry swaps it with the line the cache evicts for it (take() then insert()),
+ *           so the two stay exclusive and the entry's dirty data is never lost. A dirty entry
+ *           pushed out of a full buffer is written back to Memory.
+ *   MISS    Block addresses of recent demand fills. A hit still fills the cache from Memory (the
+ *           cache wrote the block back when it left), so entries hold no data and are never dirty.
+ *
+ * victimEntries entries, replaced FIFO or LRU (victimPolicy). With CacheModel::TIMING the
+ * entries hold no bytes either: Memory is current, so a "dirty" entry needs no write back.
+ */
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "CacheConfig.h"
+#include "Checkpoint.h"
+#include "Memory.h"
+
+class VictimCache
+{
+public:
+    // holdsData: entries keep a copy of their block (VICTIM with CacheModel::DATA)
+    VictimCache(const CacheConfig &config, bool holdsData);
+
+    bool holdsVictims() const
+    {
+        return kind == VictimKind::VICTIM;
+    }
+    // the entry holding blockAddress, or -1
+    int find(uint64_t blockAddress) const;
+    // A demand miss probe at access count now: counts a hit or a miss; a hit is touched for LRU
+    bool lookup(uint64_t blockAddress, uint64_t now);
+    // Removes entry and returns its bytes (valid until the next call; nullptr without data)
+    const uint8_t *take(int entry, bool &dirty);
+    // Adds blockAddress (refreshes it if present). A full buffer first drops its FIFO/LRU
+    // entry, writing it to memory if dirty. data: blockSize bytes, or nullptr without data.
+    void insert(uint64_t blockAddress, const uint8_t *data, bool dirty, uint64_t now, Memory &memory);
+    // A write-through store that did not allocate in the cache: keeps entry's copy current
+    void write(int entry, uint64_t address, MemSize size, uint64_t value);
+    // Writes every dirty entry to memory and marks it clean
+    void writeBackDirtyEntries(Memory &memory);
+    // Drops every entry and clears the counters
+    void invalidate();
+
+    void printStats(std::ostream &out, uint64_t cacheHits, uint64_t cacheAccesses) const;
+    void dump(std::ostream &out) const;
+
+    uint64_t getHits() const
+    {
+        return hits;
+    }
+    uint64_t getMisses() const
+    {
+        return misses;
+    }
+    uint64_t getWritebacks() const
+    {
+        return writebacks;
+    }
+
+    void saveState(CheckpointWriter &writer) const;
+    bool loadState(CheckpointReader &reader);
+
+private:
+    uint8_t *entryData(int entry)
+    {
+        return data.data() + static_cast<size_t>(entry) * blockSize;
+    }
+    const uint8_t *entryData(int entry) const
+    {
+        return data.data() + static_cast<size_t>(entry) * blockSize;
+    }
+
+    VictimKind kind;
+    bool lru;           // else FIFO
+    uint32_t blockSize;
+    // one entry per slot, like Cache's tag store
+    std::vector<uint64_t> blocks;     // block address
+    std::vector<uint8_t> valid;
+    std::vector<uint8_t> dirty;
+    std::vector<uint64_t> lastUsed;   // access count at the last insert or hit (LRU)
+    std::vector<uint64_t> insertedAt; // access count at the insert (FIFO)
+    std::vector<uint8_t> data;        // blockSize bytes per entry; empty without data
+    std::vector<uint8_t> taken;       // the bytes take() returns
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t writebacks = 0; // dirty entries pushed out to memory
+};
+
+#endif // VICTIM_CACHE_H
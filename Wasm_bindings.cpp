@@ -1,5 +1,6 @@
     #include <sstream>
     #include <memory>
+    #include <vector>
     #include "InteractiveSimulator.h"
     #include <emscripten/bind.h>
     using namespace emscripten;
@@ -12,10 +13,14 @@
         std::istringstream inputBuffer;
         std::ostringstream outputBuffer;
         InteractiveSimulator sim;
+        // last result of getDirtyRegionsSince(); the Uint8Array handed to JS views it
+        std::vector<uint8_t> dirtyRegions;
 
     public:
         WASMSimulator()
-            : inputBuffer(""), outputBuffer(), sim(inputBuffer, outputBuffer,ISAMode::RV64IM) {}
+            : inputBuffer(""), outputBuffer(), sim(inputBuffer, outputBuffer,ISAMode::RV64IM) {
+            sim.enableDirtyTracking();
+        }
 
         int load(const std::string& asmText) {
             
@@ -27,6 +32,40 @@
             return outputBuffer.str();
         }
 
+        // run(true) skips the per-instruction trace; use getHistory() to see where it ended
+        std::string run(bool quiet) {
+            bool wasQuiet = sim.isQuiet();
+            sim.setQuiet(quiet);
+            sim.run();
+            sim.setQuiet(wasQuiet);
+            return outputBuffer.str();
+        }
+
+        std::string getHistory() {
+            outputBuffer.str("");
+            outputBuffer.clear();
+            sim.dumpPcHistory();
+            return outputBuffer.str();
+        }
+
+        // Checkpoints live in the module's virtual filesystem; use FS.readFile / FS.writeFile
+        // to move them to and from the page
+        std::string saveCheckpoint(const std::string& filename) {
+            outputBuffer.str("");
+            outputBuffer.clear();
+            if (sim.saveCheckpoint(filename))
+                outputBuffer << "Checkpoint saved to " << filename << "\n";
+            return outputBuffer.str();
+        }
+
+        std::string loadCheckpoint(const std::string& filename) {
+            outputBuffer.str("");
+            outputBuffer.clear();
+            if (sim.loadCheckpoint(filename))
+                outputBuffer << "Checkpoint restored from " << filename << "\n";
+            return outputBuffer.str();
+        }
+
         int step() {
             return sim.step();
         }
@@ -73,6 +112,14 @@
             return outputBuffer.str();
         }
 
+        // Registers and memory pages changed since `epoch` (0 = everything), in the binary format
+        // described at Simulator::getDirtyRegionsSince(). The Uint8Array is a view into module
+        // memory and is only valid until the next call.
+        val getDirtyRegionsSince(double epoch) {
+            dirtyRegions = sim.getDirtyRegionsSince(static_cast<uint64_t>(epoch));
+            return val(typed_memory_view(dirtyRegions.size(), dirtyRegions.data()));
+        }
+
         std::string getStack() {
             outputBuffer.str("");
             outputBuffer.clear();
@@ -98,6 +145,9 @@
     regs                     Display register contents
     mem <addr> <count>       Show memory contents
     show-stack               Show the current call stack
+    history                  Show the last executed instructions
+    checkpoint save <file>   Save the full simulator state
+    checkpoint load <file>   Restore a saved state (same program)
     break <line>             Set a breakpoint
     del break <line>         Remove a breakpoint)";
         }
@@ -114,7 +164,8 @@
         class_<WASMSimulator>("Simulator")
             .constructor()
             .function("load", &WASMSimulator::load)
-            .function("run", &WASMSimulator::run)
+            .function("run", select_overload<std::string()>(&WASMSimulator::run))
+            .function("run", select_overload<std::string(bool)>(&WASMSimulator::run))
             .function("step", &WASMSimulator::step)
             .function("getRegisters", &WASMSimulator::getRegisters)
             .function("getCode", &WASMSimulator::getCode)
@@ -122,7 +173,11 @@
             .function("getNextBinLine", &WASMSimulator::getNextBinLine)
             .function("printFormattedAssembly", &WASMSimulator::printFormattedAssembly)
             .function("readMemory", &WASMSimulator::readMemory)
+            .function("getDirtyRegionsSince", &WASMSimulator::getDirtyRegionsSince)
             .function("getStack", &WASMSimulator::getStack)
+            .function("getHistory", &WASMSimulator::getHistory)
+            .function("saveCheckpoint", &WASMSimulator::saveCheckpoint)
+            .function("loadCheckpoint", &WASMSimulator::loadCheckpoint)
             .function("setBreakpoint", &WASMSimulator::setBreakpoint)
             .function("removeBreakpoint", &WASMSimulator::removeBreakpoint)
             .function("getHelpText", &WASMSimulator::getHelpText);
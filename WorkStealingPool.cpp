@@ -0,0 +1,104 @@
+/**
+ * @file WorkStealingPool.cpp
+ * @brief Per-thread task queues with stealing.
+ *
+ * No task adds new work, so a thread that finds its own queue and every other queue empty
+ * can stop: all remaining tasks are already running on some thread.
+ */
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct TaskQueue
+    {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount) : threadCount(threadCount)
+{
+    if (this->threadCount <= 0)
+        this->threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)> &task)
+{
+    int workers = (int)std::min<size_t>(threadCount, count);
+    if (workers <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    for (int w = 0; w < workers; ++w)
+        queues.push_back(std::make_unique<TaskQueue>());
+    for (size_t i = 0; i < count; ++i)
+        queues[i % workers]->tasks.push_back(i);
+
+    std::mutex errorLock;
+    std::exception_ptr firstError;
+
+    auto takeTask = [&](int self, size_t &index)
+    {
+        {
+            std::lock_guard<std::mutex> guard(queues[self]->lock);
+            if (!queues[self]->tasks.empty())
+            {
+                index = queues[self]->tasks.back();
+                queues[self]->tasks.pop_back();
+                return true;
+            }
+        }
+        for (int offset = 1; offset < workers; ++offset)
+        {
+            TaskQueue &victim = *queues[(self + offset) % workers];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                index = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto worker = [&](int self)
+    {
+        size_t index;
+        while (takeTask(self, index))
+        {
+            try
+            {
+                task(index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!firstError)
+                    firstError = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; ++w)
+        threads.emplace_back(worker, w);
+    worker(0); // the calling thread is worker 0
+    for (auto &thread : threads)
+        thread.join();
+
+    if (firstError)
+        std::rethrow_exception(firstError);
+}
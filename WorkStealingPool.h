@@ -0,0 +1,39 @@
+/**
+ * @class WorkStealingPool
+ * @brief Runs a batch of independent tasks on a fixed number of host threads.
+ *
+ * parallelFor(count, task) calls task(i) once for every i in [0, count):
+ * - The indices are dealt round-robin into one queue per thread.
+ * - Each thread takes work from the back of its own queue. When that is empty, it steals from
+ *   the front of the other threads' queues, so a thread that drew short tasks helps the
+ *   ones that drew long ones.
+ * - parallelFor() returns once every task has finished. If a task throws, the first
+ *   exception is rethrown on the calling thread after all threads have stopped.
+ *
+ * Tasks run in no particular order. Callers that need deterministic output should write
+ * result i into slot i of a pre-sized vector and report the vector in index order.
+ */
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+class WorkStealingPool
+{
+public:
+    // threadCount <= 0 uses one thread per host core
+    explicit WorkStealingPool(int threadCount = 0);
+
+    int getThreadCount() const
+    {
+        return threadCount;
+    }
+
+    void parallelFor(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    int threadCount;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,187 @@
+/**
+ * @file WriteBuffer.cpp
+ * @brief Store coalescing, draining, full-buffer stalls and checkpointing of the write buffer.
+ */
+#include "WriteBuffer.h"
+
+#include <algorithm>
+#include "CacheBlock.h"
+
+WriteBuffer::WriteBuffer(const CacheConfig &config, bool holdsData)
+    : capacity(static_cast<size_t>(config.writeBufferEntries)),
+      drainCycles(static_cast<uint64_t>(config.writeBufferDrain)),
+      blockSize(static_cast<uint32_t>(config.blockSize)), holdsData(holdsData)
+{
+    entries.reserve(capacity);
+}
+
+uint64_t WriteBuffer::store(uint64_t address, MemSize size, uint64_t value, uint64_t now, Memory &memory)
+{
+    uint64_t clock = now + stallCycles;
+    advance(clock, memory);
+    ++stores;
+
+    uint64_t blockAddress = address & ~static_cast<uint64_t>(blockSize - 1);
+    auto entry = std::find_if(entries.begin(), entries.end(),
+                              [blockAddress](const Entry &e)
+                              { return e.blockAddress == blockAddress; });
+    uint64_t stall = 0;
+    if (entry != entries.end())
+    {
+        ++coalesced;
+    }
+    else
+    {
+        if (entries.size() >= capacity)
+        {
+            // wait for the oldest entry to reach memory
+            stall = nextDrainAt - clock;
+            ++fullStalls;
+            stallCycles += stall;
+            clock = nextDrainAt;
+            advance(clock, memory);
+        }
+        if (entries.empty())
+            nextDrainAt = clock + drainCycles;
+        entries.emplace_back();
+        entry = entries.end() - 1;
+        entry->blockAddress = blockAddress;
+        if (holdsData)
+        {
+            entry->bytes.assign(blockSize, 0);
+            entry->written.assign(blockSize, 0);
+        }
+    }
+
+    if (holdsData)
+    {
+        CacheBlock::writeBytes(entry->bytes.data(), blockSize, address, size, value, blockSize);
+        uint64_t offset = address - blockAddress;
+        uint64_t end = std::min<uint64_t>(offset + static_cast<uint64_t>(size), blockSize);
+        std::fill(entry->written.begin() + offset, entry->written.begin() + end, 1);
+    }
+    if (drainCycles == 0)
+        advance(clock, memory); // drains as fast as stores come: nothing ever waits
+    return stall;
+}
+
+void WriteBuffer::advance(uint64_t clock, Memory &memory)
+{
+    while (!entries.empty() && nextDrainAt <= clock)
+    {
+        retireOldest(memory);
+        // the next entry starts draining once this one is done
+        nextDrainAt += drainCycles;
+    }
+}
+
+void WriteBuffer::retireOldest(Memory &memory)
+{
+    const Entry &oldest = entries.front();
+    if (holdsData)
+    {
+        // one write per run of stored bytes, so bytes no store touched keep memory's value
+        for (uint32_t offset = 0; offset < blockSize;)
+        {
+            if (!oldest.written[offset])
+            {
+                ++offset;
+                continue;
+            }
+            uint32_t end = offset;
+            while (end < blockSize && oldest.written[end])
+                ++end;
+            memory.writeBytes(oldest.blockAddress + offset, oldest.bytes.data() + offset, end - offset);
+            offset = end;
+        }
+    }
+    ++memoryWrites;
+    entries.erase(entries.begin());
+}
+
+void WriteBuffer::forward(uint64_t blockAddress, uint8_t *line) const
+{
+    for (const Entry &entry : entries)
+    {
+        if (entry.blockAddress != blockAddress || !holdsData)
+            continue;
+        for (uint32_t i = 0; i < blockSize; ++i)
+        {
+            if (entry.written[i])
+                line[i] = entry.bytes[i];
+        }
+        return; // stores coalesce, so a block has at most one entry
+    }
+}
+
+void WriteBuffer::drainAll(Memory &memory)
+{
+    while (!entries.empty())
+        retireOldest(memory);
+}
+
+void WriteBuffer::invalidate()
+{
+    entries.clear();
+    nextDrainAt = 0;
+    stores = coalesced = memoryWrites = fullStalls = stallCycles = 0;
+}
+
+void WriteBuffer::printStats(std::ostream &out) const
+{
+    out << "Write buffer (" << capacity << " entries, drain every " << drainCycles << "):   Stores: " << stores
+        << "   Coalesced: " << coalesced << " (" << (stores ? static_cast<double>(coalesced) / stores * 100.0 : 0.0)
+        << "%)   Memory writes: " << memoryWrites << "   Full stalls: " << fullStalls
+        << "   Stall cycles: " << stallCycles << "\n";
+}
+
+void WriteBuffer::dump(std::ostream &out) const
+{
+    if (entries.empty())
+        return;
+    out << "Write buffer:\n";
+    for (const Entry &entry : entries)
+    {
+        out << "  Block: 0x" << std::hex << entry.blockAddress << std::dec;
+        if (holdsData)
+            out << " | Bytes written: " << std::count(entry.written.begin(), entry.written.end(), 1);
+        out << "\n";
+    }
+}
+
+void WriteBuffer::saveState(CheckpointWriter &writer) const
+{
+    const uint64_t counters[] = {nextDrainAt, stores, coalesced, memoryWrites, fullStalls, stallCycles};
+    for (uint64_t counter : counters)
+        writer.writeU64(counter);
+    writer.writeU32(static_cast<uint32_t>(entries.size()));
+    for (const Entry &entry : entries)
+    {
+        writer.writeU64(entry.blockAddress);
+        writer.writeBytes(entry.bytes.data(), entry.bytes.size());
+        writer.writeBytes(entry.written.data(), entry.written.size());
+    }
+}
+
+bool WriteBuffer::loadState(CheckpointReader &reader)
+{
+    uint64_t *counters[] = {&nextDrainAt, &stores, &coalesced, &memoryWrites, &fullStalls, &stallCycles};
+    for (uint64_t *counter : counters)
+        *counter = reader.readU64();
+    uint32_t count = reader.readU32();
+    if (!reader.isGood() || count > capacity)
+        return false;
+    entries.assign(count, Entry());
+    for (Entry &entry : entries)
+    {
+        entry.blockAddress = reader.readU64();
+        if (holdsData)
+        {
+            entry.bytes.resize(blockSize);
+            entry.written.resize(blockSize);
+            reader.readBytes(entry.bytes.data(), blockSize);
+            reader.readBytes(entry.written.data(), blockSize);
+        }
+    }
+    return reader.isGood();
+}
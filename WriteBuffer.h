@@ -0,0 +1,83 @@
+/**
+ * @class WriteBuffer
+ * @brief Coalescing write buffer between a write-through Cache and Memory.
+ *
+ * With WritePolicy::WT every store goes to memory; the buffer takes it instead and lets the
+ * cache go on. It holds writeBufferEntries entries, one per block, in FIFO order:
+ *
+ *   - a store to a block already buffered merges into that entry (coalescing);
+ *   - otherwise it takes a free entry, or, when all are in use, stalls until the oldest
+ *     entry has drained;
+ *   - the oldest entry is written to memory every writeBufferDrain cycles while the buffer
+ *     is not empty (one memory write per entry, however many stores merged into it).
+ *
+ * The cache model has no clock of its own, so time is Cache's access count plus the cycles
+ * stores have stalled so far: one access per cycle.
+ *
+ * With CacheModel::DATA entries keep the stored bytes (and a written flag per byte) until they
+ * drain, and forward() lays them over a block being filled from memory so loads never see stale
+ * data. With CacheModel::TIMING memory is written at once and entries only keep the timing.
+ */
+#ifndef WRITE_BUFFER_H
+#define WRITE_BUFFER_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "CacheConfig.h"
+#include "Checkpoint.h"
+#include "Memory.h"
+
+class WriteBuffer
+{
+public:
+    // holdsData: entries keep the stored bytes until they drain (CacheModel::DATA)
+    WriteBuffer(const CacheConfig &config, bool holdsData);
+
+    // A store of size bytes at access count now; returns the cycles it stalled (0 unless the
+    // buffer was full and the store's block was not in it)
+    uint64_t store(uint64_t address, MemSize size, uint64_t value, uint64_t now, Memory &memory);
+    // Copies the buffered bytes of blockAddress over line (blockSize bytes)
+    void forward(uint64_t blockAddress, uint8_t *line) const;
+    // Writes every entry to memory and empties the buffer
+    void drainAll(Memory &memory);
+    // Drops every entry and clears the counters (drainAll() first to keep the stores)
+    void invalidate();
+
+    uint64_t getStallCycles() const
+    {
+        return stallCycles;
+    }
+
+    void printStats(std::ostream &out) const;
+    void dump(std::ostream &out) const;
+
+    void saveState(CheckpointWriter &writer) const;
+    bool loadState(CheckpointReader &reader);
+
+private:
+    struct Entry
+    {
+        uint64_t blockAddress = 0;
+        std::vector<uint8_t> bytes;   // blockSize bytes; empty without data
+        std::vector<uint8_t> written; // 1 for each byte a store wrote
+    };
+    // drains every entry due by time clock
+    void advance(uint64_t clock, Memory &memory);
+    void retireOldest(Memory &memory);
+
+    size_t capacity;
+    uint64_t drainCycles;
+    uint32_t blockSize;
+    bool holdsData;
+    std::vector<Entry> entries; // oldest first
+    uint64_t nextDrainAt = 0;   // time the oldest entry finishes draining
+
+    uint64_t stores = 0;        // stores that entered the buffer
+    uint64_t coalesced = 0;     // of those, merged into an entry already there
+    uint64_t memoryWrites = 0;  // entries drained to memory
+    uint64_t fullStalls = 0;    // stores that found the buffer full
+    uint64_t stallCycles = 0;   // cycles those stores waited
+};
+
+#endif // WRITE_BUFFER_H
@@ -2,12 +2,23 @@
 #include "DeAssembler.h"
 #include "InstructionSet.h"
 #include "TestRunner.h"
+#include "Benchmark.h"
 #include "InteractiveSimulator.h"
+#include "MultiHartSimulator.h"
+#include "BatchRunner.h"
+#include "SampledSimulator.h"
+#include "WorkStealingPool.h"
+#include "CacheTrace.h"
+#include "CacheSweep.h"
+#include "StackDistance.h"
 
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <filesystem>
 
 bool fileExists(const std::string &filename)
 {
@@ -106,6 +117,532 @@ void disassembleFile(const std::string &binFilePath, ISAMode mode = ISAMode::RV3
     return;
 }
 
+bool readAsmFile(const std::string &asmFilePath, std::vector<std::string> &asmLines)
+{
+    std::ifstream inFile(asmFilePath);
+    if (!inFile)
+    {
+        std::cerr << "Error: Could not open assembly input file '" << asmFilePath << "'\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(inFile, line))
+    {
+        asmLines.push_back(line);
+    }
+    return true;
+}
+
+// A --map or --map-private option of -r
+struct FileMapping
+{
+    std::string path;
+    uint32_t guestAddress;
+    Memory::MapMode mode;
+};
+
+// Maps the files into the simulator's memory (after load); false if one of them fails
+bool applyMappings(Simulator &simulator, const std::vector<FileMapping> &mappings)
+{
+    for (const auto &mapping : mappings)
+    {
+        if (!simulator.mapFile(mapping.path, mapping.guestAddress, mapping.mode))
+            return false;
+    }
+    return true;
+}
+
+// Assembles and runs a program to completion. With validate, every block is also
+// executed on an interpreter-only Simulator and compared (JIT lockstep validation).
+// With quiet, there is no per-instruction trace; the last executed PCs are printed if the run stops on an error.
+int runFile(const std::string &asmFilePath, ISAMode mode, bool useJit, bool validate, bool quiet,
+            const std::vector<FileMapping> &mappings, const std::string &traceFile)
+{
+    std::vector<std::string> asmLines;
+    if (!readAsmFile(asmFilePath, asmLines))
+        return 1;
+
+    Simulator simulator(std::cin, std::cout, mode);
+    if (simulator.getAssembler().assemble(asmLines).empty())
+    {
+        std::cerr << "Error: Could not assemble '" << asmFilePath << "'\n";
+        return 1;
+    }
+
+    // the reference only needs the program; its output is discarded
+    std::istringstream nullIn;
+    std::ostream nullOut(nullptr);
+    Simulator reference(nullIn, nullOut, mode);
+    if (validate)
+    {
+        reference.getAssembler().assemble(asmLines);
+        reference.load(reference.getAssembler().getInstructions());
+        if (!applyMappings(reference, mappings))
+            return 1;
+        simulator.setLockstepReference(&reference);
+    }
+    // compile every block on first use when validating so that all of them are checked
+    if (useJit || validate)
+        simulator.enableJit(validate ? 1 : JitCompiler::DEFAULT_HOT_THRESHOLD);
+
+    simulator.setQuiet(quiet);
+    simulator.load(simulator.getAssembler().getInstructions());
+    if (!applyMappings(simulator, mappings))
+        return 1;
+    if (!traceFile.empty() && !simulator.startTrace(traceFile))
+        return 1;
+    simulator.run();
+    simulator.stopTrace();
+    std::cout << "Instructions executed: " << simulator.getInstructionCount() << "\n";
+    if (validate)
+    {
+        if (simulator.hasLockstepMismatch())
+            return 1;
+        std::cout << "Lockstep validation passed.\n";
+    }
+    return 0;
+}
+
+// Runs a program in sampled mode: functional fast-forward with detailed cache/pipeline windows
+int runFileSampled(const std::string &asmFilePath, ISAMode mode, bool useJit,
+                   const std::string &cacheConfigFile, const SamplingConfig &sampling,
+                   const std::vector<FileMapping> &mappings)
+{
+    std::vector<std::string> asmLines;
+    if (!readAsmFile(asmFilePath, asmLines))
+        return 1;
+    CacheConfig cacheConfig;
+    if (!cacheConfig.loadFromFile(cacheConfigFile))
+    {
+        std::cerr << "Error: Could not load cache config '" << cacheConfigFile << "'\n";
+        return 1;
+    }
+
+    Simulator simulator(std::cin, std::cout, mode);
+    if (simulator.getAssembler().assemble(asmLines).empty())
+    {
+        std::cerr << "Error: Could not assemble '" << asmFilePath << "'\n";
+        return 1;
+    }
+    if (useJit)
+        simulator.enableJit();
+    simulator.load(simulator.getAssembler().getInstructions());
+    if (!applyMappings(simulator, mappings))
+        return 1;
+
+    SampledSimulator sampler(simulator, cacheConfig, sampling);
+    if (!sampler.isValid(std::cerr))
+        return 1;
+    sampler.run();
+    sampler.printReport(std::cout);
+    return 0;
+}
+
+// Runs a program to forkPoint instructions, snapshots it, and finishes the run once per cache
+// config, each on its own Simulator built from the snapshot (memory shared copy-on-write)
+int runFileForked(const std::string &asmFilePath, ISAMode mode, bool useJit, uint64_t forkPoint,
+                  const std::vector<std::string> &cacheConfigFiles, const std::vector<FileMapping> &mappings)
+{
+    std::vector<std::string> asmLines;
+    if (!readAsmFile(asmFilePath, asmLines))
+        return 1;
+
+    Simulator simulator(std::cin, std::cout, mode);
+    if (simulator.getAssembler().assemble(asmLines).empty())
+    {
+        std::cerr << "Error: Could not assemble '" << asmFilePath << "'\n";
+        return 1;
+    }
+    if (useJit)
+        simulator.enableJit();
+    simulator.setQuiet(true);
+    simulator.load(simulator.getAssembler().getInstructions());
+    if (!applyMappings(simulator, mappings))
+        return 1;
+    simulator.runFor(forkPoint);
+    std::shared_ptr<const Simulator::Snapshot> snapshot = simulator.takeSnapshot();
+    std::cout << "Forking " << cacheConfigFiles.size() << " runs at instruction " << snapshot->instructionCount
+              << " (" << snapshot->memory->getPageCount() << " pages shared)\n";
+
+    struct ForkResult
+    {
+        bool cacheEnabled = false;
+        uint64_t instructions = 0;
+        int exitCode = 0;
+        uint64_t accesses = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+    std::vector<ForkResult> results(cacheConfigFiles.size());
+    WorkStealingPool pool;
+    pool.parallelFor(cacheConfigFiles.size(), [&](size_t i)
+                     {
+        std::istringstream nullIn;
+        std::ostream nullOut(nullptr);
+        Simulator fork(*snapshot, nullIn, nullOut);
+        fork.setQuiet(true);
+        if (useJit)
+            fork.enableJit();
+        fork.enableCache(cacheConfigFiles[i]);
+        ForkResult &result = results[i];
+        result.cacheEnabled = fork.getCacheSimulator().isEnabled();
+        fork.runFor(UINT64_MAX);
+        result.instructions = fork.getInstructionCount();
+        result.exitCode = fork.getExitCode();
+        const Cache &cache = fork.getCacheSimulator().getCache();
+        result.accesses = cache.getAccesses();
+        result.hits = cache.getHits();
+        result.misses = cache.getMisses(); });
+
+    size_t nameWidth = 14;
+    for (const auto &name : cacheConfigFiles)
+        nameWidth = std::max(nameWidth, name.size() + 2);
+    std::cout << std::left << std::setw(nameWidth) << "cache config" << std::right << std::setw(14) << "instructions"
+              << std::setw(8) << "exit" << std::setw(12) << "accesses" << std::setw(12) << "hits"
+              << std::setw(12) << "misses" << std::setw(10) << "hit %" << "\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const ForkResult &r = results[i];
+        std::cout << std::left << std::setw(nameWidth) << cacheConfigFiles[i] << std::right;
+        if (!r.cacheEnabled)
+        {
+            std::cout << "  could not load the config\n";
+            continue;
+        }
+        std::cout << std::setw(14) << r.instructions << std::setw(8) << r.exitCode << std::setw(12) << r.accesses
+                  << std::setw(12) << r.hits << std::setw(12) << r.misses << std::setw(10) << std::fixed
+                  << std::setprecision(2) << (r.accesses ? 100.0 * r.hits / r.accesses : 0.0) << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    return 0;
+}
+
+// Runs a program on hartCount harts sharing one memory; see MultiHartSimulator
+int runFileMultiHart(const std::string &asmFilePath, ISAMode mode, bool useJit, bool quiet,
+                     int hartCount, uint64_t quantum, bool deterministic)
+{
+    std::vector<std::string> asmLines;
+    if (!readAsmFile(asmFilePath, asmLines))
+        return 1;
+
+    MultiHartSimulator simulator(std::cout, mode, hartCount, quantum, deterministic);
+    if (!simulator.load(asmLines))
+    {
+        std::cerr << "Error: Could not assemble '" << asmFilePath << "'\n";
+        return 1;
+    }
+    if (useJit)
+        simulator.enableJit();
+    simulator.setQuiet(quiet);
+    simulator.run();
+    return 0;
+}
+
+// Simulates every program on a thread pool and writes one CSV (or .json) summary; see BatchRunner
+int runBatch(const std::vector<std::string> &paths, ISAMode mode, bool useJit, int threads,
+             const std::string &cacheConfigFile, uint64_t maxInstructions, const std::string &summaryFile)
+{
+    if (!cacheConfigFile.empty())
+    {
+        CacheConfig config;
+        if (!config.loadFromFile(cacheConfigFile))
+        {
+            std::cerr << "Error: Could not load cache config '" << cacheConfigFile << "'\n";
+            return 1;
+        }
+    }
+    std::vector<std::string> programs = BatchRunner::collectPrograms(paths);
+    if (programs.empty())
+    {
+        std::cerr << "Error: No .s programs found\n";
+        return 1;
+    }
+
+    BatchRunner runner(mode, threads, cacheConfigFile, maxInstructions, useJit);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = runner.run(programs);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream summary(summaryFile);
+    if (!summary)
+    {
+        std::cerr << "Error: Could not write summary file '" << summaryFile << "'\n";
+        return 1;
+    }
+    bool json = summaryFile.size() >= 5 && summaryFile.compare(summaryFile.size() - 5, 5, ".json") == 0;
+    if (json)
+        BatchRunner::writeJson(summary, results);
+    else
+        BatchRunner::writeCsv(summary, results);
+
+    uint64_t totalInstructions = 0;
+    int exited = 0;
+    for (const auto &r : results)
+    {
+        totalInstructions += r.instructions;
+        if (r.status == "exited" || r.status == "completed")
+            ++exited;
+    }
+    std::cout << "Batch: " << results.size() << " programs (" << exited << " ran to completion) on "
+              << runner.getThreadCount() << " threads, " << totalInstructions << " instructions in "
+              << std::fixed << std::setprecision(3) << seconds << " s\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "Summary written to " << summaryFile << "\n";
+    return 0;
+}
+
+// Runs the loads and stores of an address trace through one cache, without a program
+int runCacheTrace(const std::string &tracePath, const std::string &configFile)
+{
+    CacheConfig config;
+    if (!config.loadFromFile(configFile))
+    {
+        std::cerr << "Error: Could not load cache config '" << configFile << "'\n";
+        return 1;
+    }
+    CacheTraceReader reader;
+    if (!reader.open(tracePath))
+    {
+        std::cerr << "Error: " << reader.getError() << "\n";
+        return 1;
+    }
+
+    std::ostream nullOut(nullptr);
+    Memory memory(nullOut);
+    Cache cache;
+    cache.enable(config, memory);
+
+    const size_t batchSize = 4096;
+    std::vector<CacheAccess> batch;
+    batch.reserve(batchSize);
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (reader.nextBatch(batch, batchSize) > 0)
+    {
+        for (const CacheAccess &access : batch)
+            ++(access.isWrite ? stores : loads);
+        cache.accessBatch(batch);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!reader.getError().empty())
+    {
+        std::cerr << "Error: " << tracePath << ": " << reader.getError() << "\n";
+        return 1;
+    }
+
+    std::cout << "Trace " << tracePath << " (" << (reader.isBinary() ? "binary" : "din") << "): " << loads
+              << " loads, " << stores << " stores";
+    if (reader.getSkippedCount() > 0)
+        std::cout << ", " << reader.getSkippedCount() << " other records skipped";
+    std::cout << "\n";
+    cache.printStats(std::cout);
+    std::cout << "Simulated in " << std::fixed << std::setprecision(3) << seconds << " s ("
+              << std::setprecision(1) << (seconds > 0 ? (loads + stores) / seconds / 1e6 : 0.0)
+              << " M accesses/s)\n";
+    std::cout.unsetf(std::ios::floatfield);
+    return 0;
+}
+
+// Reads the loads and stores of a trace file, or of a program (.s/.asm) run once with its
+// trace recorded to a temporary file, into memory
+bool loadAccessTrace(const std::string &input, ISAMode mode, std::vector<CacheAccess> &trace)
+{
+    std::string tracePath = input;
+    bool isProgram = input.size() >= 2 && (input.compare(input.size() - 2, 2, ".s") == 0 ||
+                                           (input.size() >= 4 && input.compare(input.size() - 4, 4, ".asm") == 0));
+    if (isProgram)
+    {
+        // record the program's accesses to a temporary trace first
+        std::vector<std::string> asmLines;
+        if (!readAsmFile(input, asmLines))
+            return false;
+        std::istringstream nullIn;
+        std::ostream nullOut(nullptr);
+        Simulator simulator(nullIn, nullOut, mode);
+        if (simulator.getAssembler().assemble(asmLines).empty())
+        {
+            std::cerr << "Error: Could not assemble '" << input << "'\n";
+            return false;
+        }
+        simulator.setQuiet(true);
+        simulator.load(simulator.getAssembler().getInstructions());
+        std::error_code ec;
+        std::filesystem::path tempDir = std::filesystem::temp_directory_path(ec);
+        tracePath = (tempDir / ("riscv_trace_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                                ".trace"))
+                        .string();
+        if (!simulator.startTrace(tracePath))
+        {
+            std::cerr << "Error: Could not create a temporary trace\n";
+            return false;
+        }
+        simulator.run();
+        simulator.stopTrace();
+        std::cout << "Traced " << input << ": " << simulator.getInstructionCount() << " instructions\n";
+    }
+
+    std::string error;
+    bool loaded = CacheSweep::loadTrace(tracePath, trace, error);
+    if (isProgram)
+        std::filesystem::remove(tracePath);
+    if (!loaded)
+    {
+        std::cerr << "Error: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Simulates a trace (or the trace of a program) under every config of a grid; see CacheSweep
+int runCacheSweep(const std::string &input, ISAMode mode, const CacheSweepGrid &grid, int threads,
+                  const std::string &outputFile)
+{
+    size_t skipped = 0;
+    std::vector<CacheConfig> configs = grid.expand(skipped);
+    if (configs.empty())
+    {
+        std::cerr << "Error: The grid has no valid cache configuration\n";
+        return 1;
+    }
+
+    std::vector<CacheAccess> trace;
+    if (!loadAccessTrace(input, mode, trace))
+        return 1;
+
+    CacheSweep sweep(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<CacheSweepResult> results = sweep.run(configs, trace);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream output(outputFile);
+    if (!output)
+    {
+        std::cerr << "Error: Could not write sweep file '" << outputFile << "'\n";
+        return 1;
+    }
+    bool json = outputFile.size() >= 5 && outputFile.compare(outputFile.size() - 5, 5, ".json") == 0;
+    if (json)
+        CacheSweep::writeJson(output, results);
+    else
+        CacheSweep::writeCsv(output, results);
+
+    std::cout << "Sweep: " << results.size() << " cache configs";
+    if (skipped > 0)
+        std::cout << " (" << skipped << " invalid combinations skipped)";
+    std::cout << " x " << trace.size() << " accesses on " << sweep.getThreadCount() << " threads in " << std::fixed
+              << std::setprecision(3) << seconds << " s\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "Results written to " << outputFile << "\n";
+    return 0;
+}
+
+// Stack-distance miss-ratio curves for every block size x set count; see StackDistanceProfiler.
+// With check, sampled points of every curve are re-simulated with an LRU write-back Cache.
+int runStackDistance(const std::string &input, ISAMode mode, const std::vector<int> &blockSizes,
+                     const std::vector<int> &setCounts, bool check, const std::string &outputFile)
+{
+    const uint64_t maxCacheSize = 1024 * 1024; // the largest cache CacheConfig accepts
+    auto isPowerOfTwo = [](int x)
+    { return x > 0 && (x & (x - 1)) == 0; };
+    std::vector<StackDistanceProfiler> profilers;
+    for (int block : blockSizes)
+        for (int setCount : setCounts)
+        {
+            if (!isPowerOfTwo(block) || !isPowerOfTwo(setCount) ||
+                static_cast<uint64_t>(block) * setCount > maxCacheSize)
+            {
+                std::cerr << "Error: Block size " << block << " x " << setCount
+                          << " sets is not a power-of-two geometry up to 1 MB\n";
+                return 1;
+            }
+            profilers.emplace_back(block, setCount, static_cast<uint32_t>(maxCacheSize / (block * setCount)));
+        }
+
+    std::vector<CacheAccess> trace;
+    if (!loadAccessTrace(input, mode, trace))
+        return 1;
+
+    WorkStealingPool pool;
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(profilers.size(), [&](size_t i)
+                     { profilers[i].accessBatch(trace.data(), trace.size()); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream output(outputFile);
+    if (!output)
+    {
+        std::cerr << "Error: Could not write curve file '" << outputFile << "'\n";
+        return 1;
+    }
+    bool json = outputFile.size() >= 5 && outputFile.compare(outputFile.size() - 5, 5, ".json") == 0;
+    if (json)
+        StackDistanceProfiler::writeJson(output, profilers);
+    else
+        StackDistanceProfiler::writeCsv(output, profilers);
+    std::cout << "Stack distance: " << profilers.size() << " curves x " << trace.size() << " accesses in "
+              << std::fixed << std::setprecision(3) << seconds << " s\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "Curves written to " << outputFile << "\n";
+    if (!check)
+        return 0;
+
+    // the smallest, middle and largest point of each curve that Cache can build cheaply
+    // (at most 16 ways, or 256 blocks when fully associative)
+    struct CheckPoint
+    {
+        size_t profiler;
+        StackDistanceProfiler::CurvePoint point;
+        CacheConfig config;
+        uint64_t cacheMisses = 0;
+    };
+    std::vector<CheckPoint> checks;
+    for (size_t i = 0; i < profilers.size(); ++i)
+    {
+        std::vector<CheckPoint> candidates;
+        for (const auto &point : profilers[i].missRatioCurve())
+        {
+            CheckPoint c{i, point, CacheConfig(), 0};
+            c.config.cacheSize = static_cast<int>(point.cacheSize);
+            c.config.blockSize = static_cast<int>(profilers[i].getBlockSize());
+            bool fullyAssociative = profilers[i].getSetCount() == 1;
+            c.config.associativity = fullyAssociative ? 0 : static_cast<int>(point.associativity);
+            c.config.replacementPolicy = ReplacementPolicy::LRU;
+            c.config.writePolicy = WritePolicy::WB;
+            if (c.config.isValid() && point.associativity <= (fullyAssociative ? 256u : 16u))
+                candidates.push_back(c);
+        }
+        if (candidates.empty())
+            continue;
+        checks.push_back(candidates.front());
+        if (candidates.size() > 2)
+            checks.push_back(candidates[candidates.size() / 2]);
+        if (candidates.size() > 1)
+            checks.push_back(candidates.back());
+    }
+    pool.parallelFor(checks.size(), [&](size_t i)
+                     {
+        std::ostream nullOut(nullptr);
+        Memory memory(nullOut);
+        Cache cache;
+        cache.enable(checks[i].config, memory);
+        cache.accessBatch(trace);
+        checks[i].cacheMisses = cache.getMisses(); });
+    int mismatches = 0;
+    for (const CheckPoint &c : checks)
+    {
+        if (c.cacheMisses == c.point.misses)
+            continue;
+        ++mismatches;
+        std::cout << "Mismatch: block " << c.config.blockSize << ", " << profilers[c.profiler].getSetCount()
+                  << " sets, " << c.point.associativity << " ways: curve " << c.point.misses << " misses, Cache "
+                  << c.cacheMisses << "\n";
+    }
+    std::cout << "Checked " << checks.size() << " points against Cache (LRU, WB): "
+              << (mismatches ? std::to_string(mismatches) + " mismatches" : "all match") << "\n";
+    return mismatches ? 1 : 0;
+}
+
 void printUsage(const std::string &programName)
 {
     std::cout << "Usage:\n"
@@ -115,8 +652,63 @@ void printUsage(const std::string &programName)
               << "      Assemble the assembly code file into machine code.\n\n"
               << "  " << programName << " [-mode <mode>] -d <binary-file> | --disassemble <binary-file>\n"
               << "      Disassemble the machine code file into assembly.\n\n"
+              << "  " << programName << " [-mode <mode>] [-jit | -jit-validate] -r <assembly-file> | --run <assembly-file> [--quiet]\n"
+              << "          [--harts <n>] [--quantum <instructions>] [--deterministic]\n"
+              << "      Assemble and run a program to completion. --quiet skips the per-instruction trace.\n"
+              << "      --harts runs n harts sharing one memory, each on its own host thread, synchronized\n"
+              << "      every --quantum instructions (default " << MultiHartSimulator::DEFAULT_QUANTUM << "); hart i starts with a0 = i, a1 = n.\n"
+              << "      --deterministic interleaves the harts round-robin on one thread instead.\n"
+              << "          [--sample <cache-config> [--period <n>] [--warmup <n>] [--window <n>]]\n"
+              << "      --sample runs functionally and switches cache and pipeline timing on for a warmup and a\n"
+              << "      measurement window every period instructions (defaults 1000000, 10000, 10000), then\n"
+              << "      reports CPI, cycles, hit rate and stalls extrapolated with 95% confidence intervals.\n"
+              << "          [--fork-at <n> --fork-cache <config> [--fork-cache <config>...]]\n"
+              << "      --fork-at runs n instructions without the cache, snapshots the state and finishes the run once\n"
+              << "      per --fork-cache config, in parallel, each fork sharing the snapshot's memory copy-on-write.\n"
+              << "          [--trace <trace-file>]\n"
+              << "      --trace records every executed instruction (pc, opcode, rd value, memory access) to a\n"
+              << "      compact binary trace; JIT-compiled code is not used while tracing.\n"
+              << "          [--map <file> <addr>] [--map-private <file> <addr>]\n"
+              << "      Map a host file into guest memory at a 4 KiB aligned address before running, read-only\n"
+              << "      (stores ignored) or private copy-on-write. May be repeated; not with --harts.\n\n"
+              << "  " << programName << " [-mode <mode>] [-jit] --batch <file-or-dir>... [--threads <n>] [--cache <config>]\n"
+              << "          [--max-instructions <n>] [--summary <file.csv|file.json>]\n"
+              << "      Simulate many programs in parallel, one Simulator each, and write exit code, instruction\n"
+              << "      count and cache statistics per program to one summary (default batch_summary.csv).\n"
+              << "      Directories contribute their .s files; the summary does not depend on --threads.\n\n"
               << "  " << programName << " [-mode <mode>] -s | --simulate\n"
-              << "      Launch the simulator in interactive mode.\n\n";
+              << "      Launch the simulator in interactive mode.\n\n"
+              << "  " << programName << " [-mode <mode>] -b | --bench [iterations]\n"
+              << "      Measure simulator throughput (MIPS) on the programs under Test.\n\n"
+              << "  " << programName << " --trace-dump <trace-file> [count]\n"
+              << "      Print the first count instructions (default all) of a trace written with --trace.\n\n"
+              << "  " << programName << " -cachesim <trace-file> <cache-config>\n"
+              << "      Run the loads and stores of a trace through a cache and print its statistics. The trace is\n"
+              << "      either a binary trace written with --trace or a Dinero din text trace (label address [size]).\n\n"
+              << "  " << programName << " [-mode <mode>] -cachesweep <trace-file | assembly-file> [--sizes <list>] [--blocks <list>]\n"
+              << "          [--assoc <list>] [--repl <list>] [--write <list>] [--threads <n>] [--output <file.csv|file.json>]\n"
+              << "      Simulate a trace (or the trace of a program) under every combination of the comma-separated\n"
+              << "      lists, in parallel, and write one table of accesses, hits, misses and hit rate per config\n"
+              << "      (default cache_sweep.csv) for CachesimulatorGUI.py. Defaults: sizes 1024..65536, blocks\n"
+              << "      16,32,64, assoc 1,2,4,8,16 (0 = fully associative), repl FIFO,LRU,RANDOM (also PLRU, NRU,\n"
+              << "      SRRIP, BRRIP, DRRIP), write WB,WT.\n\n"
+              << "  " << programName << " [-mode <mode>] -stackdist <trace-file | assembly-file> [--blocks <list>] [--sets <list>]\n"
+              << "          [--check] [--output <file.csv|file.json>]\n"
+              << "      One-pass LRU stack-distance analysis: the miss-ratio curve over every associativity (and so\n"
+              << "      every cache size up to 1 MB) for each block size x set count (defaults 16,32,64 x 1,16,64,256),\n"
+              << "      written to one table (default stack_distance.csv). --check re-simulates sampled points of\n"
+              << "      each curve with an LRU write-back Cache and reports any difference.\n\n"
+              << "  " << programName << " --bench-memory [MB]\n"
+              << "      Compare the paged memory backend with the old per-byte hash map (default 16 MB).\n\n"
+              << "  " << programName << " --bench-cache [accesses]\n"
+              << "      Time the cache on a synthetic trace (default 2000000 accesses) for every config under\n"
+              << "      Test/CacheSimulator, also made 16-way and fully associative.\n\n"
+              << "  Options:\n"
+              << "      -jit           Compile hot basic blocks to native code (x86-64 Linux only);\n"
+              << "                     compiled blocks do not print the per-instruction trace.\n"
+              << "                     Applies to -r, -s and -b.\n"
+              << "      -jit-validate  Like -jit, but compile every block and check it against the\n"
+              << "                     interpreter after each block (-r only).\n";
 }
 
 int main(int argc, char *argv[])
@@ -131,6 +723,17 @@ int main(int argc, char *argv[])
         argIndex = 3; // skip mode argument for the rest of parsing
     }
 
+    bool useJit = false;
+    bool validateJit = false;
+    while (argIndex < argc && (std::string(argv[argIndex]) == "-jit" || std::string(argv[argIndex]) == "-jit-validate"))
+    {
+        if (std::string(argv[argIndex]) == "-jit")
+            useJit = true;
+        else
+            validateJit = true;
+        ++argIndex;
+    }
+
     if (argc - argIndex < 1)
     {
         printUsage(argv[0]);
@@ -146,6 +749,239 @@ int main(int argc, char *argv[])
         int result = testRunner.runAllTests(mode);
         return result;
     }
+    else if (arg1 == "-b" || arg1 == "--bench")
+    {
+        int iterations = 2000;
+        if (argc - argIndex >= 2)
+            iterations = std::stoi(argv[argIndex + 1]);
+        Benchmark benchmark;
+        return benchmark.runSimulatorBenchmark("Test", mode, iterations, useJit);
+    }
+    else if (arg1 == "--trace-dump" && argc - argIndex >= 2)
+    {
+        uint64_t limit = 0;
+        if (argc - argIndex >= 3)
+            limit = std::stoull(argv[argIndex + 2]);
+        return dumpTrace(argv[argIndex + 1], std::cout, limit) ? 0 : 1;
+    }
+    else if (arg1 == "-cachesim" && argc - argIndex >= 3)
+    {
+        return runCacheTrace(argv[argIndex + 1], argv[argIndex + 2]);
+    }
+    else if (arg1 == "-cachesweep" && argc - argIndex >= 2)
+    {
+        std::string input;
+        CacheSweepGrid grid;
+        int threads = 0;
+        std::string outputFile = "cache_sweep.csv";
+        for (int i = argIndex + 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option == "--threads" && i + 1 < argc)
+                threads = std::stoi(argv[++i]);
+            else if (option == "--output" && i + 1 < argc)
+                outputFile = argv[++i];
+            else if ((option == "--sizes" || option == "--blocks" || option == "--assoc" || option == "--repl" ||
+                      option == "--write") &&
+                     i + 1 < argc)
+            {
+                if (!grid.set(option, argv[++i]))
+                {
+                    std::cerr << "Error: Bad value list for " << option << ": '" << argv[i] << "'\n";
+                    return 1;
+                }
+            }
+            else if (option.rfind("--", 0) == 0 || !input.empty())
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            else
+                input = option;
+        }
+        if (input.empty())
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runCacheSweep(input, mode, grid, threads, outputFile);
+    }
+    else if (arg1 == "-stackdist" && argc - argIndex >= 2)
+    {
+        std::string input;
+        std::vector<int> blockSizes = {16, 32, 64};
+        std::vector<int> setCounts = {1, 16, 64, 256};
+        bool check = false;
+        std::string outputFile = "stack_distance.csv";
+        for (int i = argIndex + 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option == "--check")
+                check = true;
+            else if (option == "--output" && i + 1 < argc)
+                outputFile = argv[++i];
+            else if ((option == "--blocks" || option == "--sets") && i + 1 < argc)
+            {
+                if (!CacheSweepGrid::parseIntList(argv[++i], option == "--blocks" ? blockSizes : setCounts))
+                {
+                    std::cerr << "Error: Bad value list for " << option << ": '" << argv[i] << "'\n";
+                    return 1;
+                }
+            }
+            else if (option.rfind("--", 0) == 0 || !input.empty())
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            else
+                input = option;
+        }
+        if (input.empty())
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runStackDistance(input, mode, blockSizes, setCounts, check, outputFile);
+    }
+    else if (arg1 == "--bench-cache")
+    {
+        uint32_t accessCount = 2000000;
+        if (argc - argIndex >= 2)
+            accessCount = static_cast<uint32_t>(std::stoul(argv[argIndex + 1]));
+        Benchmark benchmark;
+        return benchmark.runCacheBenchmark("Test/CacheSimulator", accessCount);
+    }
+    else if (arg1 == "--bench-memory")
+    {
+        uint32_t sizeMB = 16;
+        if (argc - argIndex >= 2)
+            sizeMB = static_cast<uint32_t>(std::stoul(argv[argIndex + 1]));
+        Benchmark benchmark;
+        return benchmark.runMemoryBenchmark(sizeMB);
+    }
+    else if ((arg1 == "-r" || arg1 == "--run") && argc - argIndex >= 2)
+    {
+        std::string asmFile = argv[argIndex + 1];
+        if (!fileExists(asmFile))
+        {
+            std::cerr << "Error: Assembly file '" << asmFile << "' does not exist.\n";
+            return 1;
+        }
+        bool quiet = false;
+        bool deterministic = false;
+        int hartCount = 0;
+        uint64_t quantum = MultiHartSimulator::DEFAULT_QUANTUM;
+        std::string sampleCacheConfig;
+        SamplingConfig sampling;
+        std::vector<FileMapping> mappings;
+        bool fork = false;
+        uint64_t forkPoint = 0;
+        std::vector<std::string> forkCacheConfigs;
+        std::string traceFile;
+        for (int i = argIndex + 2; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option == "--quiet")
+                quiet = true;
+            else if (option == "--deterministic")
+                deterministic = true;
+            else if (option == "--harts" && i + 1 < argc)
+                hartCount = std::stoi(argv[++i]);
+            else if (option == "--quantum" && i + 1 < argc)
+                quantum = std::stoull(argv[++i]);
+            else if (option == "--sample" && i + 1 < argc)
+                sampleCacheConfig = argv[++i];
+            else if (option == "--period" && i + 1 < argc)
+                sampling.period = std::stoull(argv[++i]);
+            else if (option == "--warmup" && i + 1 < argc)
+                sampling.warmup = std::stoull(argv[++i]);
+            else if (option == "--window" && i + 1 < argc)
+                sampling.window = std::stoull(argv[++i]);
+            else if (option == "--fork-at" && i + 1 < argc)
+            {
+                fork = true;
+                forkPoint = std::stoull(argv[++i]);
+            }
+            else if (option == "--trace" && i + 1 < argc)
+                traceFile = argv[++i];
+            else if (option == "--fork-cache" && i + 1 < argc)
+                forkCacheConfigs.push_back(argv[++i]);
+            else if ((option == "--map" || option == "--map-private") && i + 2 < argc)
+            {
+                std::string path = argv[++i];
+                uint32_t guestAddress = static_cast<uint32_t>(std::stoul(argv[++i], nullptr, 0));
+                mappings.push_back({path, guestAddress,
+                                    option == "--map" ? Memory::MapMode::READ_ONLY : Memory::MapMode::PRIVATE});
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (!traceFile.empty() && (hartCount > 0 || validateJit || fork || !sampleCacheConfig.empty()))
+        {
+            std::cerr << "Error: --trace cannot be combined with --harts, --sample, --fork-at or -jit-validate\n";
+            return 1;
+        }
+        if (fork || !forkCacheConfigs.empty())
+        {
+            if (!fork || forkCacheConfigs.empty() || hartCount > 0 || validateJit || !sampleCacheConfig.empty())
+            {
+                std::cerr << "Error: --fork-at needs at least one --fork-cache and cannot be combined with --harts, "
+                             "--sample or -jit-validate\n";
+                return 1;
+            }
+            return runFileForked(asmFile, mode, useJit, forkPoint, forkCacheConfigs, mappings);
+        }
+        if (!sampleCacheConfig.empty())
+        {
+            if (hartCount > 0 || validateJit)
+            {
+                std::cerr << "Error: --sample cannot be combined with --harts or -jit-validate\n";
+                return 1;
+            }
+            return runFileSampled(asmFile, mode, useJit, sampleCacheConfig, sampling, mappings);
+        }
+        if (hartCount > 0)
+        {
+            if (validateJit || !mappings.empty())
+            {
+                std::cerr << "Error: -jit-validate and --map are not supported with --harts\n";
+                return 1;
+            }
+            return runFileMultiHart(asmFile, mode, useJit, quiet, hartCount, quantum, deterministic);
+        }
+        return runFile(asmFile, mode, useJit, validateJit, quiet, mappings, traceFile);
+    }
+    else if (arg1 == "--batch" && argc - argIndex >= 2)
+    {
+        std::vector<std::string> paths;
+        int threads = 0;
+        std::string cacheConfigFile;
+        uint64_t maxInstructions = 0;
+        std::string summaryFile = "batch_summary.csv";
+        for (int i = argIndex + 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option == "--threads" && i + 1 < argc)
+                threads = std::stoi(argv[++i]);
+            else if (option == "--cache" && i + 1 < argc)
+                cacheConfigFile = argv[++i];
+            else if (option == "--max-instructions" && i + 1 < argc)
+                maxInstructions = std::stoull(argv[++i]);
+            else if (option == "--summary" && i + 1 < argc)
+                summaryFile = argv[++i];
+            else if (option.rfind("--", 0) == 0)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            else
+                paths.push_back(option);
+        }
+        return runBatch(paths, mode, useJit, threads, cacheConfigFile, maxInstructions, summaryFile);
+    }
     else if ((arg1 == "-a" || arg1 == "--assemble") && argc - argIndex >= 2)
     {
         std::string asmFile = argv[argIndex + 1];
@@ -173,6 +1009,8 @@ int main(int argc, char *argv[])
     {
         std::cout << "Launching simulator in interactive mode...\n";
         InteractiveSimulator commlineSimulator(std::cin, std::cout, mode);
+        if (useJit)
+            commlineSimulator.enableJit();
         commlineSimulator.runInteractive();
 
         return 0;
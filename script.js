@@ -53,11 +53,33 @@ createModule().then((mod) => {
 // Keep previous register values globally (outside the function)
 const previousRegisterValues = {};
 
+// Incremental state from sim.getDirtyRegionsSince(): only what changed since stateEpoch is
+// transferred. This page has no memory panel, so only the registers are kept; the page
+// cache and memory grid live in scriptNew.js.
+let stateEpoch = 0;
+const registerValues = new Array(32).fill(0n);
+
+// Applies the changes since the last call; returns the number of registers that changed
+function refreshState() {
+  const bytes = sim.getDirtyRegionsSince(stateEpoch);  // view into wasm memory; read it now
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  let pos = 0;
+  stateEpoch = Number(view.getBigUint64(pos, true)); pos += 8;
+  pos += 1; // flags
+  pos += 4; // pc
+  const changedRegisters = view.getUint8(pos); pos += 1;
+  for (let i = 0; i < changedRegisters; i++) {
+    const reg = view.getUint8(pos);
+    registerValues[reg] = view.getBigInt64(pos + 1, true);
+    pos += 9;
+  }
+  return changedRegisters; // the dirty memory ranges follow
+}
+
 function updateRegisterTable() {
   if (!checkReady()) return;
 
   try {
-    const registers = sim.getRegisters().split(/[\n\t]+/).filter(line => line.trim());
     const registerTableBody = document.querySelector("#registerTable tbody");
     registerTableBody.innerHTML = "";
 
@@ -68,10 +90,8 @@ function updateRegisterTable() {
       x24: "s8", x25: "s9", x26: "s10", x27: "s11", x28: "t3", x29: "t4", x30: "t5", x31: "t6"
     };
 
-    const pairs = registers.map(line => {
-      const [reg, val] = line.trim().split(":");
-      return [reg.trim(), val.trim()];
-    });
+    // same hex text as sim.getRegisters(), from the values refreshState() keeps
+    const pairs = registerValues.map((value, i) => [`x${i}`, BigInt.asUintN(64, value).toString(16)]);
 
     for (let i = 0; i < pairs.length; i += 2) {
       const row = document.createElement("tr");
@@ -159,7 +179,7 @@ function updateStackView() {
       try {
         const output =sim.run();
         logToConsole(output);     // Print it to the console
-        updateRegisterTable();
+        if (refreshState() > 0) updateRegisterTable();
         updateStackView();
       } catch (err) {
         logToConsole("❌ Error during run: " + err.message);
@@ -223,7 +243,7 @@ function updateStackView() {
         //logToConsole(`➡️ Line ${lineNumber}`);
         
         highlightLine(parseInt(lineNumber));
-        updateRegisterTable();
+        if (refreshState() > 0) updateRegisterTable();
         updateStackView();
       } catch (err) {
         logToConsole("❌ Error during step: " + err.message);
@@ -273,6 +293,9 @@ function loadManualCode() {
     // 🧪 Optional: Log the sanitized content
     console.log("Sanitized content:", JSON.stringify(content.split("\n")));
     let lineNumber = sim.load(content);
+    stateEpoch = 0;
+    refreshState();
+    updateRegisterTable();
     //logToConsole(`➡️ Line ${lineNumber}`);
     highlightLine(parseInt(lineNumber));
     // ✅ Enable Run and Step buttons
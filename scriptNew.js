@@ -30,6 +30,56 @@
     let currentLine = -1;
     let isRunning = false;
 
+    // Incremental state from sim.getDirtyRegionsSince(): only what changed since stateEpoch is
+    // transferred. memoryPages maps a 4 KiB-aligned address to a copy of that page;
+    // changedPages holds the pages of the last diff, for highlighting, and memoryReplaced
+    // is set when the last diff dropped all pages (new program, checkpoint restore).
+    const PAGE_SIZE = 4096;
+    const MEMORY_ROWS = 16;
+    let stateEpoch = 0;
+    const memoryPages = new Map();
+    const changedPages = new Set();
+    let memoryReplaced = false;
+    const registerValues = new Array(32).fill(0n);
+
+    // Applies the changes since the last call; returns the number of registers that changed
+    function refreshState() {
+        const bytes = sim.getDirtyRegionsSince(stateEpoch);  // view into wasm memory; read it now
+        const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+        let pos = 0;
+        stateEpoch = Number(view.getBigUint64(pos, true)); pos += 8;
+        const flags = view.getUint8(pos); pos += 1;
+        pos += 4; // pc
+        memoryReplaced = (flags & 1) !== 0;
+        if (memoryReplaced) memoryPages.clear();
+        changedPages.clear();
+        const changedRegisters = view.getUint8(pos); pos += 1;
+        for (let i = 0; i < changedRegisters; i++) {
+            const reg = view.getUint8(pos);
+            registerValues[reg] = view.getBigInt64(pos + 1, true);
+            pos += 9;
+        }
+        const ranges = view.getUint32(pos, true); pos += 4;
+        for (let i = 0; i < ranges; i++) {
+            const address = view.getUint32(pos, true);
+            const length = view.getUint32(pos + 4, true);
+            pos += 8;
+            for (let offset = 0; offset < length; offset += PAGE_SIZE) {
+                memoryPages.set(address + offset, bytes.slice(pos + offset, pos + offset + PAGE_SIZE));
+                changedPages.add(address + offset);
+            }
+            pos += length;
+        }
+        return changedRegisters;
+    }
+
+    // Pulls the diff and redraws only the views it touched
+    function refreshViews() {
+        const changedRegisters = refreshState();
+        if (changedRegisters > 0) updateRegisterTable();
+        if (memoryReplaced || changedPages.size > 0) renderMemoryView();
+    }
+
     // Sample RISC-V code
     const sampleCode = `main:
     addi x4, x0, 4
@@ -261,7 +311,6 @@
     if (!checkReady()) return;
 
     try {
-        const registers = sim.getRegisters().split(/[\n\t]+/).filter(line => line.trim());
         const registerTableBody = document.querySelector("#registerTable tbody");
         registerTableBody.innerHTML = "";
 
@@ -272,10 +321,8 @@
             x24: "s8", x25: "s9", x26: "s10", x27: "s11", x28: "t3", x29: "t4", x30: "t5", x31: "t6"
         };
 
-        const pairs = registers.map(line => {
-            const [reg, val] = line.trim().split(":");
-            return [reg.trim(), val.trim()];
-        });
+        // same hex text as sim.getRegisters(), from the values refreshState() keeps
+        const pairs = registerValues.map((value, i) => [`x${i}`, BigInt.asUintN(64, value).toString(16)]);
 
         for (let i = 0; i < 16; i++) {
             const row = document.createElement("tr");
@@ -343,6 +390,56 @@ function setupRegisterFormatToggle() {
     }
 }
 
+// Memory grid: MEMORY_ROWS rows of 16 bytes from currentMemoryBase, read from the page cache
+// refreshState() keeps, so drawing it never calls into the simulator. Pages never written read as 0.
+function renderMemoryView() {
+    const grid = document.getElementById("memoryGrid");
+    if (!grid) return;
+
+    const fragment = document.createDocumentFragment();
+    for (let row = 0; row < MEMORY_ROWS; row++) {
+        const rowAddress = (currentMemoryBase + row * 16) >>> 0;
+        const addressDiv = document.createElement("div");
+        addressDiv.className = "memory-address";
+        addressDiv.textContent = "0x" + rowAddress.toString(16).padStart(8, "0");
+        fragment.appendChild(addressDiv);
+
+        for (let col = 0; col < 16; col++) {
+            const address = (rowAddress + col) >>> 0;
+            const pageAddress = address - (address % PAGE_SIZE);
+            const page = memoryPages.get(pageAddress);
+            const value = page ? page[address - pageAddress] : 0;
+
+            const byteDiv = document.createElement("div");
+            byteDiv.className = "memory-byte";
+            byteDiv.textContent = value.toString(16).padStart(2, "0").toUpperCase();
+            if (value === 0) byteDiv.classList.add("zero");
+            if (changedPages.has(pageAddress)) byteDiv.classList.add("changed");
+            fragment.appendChild(byteDiv);
+        }
+    }
+    grid.innerHTML = "";
+    grid.appendChild(fragment);
+}
+
+// Memory panel buttons
+function refreshMemory() {
+    if (!checkReady()) return;
+    refreshViews();
+    renderMemoryView();
+}
+
+function jumpToAddress() {
+    const text = document.getElementById("memorySearch").value.trim();
+    const address = parseInt(text, 16);
+    if (isNaN(address)) {
+        logToConsole("⚠️ Enter a hex address to jump to.");
+        return;
+    }
+    currentMemoryBase = (address - (address % 16)) >>> 0;
+    renderMemoryView();
+}
+
 
 
    function updateStackView() {
@@ -405,6 +502,11 @@ function setupRegisterFormatToggle() {
 
             // ✅ Call sim.load and update UI
             let lineNumber = sim.load(content);
+            // a new program replaces all state: start over from a full diff
+            stateEpoch = 0;
+            refreshState();
+            updateRegisterTable();
+            renderMemoryView();
             highlightLine(parseInt(lineNumber));
             updateLineNumbers();
             updateMachineCode();
@@ -422,7 +524,7 @@ function setupRegisterFormatToggle() {
       try {
         const output =sim.run();
         logToConsole(output);     // Print it to the console
-        updateRegisterTable();
+        refreshViews();
         updateStackView();
       } catch (err) {
         logToConsole("❌ Error during run: " + err.message);
@@ -562,7 +664,7 @@ document.addEventListener('DOMContentLoaded', () => {
         //logToConsole(`➡️ Line ${lineNumber}`);
         
         highlightLine(parseInt(lineNumber));
-        updateRegisterTable();
+        refreshViews();
         updateStackView();
       } catch (err) {
         logToConsole("❌ Error during step: " + err.message);
@@ -609,6 +711,8 @@ document.addEventListener("keydown", (e) => {
 });
 
     window.clearConsole = clearConsole;
+    window.refreshMemory = refreshMemory;
+    window.jumpToAddress = jumpToAddress;
 
     function updateAllViews() {
         updateLineNumbers();